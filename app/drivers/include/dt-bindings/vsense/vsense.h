@@ -0,0 +1,26 @@
+
+
+#ifndef ZEPHYR_DT_BINDINGS_VSENSE_H
+#define ZEPHYR_DT_BINDINGS_VSENSE_H
+
+/*
+* Values of enum sensor_channel usable in devicetree, the driver checks at
+* build time that they match.
+*/
+#define VSENSE_CHAN_ACCEL_X 0
+#define VSENSE_CHAN_ACCEL_Y 1
+#define VSENSE_CHAN_ACCEL_Z 2
+#define VSENSE_CHAN_GYRO_X 4
+#define VSENSE_CHAN_GYRO_Y 5
+#define VSENSE_CHAN_GYRO_Z 6
+#define VSENSE_CHAN_MAGN_X 8
+#define VSENSE_CHAN_MAGN_Y 9
+#define VSENSE_CHAN_MAGN_Z 10
+#define VSENSE_CHAN_DIE_TEMP 12
+#define VSENSE_CHAN_AMBIENT_TEMP 13
+#define VSENSE_CHAN_PRESS 14
+#define VSENSE_CHAN_PROX 15
+#define VSENSE_CHAN_HUMIDITY 16
+#define VSENSE_CHAN_LIGHT 17
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_CAPTURE_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Capture log, a recording of the received vbus byte stream in a file that
+* can be replayed on the device later. The file is append-only:
+*
+*   file header   magic "VBCP", format, stream version, block size
+*   block 0..n    fixed size blocks, each a header followed by stream bytes
+*
+* Every block header holds the timestamp and the stream offset of its first
+* byte, the offset of the first frame that starts in it and a CRC32C. All
+* fields are big endian. Blocks have the same size on disk, so block i is
+* found without scanning and the block headers act as a sparse index of the
+* stream: seeking is a binary search over them, O(log n) header reads.
+*
+* A block whose CRC does not match at the end of the file, e.g. torn by a
+* power loss, is ignored.
+*/
+#define VBUS_CAPTURE_MAGIC "VBCP"
+#define VBUS_CAPTURE_FORMAT 1
+#define VBUS_CAPTURE_FILE_HEADER_SIZE 16
+#define VBUS_CAPTURE_BLOCK_HEADER_SIZE 32
+#define VBUS_CAPTURE_NO_FRAME UINT32_MAX
+
+/*
+* Decoded header of one block.
+*/
+struct vbus_capture_block_info {
+    uint32_t block_no;
+    uint32_t used;
+    uint64_t timestamp_ns;
+    uint64_t stream_offset;
+    // Offset in the block data, VBUS_CAPTURE_NO_FRAME if no frame starts in it
+    uint32_t frame_offset;
+};
+
+/*
+* Writer side. Stream bytes are collected in a block sized buffer and the
+* file only sees whole block writes.
+*/
+struct vbus_capture {
+    struct fs_file_t file;
+    uint8_t *block;
+    uint32_t block_size;
+    struct vbus_capture_block_info info;
+    uint64_t stream_offset;
+    // Frames are followed through their size fields from the last frame_start
+    bool frame_known;
+    uint64_t next_frame;
+    uint8_t size_field[2];
+    uint32_t size_fill;
+    uint32_t frame_lead;
+    uint32_t frame_overhead;
+    // Sticky, a failed block write stops the capture
+    int error;
+};
+
+/*
+* Create or replace the capture at path. block holds one block on disk,
+* header included; larger blocks mean fewer writes and a coarser index.
+* version is the wire format of the captured stream, used for replay.
+*/
+int vbus_capture_open(struct vbus_capture *capture, const char *path, uint8_t *block,
+                      uint32_t block_size, enum vbus_frame_version version);
+
+/*
+* Append received bytes, timestamped with the current uptime. frame_start
+* tells that data begins with a frame header. From there on the writer
+* follows the frame sizes, so every block a frame starts in records it as a
+* replay entry point, also inside larger writes and in later writes that
+* pass false. Pass true for the regions handed out by
+* vbus_frame_decode_view(); chunks taken straight from the receive ring
+* rarely are frame aligned. Returns -EIO if a block write failed.
+*/
+int vbus_capture_write(struct vbus_capture *capture, const uint8_t *data, uint32_t size,
+                       bool frame_start);
+
+/*
+* Write the partially filled block and sync the file. Later bytes go to a
+* new block, so flushing often wastes space.
+*/
+int vbus_capture_flush(struct vbus_capture *capture);
+
+/*
+* Flush and close the file.
+*/
+int vbus_capture_close(struct vbus_capture *capture);
+
+/*
+* Called with every batch of replayed frames, e.g. to forward them to
+* vsense_dispatch() or vbus_demux_dispatch(). Frames are only valid for the
+* duration of the call.
+*/
+typedef void (*vbus_capture_replay_cb_t)(const struct vbus_frame *frames, uint32_t frame_count,
+                                         void *user_data);
+
+/*
+* Reader side. Blocks are read whole into the block buffer, copied into the
+* ring and decoded with a zero-copy frame view, so replay does one file read
+* per block and no allocation.
+*/
+struct vbus_capture_reader {
+    struct fs_file_t file;
+    uint8_t *block;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t next_block;
+    bool resync;
+    enum vbus_frame_version version;
+    struct ring_buf ring;
+    struct vbus_frame_view view;
+    uint32_t crc_errors;
+};
+
+/*
+* Open a capture for replay, positioned at its start. block must be at least
+* the block size of the file and larger than the largest captured frame, it
+* doubles as the bounce buffer of the view. ring_storage must hold two
+* blocks. frames bounds the batch size handed to the callback. Returns
+* -EBADMSG for a file that is not a capture.
+*/
+int vbus_capture_reader_open(struct vbus_capture_reader *reader, const char *path,
+                             uint8_t *block, uint32_t block_size, uint8_t *ring_storage,
+                             uint32_t ring_size, struct vbus_frame *frames,
+                             uint32_t frame_capacity);
+
+int vbus_capture_reader_close(struct vbus_capture_reader *reader);
+
+/*
+* Read the header of block block_no.
+*/
+int vbus_capture_block_info(struct vbus_capture_reader *reader, uint32_t block_no,
+                            struct vbus_capture_block_info *info);
+
+/*
+* Position replay at the block holding the stream byte at stream_offset, or
+* at the last block started before timestamp_ns, so that no frame received
+* from then on is missed. Replay resumes at the first frame starting in that
+* block. Returns -ENOENT for an empty capture.
+*/
+int vbus_capture_seek_offset(struct vbus_capture_reader *reader, uint64_t stream_offset);
+int vbus_capture_seek_time(struct vbus_capture_reader *reader, uint64_t timestamp_ns);
+
+/*
+* Decode the capture from the current position to its end, as fast as the
+* file can be read. Returns the number of replayed frames, -EBADMSG if a
+* block failed its CRC and -ENOBUFS if a frame is larger than the block.
+*/
+int vbus_capture_replay(struct vbus_capture_reader *reader, vbus_capture_replay_cb_t cb,
+                        void *user_data);
+
+#endif
@@ -0,0 +1,16 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_CRC32C_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Continue a CRC32C over data. Start with crc = 0, the result of one call
+* is the crc argument of the next, e.g. for a payload split over two
+* ring buffer segments.
+*/
+uint32_t vbus_crc32c_update(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif
@@ -5,17 +5,182 @@
 
 #include <stdint.h>
 #include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/vbus_stats.h>
+
+#define VBUS_FRAME_HEADER_SIZE 3
+#define VBUS_FRAME_V2_HEADER_SIZE 16
+#define VBUS_FRAME_MAX_HEADER_SIZE VBUS_FRAME_V2_HEADER_SIZE
+
+/*
+* Wire format versions. All versions start with the channel index and the
+* big endian payload size, v2 adds sampling metadata after them:
+*
+*   v1: channel(1) size(2) payload
+*   v2: channel(1) size(2) flags(1) seq(2) sample_count(2)
+*       timestamp_us(4) sample_delta_us(4) payload
+*/
+enum vbus_frame_version {
+    VBUS_FRAME_V1 = 1,
+    VBUS_FRAME_V2 = 2,
+};
+
+/*
+* Optional sync framing, OR'd into the version given to the *_ver functions.
+* Every frame is preceded by the two marker bytes and followed by a big
+* endian CRC32C over its header and payload. A decoder that meets a corrupt
+* frame drops it and resumes at the next marker.
+*/
+#define VBUS_FRAME_SYNC 0x80
+#define VBUS_FRAME_SYNC_MARKER_0 0xA5
+#define VBUS_FRAME_SYNC_MARKER_1 0x5A
+#define VBUS_FRAME_SYNC_MARKER_SIZE 2
+#define VBUS_FRAME_CRC_SIZE 4
+
+#define VBUS_FRAME_VERSION_BIT(version) (1U << ((version) - 1))
+#define VBUS_FRAME_VERSIONS_SUPPORTED \
+    (VBUS_FRAME_VERSION_BIT(VBUS_FRAME_V1) | VBUS_FRAME_VERSION_BIT(VBUS_FRAME_V2))
 
  struct vbus_frame {
     uint8_t channel_idx;
     uint8_t *data;
     uint32_t size;
+    /* v2 metadata, zero for frames decoded from v1 */
+    uint8_t flags;
+    uint16_t seq;
+    uint16_t sample_count;
+    uint32_t timestamp_us;
+    uint32_t sample_delta_us;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    /* Stream position after the header, 0 if untraced, see rtio_vbus/vbus_trace.h */
+    uint32_t trace_id;
+#endif
  };
 
+/*
+* Header size of a wire format version, 0 if the version is not supported.
+* Sync framing adds VBUS_FRAME_SYNC_MARKER_SIZE + VBUS_FRAME_CRC_SIZE bytes
+* around every frame on top of it.
+*/
+uint32_t vbus_frame_header_size(enum vbus_frame_version version);
+
+/*
+* Pick the stream version from the bit mask of versions offered by the peer
+* (see VBUS_FRAME_VERSION_BIT). The highest common version wins, a peer that
+* offers nothing known, or nothing at all, is talked to in v1.
+*/
+enum vbus_frame_version vbus_frame_negotiate(uint32_t peer_versions);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_ALLOC_COUNT
+/*
+* Number of k_malloc()/k_realloc() calls made by the codec since boot.
+*/
+uint32_t vbus_frame_alloc_count(void);
+#endif
+
 int vbus_frame_decode(struct ring_buf *buffer, uint32_t buf_size,
                       struct vbus_frame ***frames, uint32_t *frame_count);
 
+/*
+* The *_ver variants take the negotiated wire format version, the plain
+* functions are their v1 shorthands. An unsupported version gives -ENOTSUP.
+*/
+int vbus_frame_decode_ver(enum vbus_frame_version version, struct ring_buf *buffer,
+                          uint32_t buf_size, struct vbus_frame ***frames,
+                          uint32_t *frame_count);
+
+/*
+* Zero-copy decode state. Frames handed out by vbus_frame_decode_view()
+* point straight into the claimed ring buffer region and stay valid until
+* vbus_frame_view_release() is called. A frame whose payload straddles the
+* ring buffer wrap point is copied into the optional bounce buffer. If it
+* does not fit, the frame is dropped and counted in oversized.
+*/
+struct vbus_frame_view {
+    struct ring_buf *buffer;
+    struct vbus_frame *frames;
+    uint32_t frame_capacity;
+    uint32_t frame_count;
+    uint32_t claimed_size;
+    uint8_t *bounce;
+    uint32_t bounce_size;
+    enum vbus_frame_version version;
+    uint32_t crc_errors;
+    uint32_t oversized;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    struct vbus_stats *stats;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    /* Bytes released from the ring buffer */
+    uint32_t stream_pos;
+#endif
+};
+
+void vbus_frame_view_init(struct vbus_frame_view *view, struct ring_buf *buffer,
+                          struct vbus_frame *frames, uint32_t frame_capacity);
+
+/*
+* Set storage for the payload that straddles the ring buffer wrap point.
+* It should hold the largest expected frame payload, larger wrapped frames
+* are dropped.
+*/
+void vbus_frame_view_set_bounce(struct vbus_frame_view *view, uint8_t *bounce,
+                                uint32_t bounce_size);
+
+/*
+* Views decode v1 after init. Must not be called while a view is held.
+* With VBUS_FRAME_SYNC, frames failing the CRC are skipped and counted in
+* crc_errors.
+*/
+int vbus_frame_view_set_version(struct vbus_frame_view *view,
+                                enum vbus_frame_version version);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+/*
+* Count decoded frames, CRC errors and decode times of the view in stats,
+* NULL detaches it.
+*/
+void vbus_frame_view_set_stats(struct vbus_frame_view *view, struct vbus_stats *stats);
+#endif
+
+/*
+* Decode up to frame_capacity complete frames from at most buf_size bytes
+* without allocating or copying. Returns -EBUSY if the previous view has not
+* been released yet. A frame that wraps around the ring buffer end and does
+* not fit the bounce buffer is skipped and counted in oversized, so it
+* cannot stall the stream.
+*/
+int vbus_frame_decode_view(struct vbus_frame_view *view, uint32_t buf_size);
+
+/*
+* Consume the bytes of all frames in the view from the ring buffer.
+* Frame data pointers must not be used afterwards.
+*/
+int vbus_frame_view_release(struct vbus_frame_view *view);
+
 int vbus_frame_encode(const struct vbus_frame **frames, uint32_t frame_count, 
     uint8_t **buffer, uint32_t *buf_size);
 
+/*
+* Encode frames into a caller provided buffer of the given capacity.
+* If buffer is NULL, only the required size is stored in buf_size.
+* Returns -ENOBUFS without writing anything if capacity is too small.
+*/
+int vbus_frame_encode_to(const struct vbus_frame **frames, uint32_t frame_count,
+                         uint8_t *buffer, uint32_t capacity, uint32_t *buf_size);
+
+int vbus_frame_encode_to_ver(enum vbus_frame_version version,
+                             const struct vbus_frame **frames, uint32_t frame_count,
+                             uint8_t *buffer, uint32_t capacity, uint32_t *buf_size);
+
+/*
+* Encode frames directly into the free space of a ring buffer. Either all
+* frames are committed or, on -ENOBUFS, nothing is.
+*/
+int vbus_frame_encode_ring(const struct vbus_frame **frames, uint32_t frame_count,
+                           struct ring_buf *buffer);
+
+int vbus_frame_encode_ring_ver(enum vbus_frame_version version,
+                               const struct vbus_frame **frames, uint32_t frame_count,
+                               struct ring_buf *buffer);
+
 #endif
\ No newline at end of file
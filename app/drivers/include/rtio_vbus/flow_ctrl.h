@@ -0,0 +1,37 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FLOW_CTRL_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FLOW_CTRL_H
+
+#include <stdint.h>
+#include <zephyr/sys/byteorder.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Credit based flow control from the device to the host. The device sends
+* v1 frames on VBUS_FLOW_CHANNEL, independent of the version of the stream
+* it receives, with two big endian counters as payload:
+*
+*   received(4) limit(4)
+*
+* received counts the stream bytes the device has taken in so far, limit is
+* the stream offset up to which the host may send, i.e. received plus the
+* free space of the receive ring. Both wrap at 32 bits.
+*
+* A host sends nothing before its first credit and then counts its sent
+* bytes from received on. Credits are cumulative, a lost or repeated one
+* does no harm and the next one makes up for it.
+*/
+#define VBUS_FLOW_CHANNEL 0xFF
+#define VBUS_FLOW_CREDIT_SIZE 8
+#define VBUS_FLOW_CREDIT_FRAME_SIZE (VBUS_FRAME_HEADER_SIZE + VBUS_FLOW_CREDIT_SIZE)
+
+static inline void vbus_flow_credit_encode(uint32_t received, uint32_t limit,
+                                           uint8_t frame[VBUS_FLOW_CREDIT_FRAME_SIZE]) {
+    frame[0] = VBUS_FLOW_CHANNEL;
+    sys_put_be16(VBUS_FLOW_CREDIT_SIZE, &frame[1]);
+    sys_put_be32(received, &frame[VBUS_FRAME_HEADER_SIZE]);
+    sys_put_be32(limit, &frame[VBUS_FRAME_HEADER_SIZE + 4]);
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_BUS_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_BUS_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/zbus/zbus.h>
+#include <rtio_vbus/data_frame.h>
+
+#define VBUS_FRAME_BUS_CHANNEL_COUNT 256
+
+/*
+* Message of a frame channel. The payload lives in a reference counted
+* buffer of the frame buffer pool, frame.data points into it. Every holder
+* of a message owns one reference; the buffer goes back to the pool when
+* the last one is dropped, so any number of consumers share one payload.
+*/
+struct vbus_frame_msg {
+    struct vbus_frame frame;
+    struct net_buf *buf;
+};
+
+/*
+* Define a zbus channel carrying struct vbus_frame_msg, observed by the
+* listed observers. The channel holds a reference to the last published
+* frame until the next one replaces it.
+*/
+#define VBUS_FRAME_CHAN_DEFINE(name, ...)                                           \
+    ZBUS_CHAN_DEFINE(name, struct vbus_frame_msg, NULL, NULL,                       \
+                     ZBUS_OBSERVERS(__VA_ARGS__), ZBUS_MSG_INIT(0))
+
+/*
+* Copy the payload once into a pool buffer and publish it on chan. Observers
+* are notified before this returns. timeout bounds the whole call, buffer
+* allocation, channel claim and notify together. Returns -EMSGSIZE if the
+* payload exceeds the pool buffer size and -ENOMEM if no buffer became free
+* in time. An error of zbus_chan_notify() means the frame is on chan but some
+* observers were not told. Meant for a single publisher per channel, the
+* decode thread.
+*/
+int vbus_frame_bus_publish(const struct zbus_channel *chan, const struct vbus_frame *frame,
+                           k_timeout_t timeout);
+
+/*
+* Take a reference to the current frame of chan, for subscribers woken up
+* by zbus_sub_wait(). Subscribers only see the latest frame. msg->buf is
+* NULL if nothing was published yet.
+*/
+int vbus_frame_bus_read(const struct zbus_channel *chan, struct vbus_frame_msg *msg,
+                        k_timeout_t timeout);
+
+/*
+* Drop the reference held by chan, e.g. before a channel goes idle.
+*/
+int vbus_frame_bus_clear(const struct zbus_channel *chan, k_timeout_t timeout);
+
+/*
+* Take a reference to src. Listeners run while the channel is locked and
+* may call this on zbus_chan_const_msg() to keep the frame past the
+* callback, e.g. to hand it to their own thread.
+*/
+void vbus_frame_msg_ref(struct vbus_frame_msg *dst, const struct vbus_frame_msg *src);
+
+/*
+* Drop the reference of msg. Safe to call on an empty message.
+*/
+void vbus_frame_msg_unref(struct vbus_frame_msg *msg);
+
+uint32_t vbus_frame_buf_num_free(void);
+
+/*
+* Routes decoded frames to per-channel zbus channels, the zero-copy fan-out
+* counterpart of struct vbus_demux.
+*/
+struct vbus_frame_bus {
+    const struct zbus_channel *chans[VBUS_FRAME_BUS_CHANNEL_COUNT];
+    uint32_t unrouted;
+    uint32_t dropped;
+    uint32_t unnotified;
+};
+
+void vbus_frame_bus_init(struct vbus_frame_bus *bus);
+
+/*
+* Attach a frame channel to a vbus channel. Returns -EALREADY if the vbus
+* channel is taken.
+*/
+int vbus_frame_bus_register(struct vbus_frame_bus *bus, uint8_t channel_idx,
+                            const struct zbus_channel *chan);
+
+/*
+* Publish every frame on the channel of its vbus channel. Frames of
+* channels without one are counted as unrouted, frames that could not be
+* published as dropped. Frames published but not delivered to every
+* observer count as published and unnotified. Returns the number of
+* published frames.
+*/
+uint32_t vbus_frame_bus_dispatch(struct vbus_frame_bus *bus, const struct vbus_frame *frames,
+                                 uint32_t frame_count, k_timeout_t timeout);
+
+#endif
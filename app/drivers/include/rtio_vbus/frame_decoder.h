@@ -0,0 +1,97 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_DECODER_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_DECODER_H
+
+#include <stdint.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Called for every complete frame. The frame and its data are only valid
+* for the duration of the call.
+*/
+typedef void (*vbus_frame_decoder_cb_t)(const struct vbus_frame *frame, void *user_data);
+
+enum vbus_frame_decoder_state {
+    VBUS_FRAME_DECODER_HEADER,
+    VBUS_FRAME_DECODER_PAYLOAD,
+    VBUS_FRAME_DECODER_DISCARD,
+};
+
+/*
+* Resumable decoder context. A partially received header or payload is kept
+* between feed calls, so every input byte is looked at once.
+*/
+struct vbus_frame_decoder {
+    enum vbus_frame_decoder_state state;
+    enum vbus_frame_version version;
+    uint8_t header[VBUS_FRAME_MAX_HEADER_SIZE];
+    uint32_t header_size;
+    uint32_t header_len;
+    struct vbus_frame frame;
+    uint32_t received;
+    uint8_t *payload;
+    uint32_t payload_capacity;
+    uint32_t dropped_frames;
+    vbus_frame_decoder_cb_t cb;
+    void *user_data;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    struct vbus_stats *stats;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    /* Bytes fed so far, kept across resets to match the RX side */
+    uint32_t stream_pos;
+#endif
+};
+
+/*
+* Payload storage must be able to hold the largest frame that has to be
+* delivered. Larger frames are skipped and counted in dropped_frames.
+*/
+void vbus_frame_decoder_init(struct vbus_frame_decoder *decoder, uint8_t *payload,
+                             uint32_t payload_capacity, vbus_frame_decoder_cb_t cb,
+                             void *user_data);
+
+/*
+* Drop any partially received frame and wait for a new header.
+*/
+void vbus_frame_decoder_reset(struct vbus_frame_decoder *decoder);
+
+/*
+* Switch the wire format version, v1 is used after init. Any partially
+* received frame is dropped. Returns -ENOTSUP for an unknown version and for
+* sync framing, which needs the ring buffer decoders to rescan past a bad
+* frame.
+*/
+int vbus_frame_decoder_set_version(struct vbus_frame_decoder *decoder,
+                                   enum vbus_frame_version version);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+/*
+* Count delivered and dropped frames of the decoder in stats, NULL detaches
+* it. Decode times and stalls are recorded by vbus_frame_decoder_feed_ring().
+*/
+void vbus_frame_decoder_set_stats(struct vbus_frame_decoder *decoder, struct vbus_stats *stats);
+#endif
+
+/*
+* Feed new bytes. Frames that arrive complete within data are delivered
+* straight from it without copying. Returns the number of delivered frames.
+*/
+int vbus_frame_decoder_feed(struct vbus_frame_decoder *decoder, const uint8_t *data,
+                            uint32_t size);
+
+/*
+* Feed a single byte, e.g. from a UART RX callback. Returns 1 if the byte
+* completed a frame and 0 otherwise.
+*/
+int vbus_frame_decoder_feed_byte(struct vbus_frame_decoder *decoder, uint8_t byte);
+
+/*
+* Feed and consume everything currently stored in a ring buffer.
+* Returns the number of delivered frames.
+*/
+int vbus_frame_decoder_feed_ring(struct vbus_frame_decoder *decoder, struct ring_buf *buffer);
+
+#endif
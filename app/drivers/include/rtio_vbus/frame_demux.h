@@ -0,0 +1,95 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_DEMUX_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_DEMUX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#include <rtio_vbus/data_frame.h>
+
+#define VBUS_DEMUX_CHANNEL_COUNT 256
+#define VBUS_CACHE_LINE_SIZE CONFIG_APP_DRIVERS_RTIO_VBUS_CACHE_LINE_SIZE
+
+/*
+* Lock-free single-producer/single-consumer frame queue. Each slot owns a
+* copy of the payload, so the producer may release its source buffer right
+* after pushing. Producer and consumer state live on separate cache lines.
+*/
+struct vbus_spsc_queue {
+    /* Written by the producer only */
+    atomic_t head;
+    uint32_t tail_cache;
+    uint32_t overflows;
+    uint32_t oversized;
+
+    /* Written by the consumer only */
+    atomic_t tail __aligned(VBUS_CACHE_LINE_SIZE);
+    uint32_t head_cache;
+
+    /* Constant after definition */
+    struct vbus_frame *slots __aligned(VBUS_CACHE_LINE_SIZE);
+    uint8_t *storage;
+    uint32_t mask;
+    uint32_t slot_size;
+};
+
+/*
+* Statically define a queue of depth frames (a power of two) with up to
+* slot_size payload bytes per frame.
+*/
+#define VBUS_SPSC_QUEUE_DEFINE(name, depth, slot_size_)                             \
+    BUILD_ASSERT(IS_POWER_OF_TWO(depth), "Queue depth must be a power of two");     \
+    static struct vbus_frame name##_slots[depth];                                   \
+    static uint8_t name##_storage[(depth) * (slot_size_)]                           \
+        __aligned(VBUS_CACHE_LINE_SIZE);                                            \
+    static struct vbus_spsc_queue name __aligned(VBUS_CACHE_LINE_SIZE) = {          \
+        .slots = name##_slots,                                                      \
+        .storage = name##_storage,                                                  \
+        .mask = (depth) - 1,                                                        \
+        .slot_size = (slot_size_),                                                  \
+    }
+
+/*
+* Producer side. Returns -ENOBUFS if the queue is full and -EMSGSIZE if the
+* payload exceeds the slot size; both are counted.
+*/
+int vbus_spsc_push(struct vbus_spsc_queue *queue, const struct vbus_frame *frame);
+
+/*
+* Consumer side. Returns the oldest frame without removing it, or NULL if
+* the queue is empty. The frame stays valid until vbus_spsc_release().
+*/
+const struct vbus_frame *vbus_spsc_peek(struct vbus_spsc_queue *queue);
+
+void vbus_spsc_release(struct vbus_spsc_queue *queue);
+
+uint32_t vbus_spsc_count(const struct vbus_spsc_queue *queue);
+
+/*
+* Routes frames to per-channel queues. The dispatch side is meant to run in
+* a single decode thread; each queue has its own consumer.
+*/
+struct vbus_demux {
+    struct vbus_spsc_queue *queues[VBUS_DEMUX_CHANNEL_COUNT];
+    uint32_t unrouted;
+};
+
+void vbus_demux_init(struct vbus_demux *demux);
+
+/*
+* Attach a queue to a channel. Returns -EALREADY if the channel is taken.
+*/
+int vbus_demux_register(struct vbus_demux *demux, uint8_t channel_idx,
+                        struct vbus_spsc_queue *queue);
+
+/*
+* Push every frame to the queue of its channel. Frames of channels without
+* a queue are counted as unrouted. Returns the number of queued frames.
+*/
+uint32_t vbus_demux_dispatch(struct vbus_demux *demux, const struct vbus_frame *frames,
+                             uint32_t frame_count);
+
+#endif
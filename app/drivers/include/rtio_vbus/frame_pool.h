@@ -0,0 +1,45 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_POOL_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_POOL_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* A batch of decoded frames. Frame descriptors and payloads all live in one
+* frame pool block, which is given back with vbus_frame_batch_free().
+* oversized counts the frames of the call that were dropped because they
+* can never fit into a pool block.
+*/
+struct vbus_frame_batch {
+    struct vbus_frame *frames;
+    uint32_t frame_count;
+    uint32_t oversized;
+    void *block;
+};
+
+/*
+* Decode complete frames from at most buf_size bytes into a single pool block.
+* Decoding stops when the next frame does not fit into the rest of the
+* block. Frames larger than a whole block are consumed and dropped, so they
+* cannot stall the stream. Returns -ENOMEM if no block became available
+* within timeout.
+*/
+int vbus_frame_decode_batch(struct ring_buf *buffer, uint32_t buf_size,
+                            struct vbus_frame_batch *batch, k_timeout_t timeout);
+
+int vbus_frame_decode_batch_ver(enum vbus_frame_version version, struct ring_buf *buffer,
+                                uint32_t buf_size, struct vbus_frame_batch *batch,
+                                k_timeout_t timeout);
+
+/*
+* Give the batch block back to the pool. Safe to call on an empty batch.
+*/
+void vbus_frame_batch_free(struct vbus_frame_batch *batch);
+
+uint32_t vbus_frame_pool_num_free(void);
+
+#endif
@@ -0,0 +1,129 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_SCHED_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+#define VBUS_SCHED_MAX_CHANNELS CONFIG_APP_DRIVERS_RTIO_VBUS_SCHED_MAX_CHANNELS
+#define VBUS_SCHED_MAX_SAMPLE_SIZE CONFIG_APP_DRIVERS_RTIO_VBUS_SCHED_MAX_SAMPLE_SIZE
+
+// Every held sample is stored behind its due time
+#define VBUS_SCHED_ENTRY_SIZE(sample_size) (sizeof(uint32_t) + (sample_size))
+
+struct vbus_sched_channel;
+
+/*
+* Called from the timer expiry, i.e. in interrupt context, once per sample
+* when it is due. due_us is the intended release time on the
+* k_uptime_ticks() clock in microseconds, truncated to 32 bits. Must not call
+* back into the scheduler.
+*/
+typedef void (*vbus_sched_release_t)(struct vbus_sched_channel *channel, const uint8_t *sample,
+                                     uint32_t due_us, void *user_data);
+
+/*
+* Lateness is the time between the due time and the actual release.
+* Jitter is how much the spacing of two consecutive releases deviates from
+* the spacing of their due times.
+*/
+struct vbus_sched_metrics {
+    uint32_t released;
+    uint32_t late;
+    uint32_t overruns;
+    uint32_t lateness_max_us;
+    uint64_t lateness_sum_us;
+    uint32_t jitter_max_us;
+    uint64_t jitter_sum_us;
+};
+
+/*
+* Samples of one channel waiting for release. With period_us set, samples
+* are paced at that output data rate. With period_us 0, they are released at
+* the timestamps embedded in v2 frames, shifted by a per-channel offset
+* fixed at the first frame.
+*/
+struct vbus_sched_channel {
+    uint8_t channel_idx;
+    uint16_t sample_size;
+    uint32_t period_us;
+    vbus_sched_release_t release;
+    void *user_data;
+    struct ring_buf ring;
+    bool anchored;
+    uint32_t last_due_us;
+    uint32_t ts_offset_us;
+    uint32_t head_due_us;
+    int32_t heap_idx;
+    bool has_prev;
+    uint32_t prev_due_us;
+    uint32_t prev_release_us;
+    struct vbus_sched_metrics metrics;
+};
+
+/*
+* Releases held samples of all attached channels from a single k_timer.
+* Channels with held samples sit in a min-heap ordered by the due time of
+* their oldest sample, so the timer is always armed for the heap top.
+*
+* Every channel starts with playout_delay_us of buffering, which absorbs
+* bursty arrival, e.g. over USB. A release later than late_threshold_us
+* after its due time is counted as late.
+*/
+struct vbus_sched {
+    struct k_timer timer;
+    struct k_spinlock lock;
+    struct vbus_sched_channel *channels[VBUS_SCHED_MAX_CHANNELS];
+    uint32_t channel_count;
+    struct vbus_sched_channel *heap[VBUS_SCHED_MAX_CHANNELS];
+    uint32_t heap_size;
+    uint32_t playout_delay_us;
+    uint32_t late_threshold_us;
+};
+
+void vbus_sched_init(struct vbus_sched *sched, uint32_t playout_delay_us,
+                     uint32_t late_threshold_us);
+
+/*
+* Prepare a channel. sample_size covers all lanes of one sample, buf holds
+* the samples waiting for release, VBUS_SCHED_ENTRY_SIZE(sample_size) bytes
+* each.
+*/
+int vbus_sched_channel_init(struct vbus_sched_channel *channel, uint8_t channel_idx,
+                            uint16_t sample_size, uint32_t period_us, uint8_t *buf,
+                            uint32_t buf_size, vbus_sched_release_t release, void *user_data);
+
+/*
+* Returns -EALREADY if the channel index is taken and -ENOMEM if
+* VBUS_SCHED_MAX_CHANNELS are attached already.
+*/
+int vbus_sched_attach(struct vbus_sched *sched, struct vbus_sched_channel *channel);
+
+/*
+* Queue the samples of a raw frame, expand compressed frames with
+* vbus_frame_expand() first. Samples that do not fit the channel buffer are
+* dropped and counted as overruns. Returns the number of queued samples,
+* -ENOENT for an unattached channel, -ENOTSUP for a compressed payload and
+* -EINVAL for a payload that is not whole samples or, in timestamp mode, a
+* frame without sample_delta_us.
+*/
+int vbus_sched_push(struct vbus_sched *sched, const struct vbus_frame *frame);
+
+/*
+* Drop all held samples and forget the time anchors, e.g. when the host
+* disconnects. Metrics are kept.
+*/
+void vbus_sched_reset(struct vbus_sched *sched);
+
+/*
+* Consistent snapshot of the metrics of a channel.
+*/
+void vbus_sched_metrics_get(struct vbus_sched *sched, const struct vbus_sched_channel *channel,
+                            struct vbus_sched_metrics *metrics);
+
+#endif
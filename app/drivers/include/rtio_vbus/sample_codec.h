@@ -0,0 +1,61 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CODEC_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CODEC_H
+
+#include <stdint.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Payload codec selection in the v2 header flags byte:
+*
+*   bits 0-1: codec, see VBUS_FRAME_CODEC_*
+*   bit 2:    samples are 32 bit, 16 bit otherwise
+*   bits 4-7: number of interleaved channels minus one
+*
+* Samples are big endian. A compressed payload holds sample_count sample
+* sets of one sample per channel. Both codecs take the difference of every
+* sample to the previous sample of the same channel, wrapping at the sample
+* width so the expansion is bit exact, and zigzag it. The first set is
+* relative to zero, frames do not depend on each other.
+*
+* DELTA_VARINT stores every value as a LEB128 varint. DELTA_BITPACK stores
+* blocks of VBUS_SAMPLE_BITPACK_BLOCK values as one bit width byte followed
+* by the values packed LSB first at that width; it is the one to use for
+* 16 bit samples, where a varint can never take less than half a sample.
+*/
+#define VBUS_FRAME_FLAG_CODEC_MASK 0x03
+#define VBUS_FRAME_CODEC_RAW 0x00
+#define VBUS_FRAME_CODEC_DELTA_VARINT 0x01
+#define VBUS_FRAME_CODEC_DELTA_BITPACK 0x02
+#define VBUS_SAMPLE_BITPACK_BLOCK 16
+#define VBUS_FRAME_FLAG_SAMPLE_32 0x04
+#define VBUS_FRAME_FLAG_LANES_SHIFT 4
+#define VBUS_SAMPLE_MAX_LANES 16
+
+#define VBUS_SAMPLE_FLAGS(codec, sample_size, lanes)                                 \
+    ((codec) | ((sample_size) == 4 ? VBUS_FRAME_FLAG_SAMPLE_32 : 0) |               \
+     (((lanes) - 1) << VBUS_FRAME_FLAG_LANES_SHIFT))
+
+/*
+* Compress sample_count sample sets laid out as flags describe. If out is
+* NULL, only the compressed size is stored in out_size. Returns -ENOBUFS if
+* capacity is too small and -EINVAL for raw or unknown codec flags.
+*/
+int vbus_sample_encode(const uint8_t *samples, uint32_t sample_count, uint8_t flags,
+                       uint8_t *out, uint32_t capacity, uint32_t *out_size);
+
+/*
+* Payload size of a frame after expansion, negative errno for unknown
+* codec flags.
+*/
+int vbus_frame_expanded_size(const struct vbus_frame *frame);
+
+/*
+* Expand the frame payload straight into the consumer buffer. Raw payloads
+* are copied. Returns the number of bytes written, -ENOBUFS if capacity is
+* too small and -EBADMSG if a compressed payload is malformed.
+*/
+int vbus_frame_expand(const struct vbus_frame *frame, uint8_t *out, uint32_t capacity);
+
+#endif
@@ -0,0 +1,57 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CONVERT_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CONVERT_H
+
+#include <stdint.h>
+
+/*
+* Bulk conversion of big endian payload samples, e.g. a raw or expanded
+* frame payload, into q31 or float arrays. Sources may be unaligned, count
+* is the number of samples.
+*
+*   s16 to q31:  value << 16
+*   s32 to q31:  value
+*   f32 to q31:  value * 2^31, rounded to nearest even, saturated, NaN is 0
+*   s16 to f32:  (float)value * scale
+*   s32 to f32:  (float)value * scale, rounded to float before scaling
+*   f32 to f32:  value
+*
+* Every implementation gives bit identical results. Float results assume
+* single precision arithmetic without excess precision, which holds on
+* Cortex-M and SSE2 hosts but not for x87 code.
+*/
+enum vbus_convert_impl {
+    // One sample per step, the reference
+    VBUS_CONVERT_SCALAR,
+    // Byte swaps several samples per 64 bit word, little endian CPUs
+    VBUS_CONVERT_SWAR,
+    // Helium on Cortex-M, SSE2 or NEON on hosts, if built in
+    VBUS_CONVERT_SIMD,
+    VBUS_CONVERT_IMPL_COUNT,
+};
+
+struct vbus_convert_ops {
+    const char *name;
+    void (*s16_to_q31)(const uint8_t *src, int32_t *dst, uint32_t count);
+    void (*s32_to_q31)(const uint8_t *src, int32_t *dst, uint32_t count);
+    void (*f32_to_q31)(const uint8_t *src, int32_t *dst, uint32_t count);
+    void (*s16_to_f32)(const uint8_t *src, float *dst, uint32_t count, float scale);
+    void (*s32_to_f32)(const uint8_t *src, float *dst, uint32_t count, float scale);
+    void (*f32_to_f32)(const uint8_t *src, float *dst, uint32_t count);
+};
+
+/*
+* Operations of one implementation, NULL if it is not part of this build.
+* Meant for tests and benchmarks, the functions below pick the fastest.
+*/
+const struct vbus_convert_ops *vbus_convert_ops_get(enum vbus_convert_impl impl);
+
+void vbus_convert_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count);
+void vbus_convert_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count);
+void vbus_convert_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count);
+void vbus_convert_s16_to_f32(const uint8_t *src, float *dst, uint32_t count, float scale);
+void vbus_convert_s32_to_f32(const uint8_t *src, float *dst, uint32_t count, float scale);
+void vbus_convert_f32_to_f32(const uint8_t *src, float *dst, uint32_t count);
+
+#endif
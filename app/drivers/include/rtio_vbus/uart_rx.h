@@ -0,0 +1,141 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_UART_RX_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_UART_RX_H
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/vbus_stats.h>
+
+struct vbus_uart_rx;
+
+/*
+* Runs on the work queue with the received bytes in buffer. Bytes left in the
+* buffer are kept for the next call.
+*/
+typedef void (*vbus_uart_rx_handler_t)(struct vbus_uart_rx *rx, struct ring_buf *buffer);
+
+/*
+* Interrupt driven receive pipeline. The RX interrupt only moves bytes from
+* the UART FIFO into the ring buffer. Decoding runs on a work queue once
+* watermark bytes are buffered, or max_latency after the first byte.
+*
+* When the ring buffer is full, the RX interrupt is disabled until the
+* handler has made room, so a CDC-ACM host is throttled instead of bytes
+* being dropped. Links without such backpressure need the credits of
+* vbus_uart_rx_set_flow_ctrl() instead.
+*
+* irqs counts the RX interrupts that buffered bytes and wakeups the handler
+* runs, irqs - wakeups is the number of decode wakeups saved by coalescing.
+* The counters are written from the ISR and the work queue, read them with
+* atomic_get().
+*/
+struct vbus_uart_rx {
+    const struct device *uart;
+    struct ring_buf ring;
+    struct k_work_delayable work;
+    struct k_work_q *work_q;
+    vbus_uart_rx_handler_t handler;
+    uint32_t watermark;
+    k_timeout_t max_latency;
+    atomic_t flags;
+    atomic_t pauses;
+    atomic_t irqs;
+    atomic_t wakeups;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    struct vbus_stats *stats;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    /* Bytes received since init, traced with every enqueue */
+    uint32_t stream_pos;
+#endif
+#if defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL) ||                   \
+    defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE)
+    /* Bytes received since init, wrapping */
+    atomic_t received;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+    /* Deadline passed to init, max_latency is capped at the budget */
+    k_timeout_t init_max_latency;
+    uint32_t budget_us;
+    uint32_t min_watermark;
+    uint32_t max_watermark;
+    /* Smoothed arrival rate in bytes per second */
+    uint32_t rate;
+    uint32_t rate_received;
+    int64_t rate_start;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    struct k_work_delayable credit_work;
+    uint32_t credit_threshold;
+    k_timeout_t credit_refresh;
+    uint32_t credit_limit;
+    uint32_t credits;
+#endif
+};
+
+/*
+* Prepare the pipeline. work_q may be NULL to use the system work queue.
+*/
+int vbus_uart_rx_init(struct vbus_uart_rx *rx, const struct device *uart,
+                      uint8_t *buf, uint32_t buf_size, uint32_t watermark,
+                      k_timeout_t max_latency, vbus_uart_rx_handler_t handler,
+                      struct k_work_q *work_q);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+/*
+* Record the ring buffer high-water mark and RX pauses in stats, NULL
+* detaches it.
+*/
+void vbus_uart_rx_set_stats(struct vbus_uart_rx *rx, struct vbus_stats *stats);
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+/*
+* Advertise the free ring space to the host as credit frames on the TX side
+* of the UART, see rtio_vbus/flow_ctrl.h. A credit goes out when reception
+* starts, after a handler call that moved the limit by threshold bytes or
+* left the host with less than threshold bytes of its window, and every
+* refresh period, so a host that opens the port late or loses a credit
+* catches up. K_FOREVER disables the refresh. Call between
+* vbus_uart_rx_init() and vbus_uart_rx_start(), returns -EBUSY while running.
+*/
+int vbus_uart_rx_set_flow_ctrl(struct vbus_uart_rx *rx, uint32_t threshold,
+                               k_timeout_t refresh);
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+/*
+* Adapt the watermark to the measured arrival rate, so that a decode run
+* picks up about half a latency budget of bytes. The watermark passed to
+* vbus_uart_rx_init() is the floor, half the ring the ceiling, and the
+* deadline is capped at the budget. Use the smallest budget of the channels
+* on the link, e.g. vbus_channel_min_latency_budget_us(). 0 keeps the fixed
+* watermark. Call between vbus_uart_rx_init() and vbus_uart_rx_start(),
+* returns -EBUSY while running.
+*/
+int vbus_uart_rx_set_latency_budget(struct vbus_uart_rx *rx, uint32_t budget_us);
+#endif
+
+/*
+* Install the UART interrupt callback and enable reception.
+*/
+int vbus_uart_rx_start(struct vbus_uart_rx *rx);
+
+/*
+* Disable reception and cancel pending decode work, waiting for a handler
+* run in progress. Must not be called from the handler or an ISR. Buffered
+* bytes are kept.
+*/
+void vbus_uart_rx_stop(struct vbus_uart_rx *rx);
+
+/*
+* Drop the buffered bytes, e.g. the tail of a frame cut off by a disconnect,
+* before the decoder is reset for a new session. Only while stopped.
+*/
+void vbus_uart_rx_flush(struct vbus_uart_rx *rx);
+
+#endif
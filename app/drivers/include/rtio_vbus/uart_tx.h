@@ -0,0 +1,78 @@
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_UART_TX_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_UART_TX_H
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Interrupt driven transmit pipeline, the counterpart of vbus_uart_rx.
+* Threads enqueue frames or raw bytes into the ring buffer and return, they
+* never wait for the UART. The TX interrupt drains the ring with
+* uart_fifo_fill() in chunks of up to chunk_size bytes, e.g. the USB packet
+* size of a CDC-ACM UART. Draining starts once watermark bytes are queued,
+* or max_latency after the first byte, so small frames sent close together
+* leave in one chunk.
+*
+* The pipeline installs the UART interrupt callback, so it cannot share a
+* UART with vbus_uart_rx.
+*/
+struct vbus_uart_tx {
+    const struct device *uart;
+    struct ring_buf ring;
+    struct k_mutex lock;
+    struct k_work_delayable work;
+    struct k_work_q *work_q;
+    enum vbus_frame_version version;
+    uint32_t watermark;
+    k_timeout_t max_latency;
+    uint32_t chunk_size;
+    atomic_t flags;
+    uint32_t dropped;
+};
+
+/*
+* Prepare the pipeline. work_q runs the deadline and may be NULL to use the
+* system work queue.
+*/
+int vbus_uart_tx_init(struct vbus_uart_tx *tx, const struct device *uart, uint8_t *buf,
+                      uint32_t buf_size, uint32_t watermark, k_timeout_t max_latency,
+                      uint32_t chunk_size, struct k_work_q *work_q);
+
+/*
+* Frames are sent in v1 after init. Must not be called while frames of the
+* previous version are queued.
+*/
+int vbus_uart_tx_set_version(struct vbus_uart_tx *tx, enum vbus_frame_version version);
+
+/*
+* Encode frames into the ring. Either all frames are queued or, on -ENOBUFS,
+* none is and the call is counted in dropped. Safe to call from any thread.
+*/
+int vbus_uart_tx_send(struct vbus_uart_tx *tx, const struct vbus_frame **frames,
+                      uint32_t frame_count);
+
+/*
+* Queue raw bytes, all or nothing like vbus_uart_tx_send().
+*/
+int vbus_uart_tx_write(struct vbus_uart_tx *tx, const uint8_t *data, uint32_t size);
+
+/*
+* Start draining now, without waiting for the watermark or the deadline.
+*/
+void vbus_uart_tx_flush(struct vbus_uart_tx *tx);
+
+/*
+* Install the UART interrupt callback. Bytes queued before are sent.
+*/
+int vbus_uart_tx_start(struct vbus_uart_tx *tx);
+
+/*
+* Disable transmission and cancel a pending deadline. Queued bytes are kept.
+*/
+void vbus_uart_tx_stop(struct vbus_uart_tx *tx);
+
+#endif
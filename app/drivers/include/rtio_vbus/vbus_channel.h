@@ -0,0 +1,90 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_VBUS_CHANNEL_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_VBUS_CHANNEL_H
+
+#include <stdint.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+#include <rtio_vbus/frame_demux.h>
+
+/*
+* Channels of vsense,vbus devicetree nodes. For every enabled bus node the
+* build generates, without any runtime allocation:
+*
+*   - one statically sized queue per vsense,vbus-channel child
+*   - a constant descriptor per channel
+*   - a channel index to descriptor table of the bus
+*   - a vbus_demux of the bus with every queue already registered
+*
+* Dispatching a frame is then a single array index, see
+* vbus_demux_dispatch(). The demux must not be passed to vbus_demux_init(),
+* which would clear its routes.
+*/
+
+// Values of the sample-format property, in the order of its enum
+enum vbus_sample_format {
+    VBUS_SAMPLE_RAW,
+    VBUS_SAMPLE_S16,
+    VBUS_SAMPLE_S32,
+    VBUS_SAMPLE_F32,
+};
+
+struct vbus_channel {
+    struct vbus_spsc_queue *queue;
+    uint32_t latency_budget_us;
+    uint16_t frame_size;
+    uint8_t channel_idx;
+    uint8_t sample_format;
+};
+
+#define VBUS_CHANNEL_DT_NAME(node_id) _CONCAT(__vbus_channel_dts_ord_, DT_DEP_ORD(node_id))
+#define VBUS_CHANNEL_TABLE_DT_NAME(node_id)                                         \
+    _CONCAT(__vbus_channel_table_dts_ord_, DT_DEP_ORD(node_id))
+#define VBUS_DEMUX_DT_NAME(node_id) _CONCAT(__vbus_demux_dts_ord_, DT_DEP_ORD(node_id))
+
+/*
+* Descriptor of a vsense,vbus-channel node.
+*/
+#define VBUS_CHANNEL_DT_GET(node_id) (&VBUS_CHANNEL_DT_NAME(node_id))
+
+/*
+* Table of VBUS_DEMUX_CHANNEL_COUNT descriptors of a vsense,vbus node,
+* indexed by channel index. Entries of undefined channels are NULL.
+*/
+#define VBUS_CHANNEL_TABLE_DT_GET(node_id) (VBUS_CHANNEL_TABLE_DT_NAME(node_id))
+
+/*
+* Demux of a vsense,vbus node routing frames to the queues of its channels.
+*/
+#define VBUS_DEMUX_DT_GET(node_id) (&VBUS_DEMUX_DT_NAME(node_id))
+
+/*
+* Smallest non-zero latency budget in a channel table, 0 if no channel has
+* one. Meant for vbus_uart_rx_set_latency_budget().
+*/
+static inline uint32_t
+vbus_channel_min_latency_budget_us(const struct vbus_channel *const *table) {
+    uint32_t budget_us = 0;
+
+    for (uint32_t i = 0; i < VBUS_DEMUX_CHANNEL_COUNT; i++) {
+        if (table[i] && table[i]->latency_budget_us > 0 &&
+            (budget_us == 0 || table[i]->latency_budget_us < budget_us)) {
+            budget_us = table[i]->latency_budget_us;
+        }
+    }
+    return budget_us;
+}
+
+#define VBUS_CHANNEL_DT_DECLARE(node_id)                                            \
+    extern const struct vbus_channel VBUS_CHANNEL_DT_NAME(node_id);
+
+#define VBUS_BUS_DT_DECLARE(node_id)                                                \
+    extern const struct vbus_channel *const                                         \
+        VBUS_CHANNEL_TABLE_DT_NAME(node_id)[VBUS_DEMUX_CHANNEL_COUNT];              \
+    extern struct vbus_demux VBUS_DEMUX_DT_NAME(node_id);                           \
+    DT_FOREACH_CHILD_STATUS_OKAY(node_id, VBUS_CHANNEL_DT_DECLARE)
+
+DT_FOREACH_STATUS_OKAY(vsense_vbus, VBUS_BUS_DT_DECLARE)
+
+#endif
@@ -0,0 +1,71 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_RTIO_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_RTIO_H
+
+#include <stdint.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/sys/mpsc_lockfree.h>
+#include <zephyr/sys/util.h>
+#include <rtio_vbus/data_frame.h>
+
+#define VBUS_RTIO_CHANNEL_COUNT 256
+
+extern const struct rtio_iodev_api vbus_rtio_iodev_api;
+
+/*
+* Per-channel iodev data. Read submissions wait in the pending queue until a
+* frame of the channel has been decoded.
+*/
+struct vbus_rtio_channel {
+    struct mpsc pending;
+    uint8_t channel_idx;
+    uint32_t completed;
+    uint32_t dropped;
+};
+
+/*
+* Virtual RTIO bus, maps channel indices to the iodevs attached to it.
+*/
+struct vbus_rtio {
+    const struct rtio_iodev *iodevs[VBUS_RTIO_CHANNEL_COUNT];
+    uint32_t unrouted;
+};
+
+/*
+* Define an iodev that reads frames of one vbus channel. Submit RTIO_OP_RX
+* SQEs to it, e.g. with rtio_sqe_prep_read_with_pool() or
+* rtio_sqe_prep_read_multishot().
+*/
+#define VBUS_RTIO_IODEV_DEFINE(name, channel_idx_)                                  \
+    static struct vbus_rtio_channel _CONCAT(name, _channel) = {                     \
+        .pending = MPSC_INIT(_CONCAT(name, _channel).pending),                      \
+        .channel_idx = (channel_idx_),                                              \
+    };                                                                              \
+    RTIO_IODEV_DEFINE(name, &vbus_rtio_iodev_api, &_CONCAT(name, _channel))
+
+void vbus_rtio_init(struct vbus_rtio *bus);
+
+/*
+* Attach a channel iodev to the bus. Returns -EALREADY if the channel is taken.
+*/
+int vbus_rtio_attach(struct vbus_rtio *bus, const struct rtio_iodev *iodev);
+
+/*
+* Complete pending reads with a batch of decoded frames. Each frame payload
+* is copied into the buffer of the oldest pending read of its channel, which
+* may come from the RTIO mempool. Frames without a pending read are counted
+* as dropped. Returns the number of completed reads.
+*/
+uint32_t vbus_rtio_complete(struct vbus_rtio *bus, const struct vbus_frame *frames,
+                            uint32_t frame_count);
+
+/*
+* Decode up to buf_size bytes with the zero-copy view, complete pending reads
+* from it and release the view. Payloads are copied once, straight from the
+* ring buffer into RTIO owned buffers. Returns the number of completed reads
+* or a negative error from vbus_frame_decode_view().
+*/
+int vbus_rtio_process(struct vbus_rtio *bus, struct vbus_frame_view *view, uint32_t buf_size);
+
+#endif
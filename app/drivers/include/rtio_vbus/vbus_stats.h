@@ -0,0 +1,250 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_STATS_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+
+#include <zephyr/stats/stats.h>
+#include <zephyr/sys/slist.h>
+
+#define VBUS_STATS_CHANNELS CONFIG_APP_DRIVERS_RTIO_VBUS_STATS_CHANNELS
+#define VBUS_STATS_NAME_MAX 24
+
+/*
+* Counters of one data path instance. A decode call stalls when it ends on
+* a frame that is not complete yet. Decode times are kept as a histogram
+* with buckets growing by a factor of 4.
+*/
+STATS_SECT_START(vbus)
+STATS_SECT_ENTRY32(frames)
+STATS_SECT_ENTRY32(bytes)
+STATS_SECT_ENTRY32(decode_calls)
+STATS_SECT_ENTRY32(stalls)
+STATS_SECT_ENTRY32(drops)
+STATS_SECT_ENTRY32(crc_errors)
+STATS_SECT_ENTRY32(rx_pauses)
+STATS_SECT_ENTRY32(rx_irqs)
+STATS_SECT_ENTRY32(rx_wakeups)
+STATS_SECT_ENTRY32(ring_hwm)
+STATS_SECT_ENTRY32(decode_lt_16us)
+STATS_SECT_ENTRY32(decode_lt_64us)
+STATS_SECT_ENTRY32(decode_lt_256us)
+STATS_SECT_ENTRY32(decode_lt_1ms)
+STATS_SECT_ENTRY32(decode_lt_4ms)
+STATS_SECT_ENTRY32(decode_ge_4ms)
+STATS_SECT_END;
+
+STATS_SECT_START(vbus_chan)
+STATS_SECT_ENTRY32(frames)
+STATS_SECT_ENTRY32(bytes)
+STATS_SECT_ENTRY32(drops)
+STATS_SECT_END;
+
+/*
+* Statistics of one data path, shared by the pipeline stages attached to
+* it. Channels from VBUS_STATS_CHANNELS up only show in the instance totals.
+* Every group is registered with Zephyr STATS, the channels as
+* "<name>_ch<idx>".
+*
+* The RX interrupt updates the ring and rx_* counters while the decode work
+* updates the rest, lock serializes the counters touched from both and
+* vbus_stats_reset().
+*/
+struct vbus_stats {
+    STATS_SECT_DECL(vbus) s;
+    STATS_SECT_DECL(vbus_chan) chan[VBUS_STATS_CHANNELS];
+    struct k_spinlock lock;
+    const char *name;
+    char chan_names[VBUS_STATS_CHANNELS][VBUS_STATS_NAME_MAX];
+    sys_snode_t node;
+};
+
+/*
+* Register the instance under name, which must stay valid. Registered
+* instances are listed by the "vbus stats" shell command. Returns
+* -ENAMETOOLONG if name leaves no room for the "_ch<idx>" suffix of the
+* channel groups within VBUS_STATS_NAME_MAX. Zephyr STATS cannot unregister
+* a group, so an instance is initialized once and must outlive its groups.
+*/
+int vbus_stats_init(struct vbus_stats *stats, const char *name);
+
+/*
+* Zero all counters of the instance, including the high-water mark. The
+* decode path counts without the lock, so the reset is only exact while the
+* data path is idle; a decode running meanwhile may keep a few of its
+* counts.
+*/
+void vbus_stats_reset(struct vbus_stats *stats);
+
+/*
+* Call fn for every registered instance, in registration order.
+*/
+void vbus_stats_foreach(void (*fn)(struct vbus_stats *stats, void *user_data),
+                        void *user_data);
+
+/*
+* Codec-wide count of heap allocation failures while decoding.
+*/
+uint32_t vbus_stats_alloc_fails(void);
+
+void vbus_stats_alloc_failed(void);
+
+static inline uint32_t vbus_stats_time_start(struct vbus_stats *stats) {
+    return stats ? k_cycle_get_32() : 0;
+}
+
+static inline void vbus_stats_frame(struct vbus_stats *stats, uint8_t channel_idx,
+                                    uint32_t size) {
+    if (!stats) {
+        return;
+    }
+
+    STATS_INC(stats->s, frames);
+    STATS_INCN(stats->s, bytes, size);
+    if (channel_idx < VBUS_STATS_CHANNELS) {
+        STATS_INC(stats->chan[channel_idx], frames);
+        STATS_INCN(stats->chan[channel_idx], bytes, size);
+    }
+}
+
+static inline void vbus_stats_drop(struct vbus_stats *stats, uint8_t channel_idx) {
+    if (!stats) {
+        return;
+    }
+
+    STATS_INC(stats->s, drops);
+    if (channel_idx < VBUS_STATS_CHANNELS) {
+        STATS_INC(stats->chan[channel_idx], drops);
+    }
+}
+
+// Frames failing the CRC have no trustworthy channel index
+static inline void vbus_stats_crc_errors(struct vbus_stats *stats, uint32_t count) {
+    if (stats && count > 0) {
+        STATS_INCN(stats->s, crc_errors, count);
+        STATS_INCN(stats->s, drops, count);
+    }
+}
+
+// Called from the RX interrupt and the decode work, the compare must not tear
+static inline void vbus_stats_ring_fill(struct vbus_stats *stats, uint32_t fill) {
+    if (!stats) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stats->lock);
+
+    if (fill > stats->s.ring_hwm) {
+        STATS_SET(stats->s, ring_hwm, fill);
+    }
+    k_spin_unlock(&stats->lock, key);
+}
+
+static inline void vbus_stats_rx_pause(struct vbus_stats *stats) {
+    if (stats) {
+        k_spinlock_key_t key = k_spin_lock(&stats->lock);
+
+        STATS_INC(stats->s, rx_pauses);
+        k_spin_unlock(&stats->lock, key);
+    }
+}
+
+static inline void vbus_stats_rx_irq(struct vbus_stats *stats) {
+    if (stats) {
+        k_spinlock_key_t key = k_spin_lock(&stats->lock);
+
+        STATS_INC(stats->s, rx_irqs);
+        k_spin_unlock(&stats->lock, key);
+    }
+}
+
+static inline void vbus_stats_rx_wakeup(struct vbus_stats *stats) {
+    if (stats) {
+        k_spinlock_key_t key = k_spin_lock(&stats->lock);
+
+        STATS_INC(stats->s, rx_wakeups);
+        k_spin_unlock(&stats->lock, key);
+    }
+}
+
+static inline void vbus_stats_decode_done(struct vbus_stats *stats, uint32_t start,
+                                          bool stalled) {
+    if (!stats) {
+        return;
+    }
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    STATS_INC(stats->s, decode_calls);
+    if (stalled) {
+        STATS_INC(stats->s, stalls);
+    }
+
+    if (us < 16) {
+        STATS_INC(stats->s, decode_lt_16us);
+    } else if (us < 64) {
+        STATS_INC(stats->s, decode_lt_64us);
+    } else if (us < 256) {
+        STATS_INC(stats->s, decode_lt_256us);
+    } else if (us < 1024) {
+        STATS_INC(stats->s, decode_lt_1ms);
+    } else if (us < 4096) {
+        STATS_INC(stats->s, decode_lt_4ms);
+    } else {
+        STATS_INC(stats->s, decode_ge_4ms);
+    }
+}
+
+#define VBUS_STATS_OF(obj) ((obj)->stats)
+
+#else
+
+/*
+* Without CONFIG_APP_DRIVERS_RTIO_VBUS_STATS every hook below compiles away.
+*/
+struct vbus_stats;
+
+static inline void vbus_stats_alloc_failed(void) {
+}
+
+static inline uint32_t vbus_stats_time_start(struct vbus_stats *stats) {
+    return 0;
+}
+
+static inline void vbus_stats_frame(struct vbus_stats *stats, uint8_t channel_idx,
+                                    uint32_t size) {
+}
+
+static inline void vbus_stats_drop(struct vbus_stats *stats, uint8_t channel_idx) {
+}
+
+static inline void vbus_stats_crc_errors(struct vbus_stats *stats, uint32_t count) {
+}
+
+static inline void vbus_stats_ring_fill(struct vbus_stats *stats, uint32_t fill) {
+}
+
+static inline void vbus_stats_rx_pause(struct vbus_stats *stats) {
+}
+
+static inline void vbus_stats_rx_irq(struct vbus_stats *stats) {
+}
+
+static inline void vbus_stats_rx_wakeup(struct vbus_stats *stats) {
+}
+
+static inline void vbus_stats_decode_done(struct vbus_stats *stats, uint32_t start,
+                                          bool stalled) {
+}
+
+#define VBUS_STATS_OF(obj) ((struct vbus_stats *)NULL)
+
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_TRACE_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_TRACE_H
+
+#include <stdint.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Frame lifecycle events, emitted as Zephyr named trace events so that any
+* tracing backend records them, e.g. CTF into a file on native_sim:
+*
+*   vbus_rx        arg0 bytes enqueued by the UART RX interrupt
+*                  arg1 stream position after them
+*   vbus_header    arg0 frame id, arg1 VBUS_TRACE_INFO(channel, size)
+*   vbus_decoded   same arguments, payload complete and handed out
+*   vbus_dispatch  same arguments, routed to a queue, zbus channel or read
+*   vbus_consumed  same arguments, taken by the consumer
+*
+* The stream position counts the bytes of one receive pipeline, wrapping at
+* 32 bits. A frame is identified by the stream position right after its
+* header, so the analyzer matches it to the vbus_rx event that brought its
+* header in. host/tools/vbus_trace_analyze.py turns the events into per
+* stage latencies.
+*/
+#define VBUS_TRACE_INFO(channel_idx, size) (((uint32_t)(channel_idx) << 24) | ((size) & 0xFFFFFF))
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+
+#include <zephyr/tracing/tracing.h>
+
+static inline void vbus_trace_frame(const char *name, const struct vbus_frame *frame) {
+    sys_trace_named_event(name, frame->trace_id,
+                          VBUS_TRACE_INFO(frame->channel_idx, frame->size));
+}
+
+static inline void vbus_trace_rx(uint32_t size, uint32_t stream_pos) {
+    sys_trace_named_event("vbus_rx", size, stream_pos);
+}
+
+static inline void vbus_trace_header(const struct vbus_frame *frame) {
+    vbus_trace_frame("vbus_header", frame);
+}
+
+static inline void vbus_trace_decoded(const struct vbus_frame *frame) {
+    vbus_trace_frame("vbus_decoded", frame);
+}
+
+static inline void vbus_trace_dispatch(const struct vbus_frame *frame) {
+    vbus_trace_frame("vbus_dispatch", frame);
+}
+
+/*
+* Called by the library where it hands frames over for good, e.g. by
+* vbus_spsc_release(). Consumers that take frames from a decoder callback
+* or a zbus listener call it themselves once they are done with the frame.
+*/
+static inline void vbus_trace_consumed(const struct vbus_frame *frame) {
+    vbus_trace_frame("vbus_consumed", frame);
+}
+
+#else
+
+/*
+* Without CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING every hook compiles away.
+*/
+static inline void vbus_trace_rx(uint32_t size, uint32_t stream_pos) {
+}
+
+static inline void vbus_trace_header(const struct vbus_frame *frame) {
+}
+
+static inline void vbus_trace_decoded(const struct vbus_frame *frame) {
+}
+
+static inline void vbus_trace_dispatch(const struct vbus_frame *frame) {
+}
+
+static inline void vbus_trace_consumed(const struct vbus_frame *frame) {
+}
+
+#endif
+
+#endif
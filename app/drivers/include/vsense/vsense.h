@@ -0,0 +1,25 @@
+
+
+#ifndef ZEPHYR_DRIVER_VSENSE_H
+#define ZEPHYR_DRIVER_VSENSE_H
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <rtio_vbus/data_frame.h>
+
+/*
+* Store a frame as the latest data of a vsense device. The payload is copied,
+* so the frame may be released right after the call. Returns -EMSGSIZE if the
+* frame is larger than CONFIG_APP_DRIVERS_VSENSE_FRAME_SIZE or not a whole
+* number of samples.
+*/
+int vsense_push_frame(const struct device *dev, const struct vbus_frame *frame);
+
+/*
+* Hand every frame to the vsense device bound to its channel, found with a
+* single lookup in a table built from devicetree. Returns the number of
+* accepted frames.
+*/
+uint32_t vsense_dispatch(const struct vbus_frame *frames, uint32_t frame_count);
+
+#endif
@@ -1,2 +1,3 @@
 add_subdirectory_ifdef(CONFIG_APP_DRIVERS_RTIO_VBUS rtio_vbus)
+add_subdirectory_ifdef(CONFIG_APP_DRIVERS_VSENSE vsense)
 add_subdirectory_ifdef(CONFIG_APP_DRIVERS_DUMMY dummy)
\ No newline at end of file
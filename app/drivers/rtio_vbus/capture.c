@@ -0,0 +1,477 @@
+#include <rtio_vbus/capture.h>
+#include <rtio_vbus/crc32c.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "data_frame_priv.h"
+
+LOG_MODULE_REGISTER(vbus_capture, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+// File header layout
+#define FILE_MAGIC_OFFSET 0
+#define FILE_FORMAT_OFFSET 4
+#define FILE_VERSION_OFFSET 5
+#define FILE_BLOCK_SIZE_OFFSET 8
+
+// Block header layout, the CRC covers everything before it and the used data
+#define BLOCK_NO_OFFSET 0
+#define BLOCK_USED_OFFSET 4
+#define BLOCK_TIMESTAMP_OFFSET 8
+#define BLOCK_STREAM_OFFSET 16
+#define BLOCK_FRAME_OFFSET 24
+#define BLOCK_CRC_OFFSET 28
+
+#define BLOCK_DATA(block) (&(block)[VBUS_CAPTURE_BLOCK_HEADER_SIZE])
+
+static inline off_t block_position(uint32_t block_size, uint32_t block_no) {
+    return VBUS_CAPTURE_FILE_HEADER_SIZE + (off_t)block_no * block_size;
+}
+
+static uint32_t block_crc(const uint8_t *block, uint32_t used) {
+    uint32_t crc = vbus_crc32c_update(0, block, BLOCK_CRC_OFFSET);
+
+    return vbus_crc32c_update(crc, BLOCK_DATA(block), used);
+}
+
+static void parse_block_info(const uint8_t *block, struct vbus_capture_block_info *info) {
+    info->block_no = sys_get_be32(&block[BLOCK_NO_OFFSET]);
+    info->used = sys_get_be32(&block[BLOCK_USED_OFFSET]);
+    info->timestamp_ns = sys_get_be64(&block[BLOCK_TIMESTAMP_OFFSET]);
+    info->stream_offset = sys_get_be64(&block[BLOCK_STREAM_OFFSET]);
+    info->frame_offset = sys_get_be32(&block[BLOCK_FRAME_OFFSET]);
+}
+
+static int write_all(struct fs_file_t *file, const uint8_t *data, size_t size) {
+    ssize_t ret = fs_write(file, data, size);
+
+    if (ret < 0) {
+        return (int)ret;
+    }
+
+    return (size_t)ret == size ? 0 : -ENOSPC;
+}
+
+static int read_at(struct fs_file_t *file, off_t position, uint8_t *data, size_t size) {
+    int ret = fs_seek(file, position, FS_SEEK_SET);
+    if (ret) {
+        return ret;
+    }
+
+    ssize_t read = fs_read(file, data, size);
+    if (read < 0) {
+        return (int)read;
+    }
+
+    return (size_t)read == size ? 0 : -EBADMSG;
+}
+
+int vbus_capture_open(struct vbus_capture *capture, const char *path, uint8_t *block,
+                      uint32_t block_size, enum vbus_frame_version version) {
+    if (!capture || !path || !block || block_size <= VBUS_CAPTURE_BLOCK_HEADER_SIZE) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (vbus_frame_header_size(version) == 0) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    memset(capture, 0, sizeof(*capture));
+    capture->block = block;
+    capture->block_size = block_size;
+    capture->info.frame_offset = VBUS_CAPTURE_NO_FRAME;
+    // The size field follows the channel index, after the marker of sync frames
+    capture->frame_lead = vbus_frame_is_sync(version) ? VBUS_FRAME_SYNC_MARKER_SIZE : 0;
+    capture->frame_overhead = capture->frame_lead + vbus_frame_header_size(version) +
+                              (vbus_frame_is_sync(version) ? VBUS_FRAME_CRC_SIZE : 0);
+    fs_file_t_init(&capture->file);
+
+    // Replace an older capture, the new one is only ever appended to
+    int ret = fs_unlink(path);
+    if (ret && ret != -ENOENT) {
+        LOG_ERR("Cannot remove %s (%d)", path, ret);
+        return ret;
+    }
+
+    ret = fs_open(&capture->file, path, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
+    if (ret) {
+        LOG_ERR("Cannot create %s (%d)", path, ret);
+        return ret;
+    }
+
+    uint8_t header[VBUS_CAPTURE_FILE_HEADER_SIZE] = {0};
+
+    memcpy(&header[FILE_MAGIC_OFFSET], VBUS_CAPTURE_MAGIC, 4);
+    header[FILE_FORMAT_OFFSET] = VBUS_CAPTURE_FORMAT;
+    header[FILE_VERSION_OFFSET] = (uint8_t)version;
+    sys_put_be32(block_size, &header[FILE_BLOCK_SIZE_OFFSET]);
+
+    ret = write_all(&capture->file, header, sizeof(header));
+    if (ret) {
+        LOG_ERR("Cannot write capture header (%d)", ret);
+        fs_close(&capture->file);
+        return ret;
+    }
+
+    return 0;
+}
+
+static int write_block(struct vbus_capture *capture) {
+    struct vbus_capture_block_info *info = &capture->info;
+    uint8_t *block = capture->block;
+    uint32_t capacity = capture->block_size - VBUS_CAPTURE_BLOCK_HEADER_SIZE;
+
+    // Every block has the same size on disk, pad a partial one
+    memset(&BLOCK_DATA(block)[info->used], 0, capacity - info->used);
+
+    sys_put_be32(info->block_no, &block[BLOCK_NO_OFFSET]);
+    sys_put_be32(info->used, &block[BLOCK_USED_OFFSET]);
+    sys_put_be64(info->timestamp_ns, &block[BLOCK_TIMESTAMP_OFFSET]);
+    sys_put_be64(info->stream_offset, &block[BLOCK_STREAM_OFFSET]);
+    sys_put_be32(info->frame_offset, &block[BLOCK_FRAME_OFFSET]);
+    sys_put_be32(block_crc(block, info->used), &block[BLOCK_CRC_OFFSET]);
+
+    int ret = write_all(&capture->file, block, capture->block_size);
+    if (ret) {
+        // A short write breaks the block stride, keep what is on disk so far
+        LOG_ERR("Capture block %u write failed (%d), capture stopped", info->block_no, ret);
+        capture->error = -EIO;
+        return capture->error;
+    }
+
+    info->block_no++;
+    info->used = 0;
+    info->frame_offset = VBUS_CAPTURE_NO_FRAME;
+    return 0;
+}
+
+/*
+* Record the frames starting in a chunk just copied to the block at
+* block_offset, whose first byte is at stream offset chunk_start.
+*/
+static void track_frames(struct vbus_capture *capture, const uint8_t *chunk, uint32_t size,
+                         uint32_t block_offset, uint64_t chunk_start) {
+    struct vbus_capture_block_info *info = &capture->info;
+    uint64_t chunk_end = chunk_start + size;
+
+    while (capture->frame_known && capture->next_frame < chunk_end) {
+        if (capture->next_frame >= chunk_start && info->frame_offset == VBUS_CAPTURE_NO_FRAME) {
+            info->frame_offset = block_offset + (uint32_t)(capture->next_frame - chunk_start);
+        }
+
+        // The size field may arrive in a later chunk, bytes before this one are collected
+        while (capture->size_fill < sizeof(capture->size_field)) {
+            uint64_t pos = capture->next_frame + capture->frame_lead + 1 + capture->size_fill;
+            if (pos >= chunk_end) {
+                return;
+            }
+            capture->size_field[capture->size_fill++] = chunk[pos - chunk_start];
+        }
+
+        capture->next_frame += capture->frame_overhead + sys_get_be16(capture->size_field);
+        capture->size_fill = 0;
+    }
+}
+
+int vbus_capture_write(struct vbus_capture *capture, const uint8_t *data, uint32_t size,
+                       bool frame_start) {
+    struct vbus_capture_block_info *info = &capture->info;
+    uint32_t capacity = capture->block_size - VBUS_CAPTURE_BLOCK_HEADER_SIZE;
+    uint64_t timestamp_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+
+    if (capture->error) {
+        return capture->error;
+    }
+
+    if (frame_start) {
+        capture->frame_known = true;
+        capture->next_frame = capture->stream_offset;
+        capture->size_fill = 0;
+    }
+
+    while (size > 0) {
+        if (info->used == 0) {
+            info->timestamp_ns = timestamp_ns;
+            info->stream_offset = capture->stream_offset;
+        }
+
+        uint32_t chunk = MIN(size, capacity - info->used);
+
+        memcpy(&BLOCK_DATA(capture->block)[info->used], data, chunk);
+        track_frames(capture, data, chunk, info->used, capture->stream_offset);
+        info->used += chunk;
+        capture->stream_offset += chunk;
+        data += chunk;
+        size -= chunk;
+
+        if (info->used == capacity) {
+            int ret = write_block(capture);
+            if (ret) {
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int vbus_capture_flush(struct vbus_capture *capture) {
+    if (capture->error) {
+        return capture->error;
+    }
+
+    if (capture->info.used > 0) {
+        int ret = write_block(capture);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return fs_sync(&capture->file);
+}
+
+int vbus_capture_close(struct vbus_capture *capture) {
+    int ret = vbus_capture_flush(capture);
+    int close_ret = fs_close(&capture->file);
+
+    return ret ? ret : close_ret;
+}
+
+int vbus_capture_reader_open(struct vbus_capture_reader *reader, const char *path,
+                             uint8_t *block, uint32_t block_size, uint8_t *ring_storage,
+                             uint32_t ring_size, struct vbus_frame *frames,
+                             uint32_t frame_capacity) {
+    if (!reader || !path || !block || !ring_storage || !frames || frame_capacity == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    fs_file_t_init(&reader->file);
+
+    int ret = fs_open(&reader->file, path, FS_O_READ);
+    if (ret) {
+        LOG_ERR("Cannot open %s (%d)", path, ret);
+        return ret;
+    }
+
+    uint8_t header[VBUS_CAPTURE_FILE_HEADER_SIZE];
+
+    ret = read_at(&reader->file, 0, header, sizeof(header));
+    if (ret == 0 && (memcmp(&header[FILE_MAGIC_OFFSET], VBUS_CAPTURE_MAGIC, 4) != 0 ||
+                     header[FILE_FORMAT_OFFSET] != VBUS_CAPTURE_FORMAT)) {
+        ret = -EBADMSG;
+    }
+    if (ret) {
+        LOG_ERR("%s is not a capture (%d)", path, ret);
+        goto err;
+    }
+
+    reader->version = header[FILE_VERSION_OFFSET];
+    reader->block_size = sys_get_be32(&header[FILE_BLOCK_SIZE_OFFSET]);
+    if (reader->block_size <= VBUS_CAPTURE_BLOCK_HEADER_SIZE) {
+        ret = -EBADMSG;
+        goto err;
+    }
+
+    if (reader->block_size > block_size || ring_size < 2 * reader->block_size) {
+        LOG_ERR("Buffers too small for %u byte blocks", reader->block_size);
+        ret = -ENOBUFS;
+        goto err;
+    }
+
+    ret = fs_seek(&reader->file, 0, FS_SEEK_END);
+    if (ret) {
+        goto err;
+    }
+
+    off_t file_size = fs_tell(&reader->file);
+    if (file_size < VBUS_CAPTURE_FILE_HEADER_SIZE) {
+        ret = file_size < 0 ? (int)file_size : -EBADMSG;
+        goto err;
+    }
+
+    // A block cut short by a power loss is not counted
+    reader->block_count = (file_size - VBUS_CAPTURE_FILE_HEADER_SIZE) / reader->block_size;
+    reader->block = block;
+
+    ring_buf_init(&reader->ring, ring_size, ring_storage);
+    vbus_frame_view_init(&reader->view, &reader->ring, frames, frame_capacity);
+    // The block is copied into the ring before decoding, it can bounce
+    vbus_frame_view_set_bounce(&reader->view, block, block_size);
+    ret = vbus_frame_view_set_version(&reader->view, reader->version);
+    if (ret) {
+        LOG_ERR("Capture of unsupported frame version %d", reader->version);
+        goto err;
+    }
+
+    // A block written in full but torn mid-write fails its CRC instead
+    if (reader->block_count > 0) {
+        uint8_t *last = block;
+        struct vbus_capture_block_info info;
+
+        ret = read_at(&reader->file, block_position(reader->block_size, reader->block_count - 1),
+                      last, reader->block_size);
+        if (ret) {
+            goto err;
+        }
+
+        parse_block_info(last, &info);
+        if (info.used > reader->block_size - VBUS_CAPTURE_BLOCK_HEADER_SIZE ||
+            block_crc(last, info.used) != sys_get_be32(&last[BLOCK_CRC_OFFSET])) {
+            LOG_WRN("Ignoring torn block %u", reader->block_count - 1);
+            reader->block_count--;
+        }
+    }
+
+    return 0;
+
+err:
+    fs_close(&reader->file);
+    return ret;
+}
+
+int vbus_capture_reader_close(struct vbus_capture_reader *reader) {
+    return fs_close(&reader->file);
+}
+
+int vbus_capture_block_info(struct vbus_capture_reader *reader, uint32_t block_no,
+                            struct vbus_capture_block_info *info) {
+    if (block_no >= reader->block_count) {
+        return -ENOENT;
+    }
+
+    int ret = read_at(&reader->file, block_position(reader->block_size, block_no),
+                      reader->block, VBUS_CAPTURE_BLOCK_HEADER_SIZE);
+    if (ret) {
+        return ret;
+    }
+
+    parse_block_info(reader->block, info);
+    return 0;
+}
+
+/*
+* Binary search for the last block whose first byte has a timestamp before
+* key, or a stream offset at or before key, block 0 if there is none. Both
+* only grow along the file. Bytes written together share a timestamp, so a
+* block starting at the key timestamp may start inside the wanted frame.
+*/
+static int seek_block(struct vbus_capture_reader *reader, bool by_time, uint64_t key) {
+    if (reader->block_count == 0) {
+        return -ENOENT;
+    }
+
+    uint32_t low = 0;
+    uint32_t high = reader->block_count - 1;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low + 1) / 2;
+        struct vbus_capture_block_info info;
+
+        int ret = vbus_capture_block_info(reader, mid, &info);
+        if (ret) {
+            return ret;
+        }
+
+        if (by_time ? info.timestamp_ns < key : info.stream_offset <= key) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    // Bytes before the first frame of the block cannot be decoded
+    reader->next_block = low;
+    reader->resync = true;
+    ring_buf_reset(&reader->ring);
+    return 0;
+}
+
+int vbus_capture_seek_offset(struct vbus_capture_reader *reader, uint64_t stream_offset) {
+    return seek_block(reader, false, stream_offset);
+}
+
+int vbus_capture_seek_time(struct vbus_capture_reader *reader, uint64_t timestamp_ns) {
+    return seek_block(reader, true, timestamp_ns);
+}
+
+static int replay_ring(struct vbus_capture_reader *reader, vbus_capture_replay_cb_t cb,
+                       void *user_data) {
+    struct vbus_frame_view *view = &reader->view;
+    int replayed = 0;
+
+    while (true) {
+        int ret = vbus_frame_decode_view(view, ring_buf_size_get(&reader->ring));
+        if (ret < 0) {
+            return ret;
+        }
+
+        // Whatever is left is the start of a frame continued in the next block
+        if (view->frame_count == 0) {
+            return replayed;
+        }
+
+        cb(view->frames, view->frame_count, user_data);
+        replayed += view->frame_count;
+        vbus_frame_view_release(view);
+    }
+}
+
+int vbus_capture_replay(struct vbus_capture_reader *reader, vbus_capture_replay_cb_t cb,
+                        void *user_data) {
+    uint32_t capacity = reader->block_size - VBUS_CAPTURE_BLOCK_HEADER_SIZE;
+    int replayed = 0;
+
+    if (!cb) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    while (reader->next_block < reader->block_count) {
+        struct vbus_capture_block_info info;
+        uint8_t *block = reader->block;
+
+        int ret = read_at(&reader->file, block_position(reader->block_size, reader->next_block),
+                          block, reader->block_size);
+        if (ret) {
+            return ret;
+        }
+
+        parse_block_info(block, &info);
+        if (info.used > capacity ||
+            block_crc(block, info.used) != sys_get_be32(&block[BLOCK_CRC_OFFSET])) {
+            LOG_ERR("Capture block %u is corrupted", reader->next_block);
+            reader->crc_errors++;
+            return -EBADMSG;
+        }
+        reader->next_block++;
+
+        uint32_t start = 0;
+        if (reader->resync) {
+            if (info.frame_offset == VBUS_CAPTURE_NO_FRAME || info.frame_offset > info.used) {
+                continue;
+            }
+            start = info.frame_offset;
+            reader->resync = false;
+        }
+
+        // Only a frame larger than the block can keep the ring from draining
+        if (ring_buf_space_get(&reader->ring) < info.used - start) {
+            return -ENOBUFS;
+        }
+        ring_buf_put(&reader->ring, &BLOCK_DATA(block)[start], info.used - start);
+
+        ret = replay_ring(reader, cb, user_data);
+        if (ret < 0) {
+            return ret;
+        }
+        replayed += ret;
+    }
+
+    return replayed;
+}
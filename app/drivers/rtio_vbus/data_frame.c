@@ -0,0 +1,704 @@
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/crc32c.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "data_frame_priv.h"
+
+LOG_MODULE_REGISTER(vbus_frame, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_ALLOC_COUNT
+static atomic_t alloc_count;
+
+uint32_t vbus_frame_alloc_count(void) {
+    return (uint32_t)atomic_get(&alloc_count);
+}
+
+#define count_alloc() atomic_inc(&alloc_count)
+#else
+#define count_alloc()
+#endif
+
+/*
+* All heap traffic of the codec goes through these two, so the allocation
+* counter sees every k_malloc()/k_realloc() call.
+*/
+static inline void *frame_malloc(size_t size) {
+    count_alloc();
+    return k_malloc(size);
+}
+
+static inline void *frame_realloc(void *ptr, size_t size) {
+    count_alloc();
+    return k_realloc(ptr, size);
+}
+
+uint32_t vbus_frame_header_size(enum vbus_frame_version version) {
+    const struct vbus_frame_format *format = vbus_frame_format_get(version);
+
+    return format ? format->header_size : 0;
+}
+
+enum vbus_frame_version vbus_frame_negotiate(uint32_t peer_versions) {
+    uint32_t common = peer_versions & VBUS_FRAME_VERSIONS_SUPPORTED;
+
+    if (common & VBUS_FRAME_VERSION_BIT(VBUS_FRAME_V2)) {
+        return VBUS_FRAME_V2;
+    }
+
+    return VBUS_FRAME_V1;
+}
+
+int frame_cursor_init(struct vbus_frame_cursor *cursor, enum vbus_frame_version version,
+                      struct ring_buf *buffer, uint32_t buf_size) {
+    cursor->format = vbus_frame_format_get(version);
+    if (!cursor->format) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    cursor->sync = vbus_frame_is_sync(version);
+    cursor->offset = 0;
+    cursor->crc_errors = 0;
+    // A candidate longer than the whole ring buffer can never complete
+    cursor->max_frame_size = ring_buf_capacity_get(buffer);
+    cursor->claimed_size = ring_span_claim(buffer, &cursor->span, buf_size);
+    return 0;
+}
+
+/*
+* Index of the first marker byte in data, or size if there is none. Scans a
+* machine word per step: after XOR with the repeated marker byte, a matching
+* byte is zero, and the classic haszero() bit trick spots it.
+*/
+static uint32_t find_marker_byte(const uint8_t *data, uint32_t size) {
+    const uintptr_t ones = (uintptr_t)-1 / 0xFF;
+    const uintptr_t highs = ones << 7;
+    const uintptr_t pattern = ones * VBUS_FRAME_SYNC_MARKER_0;
+    uint32_t i = 0;
+
+    while (i < size && ((uintptr_t)&data[i] & (sizeof(uintptr_t) - 1)) != 0) {
+        if (data[i] == VBUS_FRAME_SYNC_MARKER_0) {
+            return i;
+        }
+        i++;
+    }
+
+    for (; size - i >= sizeof(uintptr_t); i += sizeof(uintptr_t)) {
+        uintptr_t word;
+
+        memcpy(&word, &data[i], sizeof(word));
+        word ^= pattern;
+        if ((word - ones) & ~word & highs) {
+            break;
+        }
+    }
+
+    for (; i < size; i++) {
+        if (data[i] == VBUS_FRAME_SYNC_MARKER_0) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+static inline uint8_t span_byte(const struct vbus_ring_span *span, uint32_t offset) {
+    return offset < span->len[0] ? span->seg[0][offset] : span->seg[1][offset - span->len[0]];
+}
+
+/*
+* Offset of the next sync marker at or after offset. A marker byte in the
+* last position is reported as well, since its second byte may still arrive.
+* Returns claimed_size if there is no candidate.
+*/
+static uint32_t find_marker(const struct vbus_frame_cursor *cursor, uint32_t offset) {
+    const struct vbus_ring_span *span = &cursor->span;
+
+    while (offset < cursor->claimed_size) {
+        const uint8_t *data;
+        uint32_t len;
+
+        if (offset < span->len[0]) {
+            data = span->seg[0] + offset;
+            len = span->len[0] - offset;
+        } else {
+            data = span->seg[1] + (offset - span->len[0]);
+            len = cursor->claimed_size - offset;
+        }
+
+        offset += find_marker_byte(data, len);
+        if (offset >= cursor->claimed_size) {
+            break;
+        }
+
+        if (offset + 1 == cursor->claimed_size ||
+            span_byte(span, offset + 1) == VBUS_FRAME_SYNC_MARKER_1) {
+            return offset;
+        }
+        offset++;
+    }
+
+    return cursor->claimed_size;
+}
+
+static uint32_t span_crc32c(const struct vbus_ring_span *span, uint32_t offset, uint32_t size) {
+    uint32_t crc = 0;
+
+    if (offset < span->len[0]) {
+        uint32_t n = MIN(size, span->len[0] - offset);
+        crc = vbus_crc32c_update(crc, span->seg[0] + offset, n);
+        offset += n;
+        size -= n;
+    }
+
+    if (size > 0) {
+        crc = vbus_crc32c_update(crc, span->seg[1] + (offset - span->len[0]), size);
+    }
+
+    return crc;
+}
+
+static bool cursor_next_sync(struct vbus_frame_cursor *cursor, struct vbus_frame_pos *pos) {
+    uint32_t header_size = cursor->format->header_size;
+
+    // Every byte is passed by the marker search at most once, bad candidates
+    // only move the search one byte past their marker
+    while (true) {
+        uint32_t start = find_marker(cursor, cursor->offset);
+        cursor->offset = start;
+
+        uint32_t header_offset = start + VBUS_FRAME_SYNC_MARKER_SIZE;
+        if (cursor->claimed_size - start < VBUS_FRAME_SYNC_MARKER_SIZE + header_size) {
+            return false;
+        }
+
+        ring_span_copy(&cursor->span, header_offset, cursor->header, header_size);
+        uint32_t data_size = frame_payload_size(cursor->header);
+        uint32_t crc_offset = header_offset + header_size + data_size;
+        uint32_t end = crc_offset + VBUS_FRAME_CRC_SIZE;
+
+        if (end - start > cursor->max_frame_size) {
+            LOG_DBG("Frame can never fit the buffer, resync (frame_size=%d)", data_size);
+            cursor->crc_errors++;
+            cursor->offset = start + 1;
+            continue;
+        }
+
+        if (end > cursor->claimed_size) {
+            return false;
+        }
+
+        uint8_t trailer[VBUS_FRAME_CRC_SIZE];
+        ring_span_copy(&cursor->span, crc_offset, trailer, VBUS_FRAME_CRC_SIZE);
+        if (span_crc32c(&cursor->span, header_offset, header_size + data_size) !=
+            sys_get_be32(trailer)) {
+            LOG_DBG("Frame CRC mismatch, resync (frame_size=%d)", data_size);
+            cursor->crc_errors++;
+            cursor->offset = start + 1;
+            continue;
+        }
+
+        pos->data_offset = header_offset + header_size;
+        pos->data_size = data_size;
+        pos->end = end;
+        return true;
+    }
+}
+
+bool frame_cursor_next(struct vbus_frame_cursor *cursor, struct vbus_frame_pos *pos) {
+    if (cursor->sync) {
+        return cursor_next_sync(cursor, pos);
+    }
+
+    uint32_t header_size = cursor->format->header_size;
+    uint32_t available = cursor->claimed_size - cursor->offset;
+
+    if (available < header_size) {
+        return false;
+    }
+
+    ring_span_copy(&cursor->span, cursor->offset, cursor->header, header_size);
+    uint32_t data_size = frame_payload_size(cursor->header);
+
+    if (data_size + header_size > available) {
+        LOG_DBG("Insufficient data, stop decoding (frame_size=%d, bytes_available=%d)",
+                data_size, available);
+        return false;
+    }
+
+    pos->data_offset = cursor->offset + header_size;
+    pos->data_size = data_size;
+    pos->end = pos->data_offset + data_size;
+    return true;
+}
+
+static inline struct vbus_frame *create_frame(const struct vbus_frame_format *format,
+                                              const uint8_t *header,
+                                              const struct vbus_ring_span *span, uint32_t offset) {
+    struct vbus_frame *frame = frame_malloc(sizeof(struct vbus_frame));
+    if (!frame) {
+        LOG_ERR("Failed to allocate memory for frame");
+        vbus_stats_alloc_failed();
+        return NULL;
+    }
+    
+    format->parse_header(header, frame);
+    uint32_t size = frame->size;
+    
+    if (size == 0) {
+        frame->data = NULL;
+    } else {
+        uint8_t *frame_data = frame_malloc(size);  // Fixed: allocate 'size' bytes, not 1 byte
+        if (!frame_data) {
+            LOG_ERR("Failed to allocate memory for frame data");
+            vbus_stats_alloc_failed();
+            k_free(frame);
+            return NULL;
+        }
+        ring_span_copy(span, offset, frame_data, size);
+        frame->data = frame_data;
+    }
+    
+    return frame;
+}
+
+static void free_frames(struct vbus_frame **frames, uint32_t frame_count) {
+    for (uint32_t i = 0; i < frame_count; i++) {
+        if (frames[i]) {
+            if (frames[i]->data) {
+                k_free(frames[i]->data);
+            }
+            k_free(frames[i]);
+        }
+    }
+    k_free(frames);
+}
+
+int vbus_frame_decode(struct ring_buf *buffer, uint32_t buf_size,
+                      struct vbus_frame ***frames, uint32_t *frame_count) {
+    return vbus_frame_decode_ver(VBUS_FRAME_V1, buffer, buf_size, frames, frame_count);
+}
+
+int vbus_frame_decode_ver(enum vbus_frame_version version, struct ring_buf *buffer,
+                          uint32_t buf_size, struct vbus_frame ***frames,
+                          uint32_t *frame_count) {
+    if (!buffer || !frames || !frame_count) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (!vbus_frame_format_get(version)) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+    
+    if (buf_size > ring_buf_size_get(buffer)) {
+        LOG_ERR("Requested decode bytes cannot be greater than buffer size");
+        return -ENOTSUP;
+    }
+
+    struct vbus_frame_cursor cursor;
+    struct vbus_frame_pos pos;
+    *frame_count = 0;
+
+    // Use dynamic array with reasonable initial capacity
+    uint32_t frames_capacity = 8;
+    *frames = frame_malloc(frames_capacity * sizeof(struct vbus_frame *));
+    if (!*frames) {
+        LOG_ERR("Failed to allocate memory for frames array");
+        vbus_stats_alloc_failed();
+        return -ENOMEM;
+    }
+
+    // Claim the whole region once, frames may straddle the wrap point
+    frame_cursor_init(&cursor, version, buffer, buf_size);
+    
+    while (frame_cursor_next(&cursor, &pos)) {
+        // Expand array if needed
+        if (*frame_count >= frames_capacity) {
+            frames_capacity *= 2;
+            struct vbus_frame **new_frames = frame_realloc(*frames, 
+                                                          frames_capacity * sizeof(struct vbus_frame *));
+            if (!new_frames) {
+                LOG_ERR("Failed to expand frames array");
+                vbus_stats_alloc_failed();
+                // Cleanup existing frames, nothing is consumed from the buffer
+                free_frames(*frames, *frame_count);
+                ring_buf_get_finish(buffer, 0);
+                *frames = NULL;
+                *frame_count = 0;
+                return -ENOMEM;
+            }
+            *frames = new_frames;
+        }
+
+        (*frames)[*frame_count] = create_frame(cursor.format, cursor.header, &cursor.span,
+                                               pos.data_offset);
+        
+        if (!(*frames)[*frame_count]) {
+            // Cleanup on failure, nothing is consumed from the buffer
+            free_frames(*frames, *frame_count);
+            ring_buf_get_finish(buffer, 0);
+            *frames = NULL;
+            *frame_count = 0;
+            return -ENOMEM;
+        }
+        
+        (*frame_count)++;
+        frame_cursor_accept(&cursor, &pos);
+    }
+
+    ring_buf_get_finish(buffer, cursor.offset);
+
+    // If no frames decoded, free the array
+    if (*frame_count == 0) {
+        k_free(*frames);
+        *frames = NULL;
+    }
+
+    return 0;
+}
+
+void vbus_frame_view_init(struct vbus_frame_view *view, struct ring_buf *buffer,
+                          struct vbus_frame *frames, uint32_t frame_capacity) {
+    view->buffer = buffer;
+    view->frames = frames;
+    view->frame_capacity = frame_capacity;
+    view->frame_count = 0;
+    view->claimed_size = 0;
+    view->bounce = NULL;
+    view->bounce_size = 0;
+    view->version = VBUS_FRAME_V1;
+    view->crc_errors = 0;
+    view->oversized = 0;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    view->stats = NULL;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    view->stream_pos = 0;
+#endif
+}
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+void vbus_frame_view_set_stats(struct vbus_frame_view *view, struct vbus_stats *stats) {
+    view->stats = stats;
+}
+#endif
+
+void vbus_frame_view_set_bounce(struct vbus_frame_view *view, uint8_t *bounce,
+                                uint32_t bounce_size) {
+    view->bounce = bounce;
+    view->bounce_size = bounce ? bounce_size : 0;
+}
+
+int vbus_frame_view_set_version(struct vbus_frame_view *view,
+                                enum vbus_frame_version version) {
+    if (!vbus_frame_format_get(version)) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    if (view->claimed_size > 0) {
+        LOG_ERR("Frame view is held");
+        return -EBUSY;
+    }
+
+    view->version = version;
+    return 0;
+}
+
+int vbus_frame_decode_view(struct vbus_frame_view *view, uint32_t buf_size) {
+    if (!view || !view->buffer || !view->frames || view->frame_capacity == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (view->claimed_size > 0) {
+        LOG_ERR("Previous frame view was not released");
+        return -EBUSY;
+    }
+
+    struct vbus_stats *stats = VBUS_STATS_OF(view);
+    uint32_t start = vbus_stats_time_start(stats);
+    struct vbus_frame_cursor cursor;
+    struct vbus_frame_pos pos;
+
+    vbus_stats_ring_fill(stats, ring_buf_size_get(view->buffer));
+    int ret = frame_cursor_init(&cursor, view->version, view->buffer, buf_size);
+    if (ret) {
+        return ret;
+    }
+
+    view->frame_count = 0;
+
+    // Frames are parsed in place, the claim is held until the view is released
+    while (view->frame_count < view->frame_capacity && frame_cursor_next(&cursor, &pos)) {
+        uint32_t data_size = pos.data_size;
+        uint8_t *data = NULL;
+        if (data_size > 0) {
+            data = ring_span_contiguous(&cursor.span, pos.data_offset, data_size);
+            if (!data) {
+                // Only one payload per claim can straddle the wrap point. The frame
+                // keeps its place in the ring, so waiting for room would never end
+                if (data_size > view->bounce_size) {
+                    struct vbus_frame dropped;
+
+                    LOG_DBG("Wrapped frame does not fit bounce buffer (frame_size=%d)", data_size);
+                    cursor.format->parse_header(cursor.header, &dropped);
+                    vbus_stats_drop(stats, dropped.channel_idx);
+                    view->oversized++;
+                    frame_cursor_accept(&cursor, &pos);
+                    continue;
+                }
+                ring_span_copy(&cursor.span, pos.data_offset, view->bounce, data_size);
+                data = view->bounce;
+            }
+        }
+
+        struct vbus_frame *frame = &view->frames[view->frame_count++];
+        cursor.format->parse_header(cursor.header, frame);
+        frame->data = data;
+        vbus_stats_frame(stats, frame->channel_idx, data_size);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+        frame->trace_id = view->stream_pos + pos.data_offset;
+#endif
+        // Parsed in place, the header and the payload are there at once
+        vbus_trace_header(frame);
+        vbus_trace_decoded(frame);
+
+        frame_cursor_accept(&cursor, &pos);
+    }
+
+    // Stalled on a frame that is not complete yet, not on a full view
+    bool stalled = view->frame_count < view->frame_capacity &&
+                   cursor.offset < cursor.claimed_size;
+
+    view->crc_errors += cursor.crc_errors;
+    vbus_stats_crc_errors(stats, cursor.crc_errors);
+    if (view->frame_count == 0) {
+        // Nothing to hand out, only drop bytes that cannot start a frame
+        ring_buf_get_finish(view->buffer, cursor.offset);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+        view->stream_pos += cursor.offset;
+#endif
+        cursor.offset = 0;
+    }
+    view->claimed_size = cursor.offset;
+
+    vbus_stats_decode_done(stats, start, stalled);
+    return ret;
+}
+
+int vbus_frame_view_release(struct vbus_frame_view *view) {
+    if (!view || !view->buffer) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    int ret = 0;
+    if (view->claimed_size > 0) {
+        ret = ring_buf_get_finish(view->buffer, view->claimed_size);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+        view->stream_pos += view->claimed_size;
+#endif
+    }
+
+    view->frame_count = 0;
+    view->claimed_size = 0;
+    return ret;
+}
+
+static int encoded_size_get(enum vbus_frame_version version,
+                            const struct vbus_frame **frames, uint32_t frame_count,
+                            uint32_t *total_size) {
+    uint32_t overhead = vbus_frame_format_get(version)->header_size;
+    uint32_t size = 0;
+
+    if (vbus_frame_is_sync(version)) {
+        overhead += VBUS_FRAME_SYNC_MARKER_SIZE + VBUS_FRAME_CRC_SIZE;
+    }
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        if (!frames[i]) {
+            LOG_ERR("Invalid frame at index %u", i);
+            return -EINVAL;
+        }
+
+        // Check for frame size overflow (max 16-bit value)
+        if (frames[i]->size > 0xFFFF) {
+            LOG_ERR("Frame size too large: %u", frames[i]->size);
+            return -EINVAL;
+        }
+
+        if (frames[i]->size > 0 && !frames[i]->data) {
+            LOG_ERR("Frame at index %u has no data", i);
+            return -EINVAL;
+        }
+
+        size += overhead + frames[i]->size;
+    }
+
+    *total_size = size;
+    return 0;
+}
+
+int vbus_frame_encode_to(const struct vbus_frame **frames, uint32_t frame_count,
+                         uint8_t *buffer, uint32_t capacity, uint32_t *buf_size) {
+    return vbus_frame_encode_to_ver(VBUS_FRAME_V1, frames, frame_count, buffer, capacity,
+                                    buf_size);
+}
+
+int vbus_frame_encode_to_ver(enum vbus_frame_version version,
+                             const struct vbus_frame **frames, uint32_t frame_count,
+                             uint8_t *buffer, uint32_t capacity, uint32_t *buf_size) {
+    if (!frames || !buf_size || frame_count == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    const struct vbus_frame_format *format = vbus_frame_format_get(version);
+    if (!format) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    uint32_t total_size;
+    int ret = encoded_size_get(version, frames, frame_count, &total_size);
+    if (ret) {
+        return ret;
+    }
+
+    *buf_size = total_size;
+    if (!buffer) {
+        return 0;
+    }
+
+    if (total_size > capacity) {
+        LOG_ERR("Encode buffer too small (%u < %u)", capacity, total_size);
+        return -ENOBUFS;
+    }
+
+    bool sync = vbus_frame_is_sync(version);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const struct vbus_frame *frame = frames[i];
+        uint32_t frame_size = format->header_size + frame->size;
+
+        if (sync) {
+            buffer[offset++] = VBUS_FRAME_SYNC_MARKER_0;
+            buffer[offset++] = VBUS_FRAME_SYNC_MARKER_1;
+        }
+
+        format->write_header(frame, &buffer[offset]);
+        if (frame->size > 0) {
+            memcpy(&buffer[offset + format->header_size], frame->data, frame->size);
+        }
+
+        if (sync) {
+            sys_put_be32(vbus_crc32c_update(0, &buffer[offset], frame_size),
+                         &buffer[offset + frame_size]);
+            offset += VBUS_FRAME_CRC_SIZE;
+        }
+
+        offset += frame_size;
+    }
+
+    return 0;
+}
+
+int vbus_frame_encode(const struct vbus_frame **frames, uint32_t frame_count,
+                      uint8_t **buffer, uint32_t *buf_size) {
+    if (!frames || !buffer || !buf_size || frame_count == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    uint32_t total_size;
+    int ret = encoded_size_get(VBUS_FRAME_V1, frames, frame_count, &total_size);
+    if (ret) {
+        return ret;
+    }
+
+    *buffer = frame_malloc(total_size);
+    if (!*buffer) {
+        LOG_ERR("Failed to allocate memory for encoded frames");
+        return -ENOMEM;
+    }
+
+    return vbus_frame_encode_to(frames, frame_count, *buffer, total_size, buf_size);
+}
+
+/*
+* Copy bytes into already reserved ring buffer space. Claims are cumulative
+* until ring_buf_put_finish(), so a copy may span the wrap point.
+*/
+static void ring_put_claimed(struct ring_buf *buffer, const uint8_t *data, uint32_t size) {
+    uint8_t *claimed_data;
+
+    while (size > 0) {
+        uint32_t claimed_size = ring_buf_put_claim(buffer, &claimed_data, size);
+        memcpy(claimed_data, data, claimed_size);
+        data += claimed_size;
+        size -= claimed_size;
+    }
+}
+
+int vbus_frame_encode_ring(const struct vbus_frame **frames, uint32_t frame_count,
+                           struct ring_buf *buffer) {
+    return vbus_frame_encode_ring_ver(VBUS_FRAME_V1, frames, frame_count, buffer);
+}
+
+int vbus_frame_encode_ring_ver(enum vbus_frame_version version,
+                               const struct vbus_frame **frames, uint32_t frame_count,
+                               struct ring_buf *buffer) {
+    if (!frames || !buffer || frame_count == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    const struct vbus_frame_format *format = vbus_frame_format_get(version);
+    if (!format) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    uint32_t total_size;
+    int ret = encoded_size_get(version, frames, frame_count, &total_size);
+    if (ret) {
+        return ret;
+    }
+
+    if (total_size > ring_buf_space_get(buffer)) {
+        LOG_DBG("Insufficient ring buffer space (required=%u, free=%u)",
+                total_size, ring_buf_space_get(buffer));
+        return -ENOBUFS;
+    }
+
+    static const uint8_t marker[] = {VBUS_FRAME_SYNC_MARKER_0, VBUS_FRAME_SYNC_MARKER_1};
+    bool sync = vbus_frame_is_sync(version);
+    uint8_t header[VBUS_FRAME_MAX_HEADER_SIZE];
+    uint8_t trailer[VBUS_FRAME_CRC_SIZE];
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        if (sync) {
+            ring_put_claimed(buffer, marker, sizeof(marker));
+        }
+
+        format->write_header(frames[i], header);
+        ring_put_claimed(buffer, header, format->header_size);
+        ring_put_claimed(buffer, frames[i]->data, frames[i]->size);
+
+        if (sync) {
+            uint32_t crc = vbus_crc32c_update(0, header, format->header_size);
+            crc = vbus_crc32c_update(crc, frames[i]->data, frames[i]->size);
+            sys_put_be32(crc, trailer);
+            ring_put_claimed(buffer, trailer, sizeof(trailer));
+        }
+    }
+
+    return ring_buf_put_finish(buffer, total_size);
+}
@@ -0,0 +1,163 @@
+
+
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_FRAME_PRIV_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_FRAME_PRIV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <rtio_vbus/data_frame.h>
+
+#define HEADER_SIZE VBUS_FRAME_HEADER_SIZE
+#define CHANNEL_IDX_OFFSET 0
+#define FRAME_SIZE_FIRST_BYTE_IDX 1
+#define FRAME_SIZE_SECOND_BYTE_IDX 2
+#define FRAME_DATA_OFFSET 3
+
+
+static inline void split_two_bytes(uint32_t value, uint8_t *b1, uint8_t *b2) {
+    *b1 = (value >> 8) & 0xFF;
+    *b2 = value & 0xFF;
+}
+
+static inline uint32_t concat_two_bytes(uint8_t b1, uint8_t b2) {
+    return (uint32_t)((b1 << 8) | b2);
+}
+
+/*
+* Per version header layout. Channel index and payload size sit at the same
+* offsets in every version, only the metadata after them differs.
+*/
+struct vbus_frame_format {
+    enum vbus_frame_version version;
+    uint32_t header_size;
+    void (*parse_header)(const uint8_t *header, struct vbus_frame *frame);
+    void (*write_header)(const struct vbus_frame *frame, uint8_t *header);
+};
+
+extern const struct vbus_frame_format vbus_frame_format_v1;
+extern const struct vbus_frame_format vbus_frame_format_v2;
+
+static inline const struct vbus_frame_format *vbus_frame_format_get(enum vbus_frame_version version) {
+    switch ((int)version & ~VBUS_FRAME_SYNC) {
+    case VBUS_FRAME_V1:
+        return &vbus_frame_format_v1;
+    case VBUS_FRAME_V2:
+        return &vbus_frame_format_v2;
+    }
+
+    return NULL;
+}
+
+static inline bool vbus_frame_is_sync(enum vbus_frame_version version) {
+    return ((int)version & VBUS_FRAME_SYNC) != 0;
+}
+
+static inline uint32_t frame_payload_size(const uint8_t *header) {
+    return concat_two_bytes(header[FRAME_SIZE_FIRST_BYTE_IDX], header[FRAME_SIZE_SECOND_BYTE_IDX]);
+}
+
+/*
+* Claimed ring buffer region seen as up to two segments. The second segment
+* is only used when the region wraps past the end of the backing array.
+*/
+struct vbus_ring_span {
+    uint8_t *seg[2];
+    uint32_t len[2];
+};
+
+/*
+* Claim up to size bytes across the wrap point. Ring buffer claims are
+* cumulative, so a single ring_buf_get_finish() releases both segments.
+*/
+static inline uint32_t ring_span_claim(struct ring_buf *buffer, struct vbus_ring_span *span,
+                                       uint32_t size) {
+    span->len[0] = ring_buf_get_claim(buffer, &span->seg[0], size);
+    span->seg[1] = NULL;
+    span->len[1] = 0;
+
+    if (span->len[0] > 0 && span->len[0] < size) {
+        span->len[1] = ring_buf_get_claim(buffer, &span->seg[1], size - span->len[0]);
+    }
+
+    return span->len[0] + span->len[1];
+}
+
+static inline void ring_span_copy(const struct vbus_ring_span *span, uint32_t offset,
+                                  uint8_t *dst, uint32_t size) {
+    if (offset < span->len[0]) {
+        uint32_t n = MIN(size, span->len[0] - offset);
+        memcpy(dst, span->seg[0] + offset, n);
+        dst += n;
+        size -= n;
+        offset = span->len[0];
+    }
+
+    if (size > 0) {
+        memcpy(dst, span->seg[1] + (offset - span->len[0]), size);
+    }
+}
+
+/*
+* Pointer to size bytes at offset if they do not straddle the wrap point,
+* NULL otherwise.
+*/
+static inline uint8_t *ring_span_contiguous(const struct vbus_ring_span *span, uint32_t offset,
+                                            uint32_t size) {
+    if (offset + size <= span->len[0]) {
+        return span->seg[0] + offset;
+    }
+
+    if (offset >= span->len[0]) {
+        return span->seg[1] + (offset - span->len[0]);
+    }
+
+    return NULL;
+}
+
+/*
+* Walks the frames of one ring buffer claim. offset only moves forward:
+* past accepted frames and, in sync mode, past bytes that cannot start a
+* valid frame, so it is always safe to finish the claim at offset.
+*/
+struct vbus_frame_cursor {
+    const struct vbus_frame_format *format;
+    bool sync;
+    struct vbus_ring_span span;
+    uint32_t claimed_size;
+    uint32_t offset;
+    uint32_t max_frame_size;
+    uint32_t crc_errors;
+    uint8_t header[VBUS_FRAME_MAX_HEADER_SIZE];
+};
+
+/*
+* Location of a complete frame found by frame_cursor_next(). The parsed
+* header is left in the cursor.
+*/
+struct vbus_frame_pos {
+    uint32_t data_offset;
+    uint32_t data_size;
+    uint32_t end;
+};
+
+/*
+* Claim up to buf_size bytes. Returns -ENOTSUP for an unknown version.
+*/
+int frame_cursor_init(struct vbus_frame_cursor *cursor, enum vbus_frame_version version,
+                      struct ring_buf *buffer, uint32_t buf_size);
+
+/*
+* Find the next complete frame at or after offset. Returns false if more
+* data is needed before one can be found.
+*/
+bool frame_cursor_next(struct vbus_frame_cursor *cursor, struct vbus_frame_pos *pos);
+
+static inline void frame_cursor_accept(struct vbus_frame_cursor *cursor,
+                                       const struct vbus_frame_pos *pos) {
+    cursor->offset = pos->end;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include <rtio_vbus/data_frame.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "data_frame_priv.h"
+
+#define V2_FLAGS_OFFSET 3
+#define V2_SEQ_OFFSET 4
+#define V2_SAMPLE_COUNT_OFFSET 6
+#define V2_TIMESTAMP_OFFSET 8
+#define V2_SAMPLE_DELTA_OFFSET 12
+
+BUILD_ASSERT(V2_SAMPLE_DELTA_OFFSET + 4 == VBUS_FRAME_V2_HEADER_SIZE,
+             "v2 header layout does not match VBUS_FRAME_V2_HEADER_SIZE");
+
+
+static void v2_parse_header(const uint8_t *header, struct vbus_frame *frame) {
+    frame->channel_idx = header[CHANNEL_IDX_OFFSET];
+    frame->size = frame_payload_size(header);
+    frame->flags = header[V2_FLAGS_OFFSET];
+    frame->seq = sys_get_be16(&header[V2_SEQ_OFFSET]);
+    frame->sample_count = sys_get_be16(&header[V2_SAMPLE_COUNT_OFFSET]);
+    frame->timestamp_us = sys_get_be32(&header[V2_TIMESTAMP_OFFSET]);
+    frame->sample_delta_us = sys_get_be32(&header[V2_SAMPLE_DELTA_OFFSET]);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    frame->trace_id = 0;
+#endif
+}
+
+static void v2_write_header(const struct vbus_frame *frame, uint8_t *header) {
+    header[CHANNEL_IDX_OFFSET] = frame->channel_idx;
+    split_two_bytes(frame->size, &header[FRAME_SIZE_FIRST_BYTE_IDX],
+                    &header[FRAME_SIZE_SECOND_BYTE_IDX]);
+    header[V2_FLAGS_OFFSET] = frame->flags;
+    sys_put_be16(frame->seq, &header[V2_SEQ_OFFSET]);
+    sys_put_be16(frame->sample_count, &header[V2_SAMPLE_COUNT_OFFSET]);
+    sys_put_be32(frame->timestamp_us, &header[V2_TIMESTAMP_OFFSET]);
+    sys_put_be32(frame->sample_delta_us, &header[V2_SAMPLE_DELTA_OFFSET]);
+}
+
+const struct vbus_frame_format vbus_frame_format_v2 = {
+    .version = VBUS_FRAME_V2,
+    .header_size = VBUS_FRAME_V2_HEADER_SIZE,
+    .parse_header = v2_parse_header,
+    .write_header = v2_write_header,
+};
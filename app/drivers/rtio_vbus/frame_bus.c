@@ -0,0 +1,199 @@
+#include <rtio_vbus/frame_bus.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(vbus_frame_bus, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#define BUF_COUNT CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_BUS_BUF_COUNT
+#define BUF_SIZE CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_BUS_BUF_SIZE
+
+static void frame_buf_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_FIXED_DEFINE(vbus_frame_buf_pool, BUF_COUNT, BUF_SIZE, 0, frame_buf_destroy);
+
+// Kept here, the pool only counts with CONFIG_NET_BUF_POOL_USAGE
+static atomic_t frame_buf_free = ATOMIC_INIT(BUF_COUNT);
+
+static void frame_buf_destroy(struct net_buf *buf) {
+    atomic_inc(&frame_buf_free);
+    net_buf_destroy(buf);
+}
+
+/*
+* Publish with every step bounded by one deadline. stored tells whether the
+* frame made it into the channel, so a failed notify can be told apart.
+*/
+static int frame_publish(const struct zbus_channel *chan, const struct vbus_frame *frame,
+                         k_timeout_t timeout, bool *stored) {
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+
+    *stored = false;
+
+    if (frame->size > BUF_SIZE) {
+        LOG_DBG("Frame of %u bytes exceeds the frame buffer size", frame->size);
+        return -EMSGSIZE;
+    }
+
+    struct net_buf *buf = net_buf_alloc(&vbus_frame_buf_pool, sys_timepoint_timeout(end));
+    if (!buf) {
+        LOG_DBG("No frame buffer for channel %u", frame->channel_idx);
+        return -ENOMEM;
+    }
+    atomic_dec(&frame_buf_free);
+
+    // The only payload copy, every observer shares this buffer
+    if (frame->size > 0) {
+        net_buf_add_mem(buf, frame->data, frame->size);
+    }
+
+    int ret = zbus_chan_claim(chan, sys_timepoint_timeout(end));
+    if (ret) {
+        net_buf_unref(buf);
+        return ret;
+    }
+
+    struct vbus_frame_msg *msg = zbus_chan_msg(chan);
+    struct net_buf *previous = msg->buf;
+
+    // The channel takes over the reference of the allocation
+    msg->frame = *frame;
+    msg->frame.data = frame->size > 0 ? buf->data : NULL;
+    msg->buf = buf;
+
+    zbus_chan_finish(chan);
+    *stored = true;
+
+    if (previous) {
+        net_buf_unref(previous);
+    }
+
+    // Listeners run within the notify, so trace before it
+    vbus_trace_dispatch(frame);
+    return zbus_chan_notify(chan, sys_timepoint_timeout(end));
+}
+
+int vbus_frame_bus_publish(const struct zbus_channel *chan, const struct vbus_frame *frame,
+                           k_timeout_t timeout) {
+    bool stored;
+
+    if (!chan || !frame) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    return frame_publish(chan, frame, timeout, &stored);
+}
+
+int vbus_frame_bus_read(const struct zbus_channel *chan, struct vbus_frame_msg *msg,
+                        k_timeout_t timeout) {
+    if (!chan || !msg) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    // Claimed, so that a publish cannot drop the buffer before it is ref'd
+    int ret = zbus_chan_claim(chan, timeout);
+    if (ret) {
+        return ret;
+    }
+
+    vbus_frame_msg_ref(msg, zbus_chan_const_msg(chan));
+    zbus_chan_finish(chan);
+    if (msg->buf) {
+        vbus_trace_consumed(&msg->frame);
+    }
+    return 0;
+}
+
+int vbus_frame_bus_clear(const struct zbus_channel *chan, k_timeout_t timeout) {
+    if (!chan) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    int ret = zbus_chan_claim(chan, timeout);
+    if (ret) {
+        return ret;
+    }
+
+    struct vbus_frame_msg *msg = zbus_chan_msg(chan);
+
+    vbus_frame_msg_unref(msg);
+    zbus_chan_finish(chan);
+    return 0;
+}
+
+void vbus_frame_msg_ref(struct vbus_frame_msg *dst, const struct vbus_frame_msg *src) {
+    *dst = *src;
+    if (dst->buf) {
+        net_buf_ref(dst->buf);
+    }
+}
+
+void vbus_frame_msg_unref(struct vbus_frame_msg *msg) {
+    if (!msg) {
+        return;
+    }
+
+    if (msg->buf) {
+        net_buf_unref(msg->buf);
+    }
+
+    memset(msg, 0, sizeof(*msg));
+}
+
+uint32_t vbus_frame_buf_num_free(void) {
+    return (uint32_t)atomic_get(&frame_buf_free);
+}
+
+void vbus_frame_bus_init(struct vbus_frame_bus *bus) {
+    memset(bus, 0, sizeof(*bus));
+}
+
+int vbus_frame_bus_register(struct vbus_frame_bus *bus, uint8_t channel_idx,
+                            const struct zbus_channel *chan) {
+    if (!bus || !chan) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (bus->chans[channel_idx]) {
+        LOG_ERR("Channel %u already has a frame channel", channel_idx);
+        return -EALREADY;
+    }
+
+    bus->chans[channel_idx] = chan;
+    return 0;
+}
+
+uint32_t vbus_frame_bus_dispatch(struct vbus_frame_bus *bus, const struct vbus_frame *frames,
+                                 uint32_t frame_count, k_timeout_t timeout) {
+    uint32_t published = 0;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const struct zbus_channel *chan = bus->chans[frames[i].channel_idx];
+
+        if (!chan) {
+            bus->unrouted++;
+            continue;
+        }
+
+        bool stored;
+        int ret = frame_publish(chan, &frames[i], timeout, &stored);
+
+        if (ret == 0) {
+            published++;
+        } else if (stored) {
+            // In the channel, only some observers missed it
+            published++;
+            bus->unnotified++;
+        } else {
+            bus->dropped++;
+        }
+    }
+
+    return published;
+}
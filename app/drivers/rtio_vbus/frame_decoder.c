@@ -0,0 +1,237 @@
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "data_frame_priv.h"
+
+LOG_MODULE_REGISTER(vbus_frame_decoder, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+void vbus_frame_decoder_init(struct vbus_frame_decoder *decoder, uint8_t *payload,
+                             uint32_t payload_capacity, vbus_frame_decoder_cb_t cb,
+                             void *user_data) {
+    decoder->payload = payload;
+    decoder->payload_capacity = payload ? payload_capacity : 0;
+    decoder->cb = cb;
+    decoder->user_data = user_data;
+    decoder->dropped_frames = 0;
+    decoder->version = VBUS_FRAME_V1;
+    decoder->header_size = vbus_frame_format_v1.header_size;
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    decoder->stats = NULL;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    decoder->stream_pos = 0;
+#endif
+    vbus_frame_decoder_reset(decoder);
+}
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+void vbus_frame_decoder_set_stats(struct vbus_frame_decoder *decoder, struct vbus_stats *stats) {
+    decoder->stats = stats;
+}
+#endif
+
+int vbus_frame_decoder_set_version(struct vbus_frame_decoder *decoder,
+                                   enum vbus_frame_version version) {
+    const struct vbus_frame_format *format = vbus_frame_format_get(version);
+    if (!format || vbus_frame_is_sync(version)) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    decoder->version = version;
+    decoder->header_size = format->header_size;
+    vbus_frame_decoder_reset(decoder);
+    return 0;
+}
+
+void vbus_frame_decoder_reset(struct vbus_frame_decoder *decoder) {
+    decoder->state = VBUS_FRAME_DECODER_HEADER;
+    decoder->header_len = 0;
+    decoder->received = 0;
+}
+
+// pos is the offset of the header end within the bytes of the current feed call
+static inline void trace_header(struct vbus_frame_decoder *decoder, uint32_t pos) {
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    decoder->frame.trace_id = decoder->stream_pos + pos;
+    vbus_trace_header(&decoder->frame);
+#else
+    ARG_UNUSED(decoder);
+    ARG_UNUSED(pos);
+#endif
+}
+
+static inline void deliver_frame(struct vbus_frame_decoder *decoder, uint8_t *data) {
+    decoder->frame.data = data;
+    vbus_stats_frame(VBUS_STATS_OF(decoder), decoder->frame.channel_idx, decoder->frame.size);
+    vbus_trace_decoded(&decoder->frame);
+    if (decoder->cb) {
+        decoder->cb(&decoder->frame, decoder->user_data);
+    }
+}
+
+/*
+* Header bytes are complete, pick the state for the payload.
+* Returns 1 if an empty frame was delivered right away.
+*/
+static int on_header_complete(struct vbus_frame_decoder *decoder, uint32_t pos) {
+    vbus_frame_format_get(decoder->version)->parse_header(decoder->header, &decoder->frame);
+    trace_header(decoder, pos);
+    decoder->header_len = 0;
+    decoder->received = 0;
+
+    if (decoder->frame.size == 0) {
+        deliver_frame(decoder, NULL);
+        return 1;
+    }
+
+    if (decoder->frame.size > decoder->payload_capacity) {
+        LOG_DBG("Frame too large for decoder storage, skipping (frame_size=%d, capacity=%d)",
+                decoder->frame.size, decoder->payload_capacity);
+        decoder->dropped_frames++;
+        vbus_stats_drop(VBUS_STATS_OF(decoder), decoder->frame.channel_idx);
+        decoder->state = VBUS_FRAME_DECODER_DISCARD;
+        return 0;
+    }
+
+    decoder->state = VBUS_FRAME_DECODER_PAYLOAD;
+    return 0;
+}
+
+int vbus_frame_decoder_feed(struct vbus_frame_decoder *decoder, const uint8_t *data,
+                            uint32_t size) {
+    if (!decoder || (!data && size > 0)) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    const struct vbus_frame_format *format = vbus_frame_format_get(decoder->version);
+    uint32_t header_size = decoder->header_size;
+    int delivered = 0;
+    uint32_t offset = 0;
+
+    while (offset < size) {
+        uint32_t available = size - offset;
+        uint32_t n;
+
+        switch (decoder->state) {
+        case VBUS_FRAME_DECODER_HEADER:
+            // Fast path: whole frame is in the input, deliver it in place
+            if (decoder->header_len == 0 && available >= header_size) {
+                const uint8_t *header = data + offset;
+                uint32_t data_size = frame_payload_size(header);
+
+                if (data_size <= decoder->payload_capacity &&
+                    data_size <= available - header_size) {
+                    format->parse_header(header, &decoder->frame);
+                    trace_header(decoder, offset + header_size);
+                    deliver_frame(decoder, data_size > 0 ?
+                                  (uint8_t *)header + header_size : NULL);
+                    offset += header_size + data_size;
+                    delivered++;
+                    break;
+                }
+            }
+
+            n = MIN(available, header_size - decoder->header_len);
+            memcpy(&decoder->header[decoder->header_len], data + offset, n);
+            decoder->header_len += n;
+            offset += n;
+
+            if (decoder->header_len == header_size) {
+                delivered += on_header_complete(decoder, offset);
+            }
+            break;
+
+        case VBUS_FRAME_DECODER_PAYLOAD:
+            n = MIN(available, decoder->frame.size - decoder->received);
+            memcpy(&decoder->payload[decoder->received], data + offset, n);
+            decoder->received += n;
+            offset += n;
+
+            if (decoder->received == decoder->frame.size) {
+                deliver_frame(decoder, decoder->payload);
+                decoder->state = VBUS_FRAME_DECODER_HEADER;
+                delivered++;
+            }
+            break;
+
+        case VBUS_FRAME_DECODER_DISCARD:
+            n = MIN(available, decoder->frame.size - decoder->received);
+            decoder->received += n;
+            offset += n;
+
+            if (decoder->received == decoder->frame.size) {
+                decoder->state = VBUS_FRAME_DECODER_HEADER;
+            }
+            break;
+        }
+    }
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    decoder->stream_pos += size;
+#endif
+    return delivered;
+}
+
+int vbus_frame_decoder_feed_byte(struct vbus_frame_decoder *decoder, uint8_t byte) {
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    decoder->stream_pos++;
+#endif
+
+    switch (decoder->state) {
+    case VBUS_FRAME_DECODER_HEADER:
+        decoder->header[decoder->header_len++] = byte;
+        if (decoder->header_len == decoder->header_size) {
+            return on_header_complete(decoder, 0);
+        }
+        return 0;
+
+    case VBUS_FRAME_DECODER_PAYLOAD:
+        decoder->payload[decoder->received++] = byte;
+        if (decoder->received == decoder->frame.size) {
+            deliver_frame(decoder, decoder->payload);
+            decoder->state = VBUS_FRAME_DECODER_HEADER;
+            return 1;
+        }
+        return 0;
+
+    case VBUS_FRAME_DECODER_DISCARD:
+        if (++decoder->received == decoder->frame.size) {
+            decoder->state = VBUS_FRAME_DECODER_HEADER;
+        }
+        return 0;
+    }
+
+    return 0;
+}
+
+int vbus_frame_decoder_feed_ring(struct vbus_frame_decoder *decoder, struct ring_buf *buffer) {
+    if (!decoder || !buffer) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    struct vbus_stats *stats = VBUS_STATS_OF(decoder);
+    uint32_t start = vbus_stats_time_start(stats);
+    int delivered = 0;
+    uint8_t *claimed_data;
+    uint32_t claimed_size;
+
+    vbus_stats_ring_fill(stats, ring_buf_size_get(buffer));
+
+    // At most two iterations: up to the wrap point and from the buffer start
+    while ((claimed_size = ring_buf_get_claim(buffer, &claimed_data,
+                                              ring_buf_size_get(buffer))) > 0) {
+        delivered += vbus_frame_decoder_feed(decoder, claimed_data, claimed_size);
+        ring_buf_get_finish(buffer, claimed_size);
+    }
+
+    // Everything is consumed, a partial frame is left in the decoder state
+    vbus_stats_decode_done(stats, start, decoder->state != VBUS_FRAME_DECODER_HEADER ||
+                                         decoder->header_len > 0);
+    return delivered;
+}
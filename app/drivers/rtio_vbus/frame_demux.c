@@ -0,0 +1,104 @@
+#include <rtio_vbus/frame_demux.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(vbus_frame_demux, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+int vbus_spsc_push(struct vbus_spsc_queue *queue, const struct vbus_frame *frame) {
+    uint32_t head = (uint32_t)atomic_get(&queue->head);
+
+    if (frame->size > queue->slot_size) {
+        queue->oversized++;
+        return -EMSGSIZE;
+    }
+
+    // Only re-read the consumer index when the cached one says full
+    if (head - queue->tail_cache > queue->mask) {
+        queue->tail_cache = (uint32_t)atomic_get(&queue->tail);
+        if (head - queue->tail_cache > queue->mask) {
+            queue->overflows++;
+            return -ENOBUFS;
+        }
+    }
+
+    uint32_t idx = head & queue->mask;
+    struct vbus_frame *slot = &queue->slots[idx];
+
+    *slot = *frame;
+    slot->data = &queue->storage[idx * queue->slot_size];
+    if (frame->size > 0) {
+        memcpy(slot->data, frame->data, frame->size);
+    }
+
+    // Publishing the new head orders the slot writes before it
+    atomic_set(&queue->head, (atomic_val_t)(head + 1));
+    return 0;
+}
+
+const struct vbus_frame *vbus_spsc_peek(struct vbus_spsc_queue *queue) {
+    uint32_t tail = (uint32_t)atomic_get(&queue->tail);
+
+    if (tail == queue->head_cache) {
+        queue->head_cache = (uint32_t)atomic_get(&queue->head);
+        if (tail == queue->head_cache) {
+            return NULL;
+        }
+    }
+
+    return &queue->slots[tail & queue->mask];
+}
+
+void vbus_spsc_release(struct vbus_spsc_queue *queue) {
+    uint32_t tail = (uint32_t)atomic_get(&queue->tail);
+
+    __ASSERT(tail != (uint32_t)atomic_get(&queue->head), "Release on empty queue");
+    vbus_trace_consumed(&queue->slots[tail & queue->mask]);
+    atomic_set(&queue->tail, (atomic_val_t)(tail + 1));
+}
+
+uint32_t vbus_spsc_count(const struct vbus_spsc_queue *queue) {
+    return (uint32_t)atomic_get(&queue->head) - (uint32_t)atomic_get(&queue->tail);
+}
+
+void vbus_demux_init(struct vbus_demux *demux) {
+    memset(demux, 0, sizeof(*demux));
+}
+
+int vbus_demux_register(struct vbus_demux *demux, uint8_t channel_idx,
+                        struct vbus_spsc_queue *queue) {
+    if (!demux || !queue) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (demux->queues[channel_idx]) {
+        LOG_ERR("Channel %u already has a queue", channel_idx);
+        return -EALREADY;
+    }
+
+    demux->queues[channel_idx] = queue;
+    return 0;
+}
+
+uint32_t vbus_demux_dispatch(struct vbus_demux *demux, const struct vbus_frame *frames,
+                             uint32_t frame_count) {
+    uint32_t queued = 0;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        struct vbus_spsc_queue *queue = demux->queues[frames[i].channel_idx];
+
+        if (!queue) {
+            demux->unrouted++;
+            continue;
+        }
+
+        if (vbus_spsc_push(queue, &frames[i]) == 0) {
+            vbus_trace_dispatch(&frames[i]);
+            queued++;
+        }
+    }
+
+    return queued;
+}
@@ -0,0 +1,130 @@
+#include <rtio_vbus/frame_pool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "data_frame_priv.h"
+
+LOG_MODULE_REGISTER(vbus_frame_pool, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#define POOL_BLOCK_SIZE CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_POOL_BLOCK_SIZE
+#define POOL_BLOCK_COUNT CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_POOL_BLOCK_COUNT
+
+BUILD_ASSERT(POOL_BLOCK_SIZE % sizeof(void *) == 0,
+             "Frame pool block size must be a multiple of the pointer size");
+BUILD_ASSERT(POOL_BLOCK_SIZE >= sizeof(struct vbus_frame),
+             "Frame pool block cannot hold a single frame");
+
+K_MEM_SLAB_DEFINE_STATIC(vbus_frame_slab, POOL_BLOCK_SIZE, POOL_BLOCK_COUNT, sizeof(void *));
+
+/*
+* Block layout: frame descriptors grow up from the start of the block while
+* payloads are packed down from its end, so a batch is laid out in one pass
+* without knowing the frame count up front.
+*/
+int vbus_frame_decode_batch(struct ring_buf *buffer, uint32_t buf_size,
+                            struct vbus_frame_batch *batch, k_timeout_t timeout) {
+    return vbus_frame_decode_batch_ver(VBUS_FRAME_V1, buffer, buf_size, batch, timeout);
+}
+
+int vbus_frame_decode_batch_ver(enum vbus_frame_version version, struct ring_buf *buffer,
+                                uint32_t buf_size, struct vbus_frame_batch *batch,
+                                k_timeout_t timeout) {
+    if (!buffer || !batch) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    batch->frames = NULL;
+    batch->frame_count = 0;
+    batch->oversized = 0;
+    batch->block = NULL;
+
+    if (buf_size > ring_buf_size_get(buffer)) {
+        LOG_ERR("Requested decode bytes cannot be greater than buffer size");
+        return -ENOTSUP;
+    }
+
+    const struct vbus_frame_format *format = vbus_frame_format_get(version);
+    if (!format) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    uint32_t header_size = format->header_size;
+    if (buf_size < header_size) {
+        return 0;
+    }
+
+    int ret = k_mem_slab_alloc(&vbus_frame_slab, &batch->block, timeout);
+    if (ret) {
+        LOG_ERR("Failed to allocate frame pool block (%d)", ret);
+        batch->block = NULL;
+        return -ENOMEM;
+    }
+
+    struct vbus_frame *frames = batch->block;
+    uint8_t *payload_top = (uint8_t *)batch->block + POOL_BLOCK_SIZE;
+    struct vbus_frame_cursor cursor;
+    struct vbus_frame_pos pos;
+
+    // Claim the whole region once, frames may straddle the wrap point
+    frame_cursor_init(&cursor, version, buffer, buf_size);
+
+    while (frame_cursor_next(&cursor, &pos)) {
+        uint32_t data_size = pos.data_size;
+
+        // It would stay at the head of the ring and fail every later call
+        if (data_size > POOL_BLOCK_SIZE - sizeof(struct vbus_frame)) {
+            LOG_WRN("Frame of %u bytes does not fit into a pool block, dropped", data_size);
+            batch->oversized++;
+            frame_cursor_accept(&cursor, &pos);
+            continue;
+        }
+
+        uint8_t *descriptors_end = (uint8_t *)&frames[batch->frame_count + 1];
+        if (descriptors_end + data_size > payload_top) {
+            break;
+        }
+
+        struct vbus_frame *frame = &frames[batch->frame_count++];
+        format->parse_header(cursor.header, frame);
+        if (data_size > 0) {
+            payload_top -= data_size;
+            ring_span_copy(&cursor.span, pos.data_offset, payload_top, data_size);
+            frame->data = payload_top;
+        } else {
+            frame->data = NULL;
+        }
+
+        frame_cursor_accept(&cursor, &pos);
+    }
+
+    ring_buf_get_finish(buffer, cursor.offset);
+
+    if (batch->frame_count == 0) {
+        vbus_frame_batch_free(batch);
+    } else {
+        batch->frames = frames;
+    }
+
+    return 0;
+}
+
+void vbus_frame_batch_free(struct vbus_frame_batch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    if (batch->block) {
+        k_mem_slab_free(&vbus_frame_slab, batch->block);
+    }
+
+    batch->frames = NULL;
+    batch->frame_count = 0;
+    batch->block = NULL;
+}
+
+uint32_t vbus_frame_pool_num_free(void) {
+    return k_mem_slab_num_free_get(&vbus_frame_slab);
+}
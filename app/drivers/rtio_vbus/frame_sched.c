@@ -0,0 +1,352 @@
+#include <rtio_vbus/frame_sched.h>
+#include <rtio_vbus/sample_codec.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(vbus_frame_sched, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#define ENTRY_HEADER_SIZE sizeof(uint32_t)
+// A first due time this far from now means the source clock jumped
+#define RESYNC_WINDOW_US 1000000U
+
+static inline uint32_t now_us(void) {
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+// Due times wrap after about 71 minutes, compare them by signed distance
+static inline bool time_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static inline bool heap_less(const struct vbus_sched *sched, uint32_t a, uint32_t b) {
+    return time_before(sched->heap[a]->head_due_us, sched->heap[b]->head_due_us);
+}
+
+static inline void heap_swap(struct vbus_sched *sched, uint32_t a, uint32_t b) {
+    struct vbus_sched_channel *tmp = sched->heap[a];
+
+    sched->heap[a] = sched->heap[b];
+    sched->heap[b] = tmp;
+    sched->heap[a]->heap_idx = a;
+    sched->heap[b]->heap_idx = b;
+}
+
+static void heap_sift_up(struct vbus_sched *sched, uint32_t idx) {
+    while (idx > 0) {
+        uint32_t parent = (idx - 1) / 2;
+
+        if (!heap_less(sched, idx, parent)) {
+            break;
+        }
+        heap_swap(sched, idx, parent);
+        idx = parent;
+    }
+}
+
+static void heap_sift_down(struct vbus_sched *sched, uint32_t idx) {
+    while (true) {
+        uint32_t smallest = idx;
+        uint32_t left = 2 * idx + 1;
+        uint32_t right = left + 1;
+
+        if (left < sched->heap_size && heap_less(sched, left, smallest)) {
+            smallest = left;
+        }
+        if (right < sched->heap_size && heap_less(sched, right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == idx) {
+            break;
+        }
+        heap_swap(sched, idx, smallest);
+        idx = smallest;
+    }
+}
+
+static void heap_insert(struct vbus_sched *sched, struct vbus_sched_channel *channel) {
+    uint32_t idx = sched->heap_size++;
+
+    sched->heap[idx] = channel;
+    channel->heap_idx = idx;
+    heap_sift_up(sched, idx);
+}
+
+static void heap_remove_top(struct vbus_sched *sched) {
+    sched->heap[0]->heap_idx = -1;
+    sched->heap_size--;
+    if (sched->heap_size > 0) {
+        sched->heap[0] = sched->heap[sched->heap_size];
+        sched->heap[0]->heap_idx = 0;
+        heap_sift_down(sched, 0);
+    }
+}
+
+// Called with the lock held
+static void arm_timer(struct vbus_sched *sched) {
+    if (sched->heap_size == 0) {
+        k_timer_stop(&sched->timer);
+        return;
+    }
+
+    int32_t delay = (int32_t)(sched->heap[0]->head_due_us - now_us());
+
+    // K_USEC() rounds up to whole ticks, so samples are never released early
+    k_timer_start(&sched->timer, delay > 0 ? K_USEC(delay) : K_NO_WAIT, K_NO_WAIT);
+}
+
+static void record_release(struct vbus_sched *sched, struct vbus_sched_channel *channel,
+                           uint32_t due, uint32_t now) {
+    struct vbus_sched_metrics *metrics = &channel->metrics;
+    uint32_t lateness = time_before(now, due) ? 0 : now - due;
+
+    metrics->released++;
+    metrics->lateness_sum_us += lateness;
+    metrics->lateness_max_us = MAX(metrics->lateness_max_us, lateness);
+    if (lateness > sched->late_threshold_us) {
+        metrics->late++;
+    }
+
+    if (channel->has_prev) {
+        int32_t intended = (int32_t)(due - channel->prev_due_us);
+        int32_t actual = (int32_t)(now - channel->prev_release_us);
+        uint32_t jitter = actual > intended ? actual - intended : intended - actual;
+
+        metrics->jitter_sum_us += jitter;
+        metrics->jitter_max_us = MAX(metrics->jitter_max_us, jitter);
+    }
+
+    channel->has_prev = true;
+    channel->prev_due_us = due;
+    channel->prev_release_us = now;
+}
+
+static void sched_expiry(struct k_timer *timer) {
+    struct vbus_sched *sched = CONTAINER_OF(timer, struct vbus_sched, timer);
+    uint8_t entry[VBUS_SCHED_ENTRY_SIZE(VBUS_SCHED_MAX_SAMPLE_SIZE)];
+    k_spinlock_key_t key = k_spin_lock(&sched->lock);
+
+    while (sched->heap_size > 0) {
+        struct vbus_sched_channel *channel = sched->heap[0];
+        uint32_t now = now_us();
+        uint32_t due = channel->head_due_us;
+
+        if (time_before(now, due)) {
+            break;
+        }
+
+        ring_buf_get(&channel->ring, entry, VBUS_SCHED_ENTRY_SIZE(channel->sample_size));
+        record_release(sched, channel, due, now);
+
+        uint8_t next_due[ENTRY_HEADER_SIZE];
+        if (ring_buf_peek(&channel->ring, next_due, sizeof(next_due)) == sizeof(next_due)) {
+            memcpy(&channel->head_due_us, next_due, sizeof(next_due));
+            heap_sift_down(sched, 0);
+        } else {
+            heap_remove_top(sched);
+        }
+
+        // Pushes may come in while the sample is handed out
+        k_spin_unlock(&sched->lock, key);
+        channel->release(channel, entry + ENTRY_HEADER_SIZE, due, channel->user_data);
+        key = k_spin_lock(&sched->lock);
+    }
+
+    arm_timer(sched);
+    k_spin_unlock(&sched->lock, key);
+}
+
+void vbus_sched_init(struct vbus_sched *sched, uint32_t playout_delay_us,
+                     uint32_t late_threshold_us) {
+    memset(sched, 0, sizeof(*sched));
+    k_timer_init(&sched->timer, sched_expiry, NULL);
+    sched->playout_delay_us = playout_delay_us;
+    sched->late_threshold_us = late_threshold_us;
+}
+
+int vbus_sched_channel_init(struct vbus_sched_channel *channel, uint8_t channel_idx,
+                            uint16_t sample_size, uint32_t period_us, uint8_t *buf,
+                            uint32_t buf_size, vbus_sched_release_t release, void *user_data) {
+    if (!channel || !buf || !release || sample_size == 0 ||
+        sample_size > VBUS_SCHED_MAX_SAMPLE_SIZE ||
+        buf_size < VBUS_SCHED_ENTRY_SIZE(sample_size)) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    memset(channel, 0, sizeof(*channel));
+    channel->channel_idx = channel_idx;
+    channel->sample_size = sample_size;
+    channel->period_us = period_us;
+    channel->release = release;
+    channel->user_data = user_data;
+    channel->heap_idx = -1;
+    ring_buf_init(&channel->ring, buf_size, buf);
+    return 0;
+}
+
+int vbus_sched_attach(struct vbus_sched *sched, struct vbus_sched_channel *channel) {
+    if (!sched || !channel) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    int ret = 0;
+    k_spinlock_key_t key = k_spin_lock(&sched->lock);
+
+    for (uint32_t i = 0; i < sched->channel_count; i++) {
+        if (sched->channels[i]->channel_idx == channel->channel_idx) {
+            ret = -EALREADY;
+            break;
+        }
+    }
+
+    if (ret == 0 && sched->channel_count == VBUS_SCHED_MAX_CHANNELS) {
+        ret = -ENOMEM;
+    }
+
+    if (ret == 0) {
+        sched->channels[sched->channel_count++] = channel;
+    }
+
+    k_spin_unlock(&sched->lock, key);
+    if (ret) {
+        LOG_ERR("Cannot attach channel %u (%d)", channel->channel_idx, ret);
+    }
+    return ret;
+}
+
+static struct vbus_sched_channel *find_channel(struct vbus_sched *sched, uint8_t channel_idx) {
+    for (uint32_t i = 0; i < sched->channel_count; i++) {
+        if (sched->channels[i]->channel_idx == channel_idx) {
+            return sched->channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+* Due time of the first sample of a frame. A channel that ran dry is
+* anchored again, so a pause in the stream does not turn into a burst of
+* late samples once data flows again.
+*/
+static uint32_t first_due(struct vbus_sched *sched, struct vbus_sched_channel *channel,
+                          const struct vbus_frame *frame, uint32_t now) {
+    bool idle = channel->heap_idx < 0;
+    uint32_t start = now + sched->playout_delay_us;
+
+    if (channel->period_us > 0) {
+        uint32_t due = channel->last_due_us + channel->period_us;
+
+        if (!channel->anchored || (idle && time_before(due, now))) {
+            channel->anchored = true;
+            due = start;
+        }
+        return due;
+    }
+
+    uint32_t due = frame->timestamp_us + channel->ts_offset_us;
+
+    if (!channel->anchored ||
+        (idle && (time_before(due, now - RESYNC_WINDOW_US) ||
+                  time_before(start + RESYNC_WINDOW_US, due)))) {
+        channel->anchored = true;
+        channel->ts_offset_us = start - frame->timestamp_us;
+        due = start;
+    }
+    return due;
+}
+
+int vbus_sched_push(struct vbus_sched *sched, const struct vbus_frame *frame) {
+    if (!sched || !frame || (frame->size > 0 && !frame->data)) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if ((frame->flags & VBUS_FRAME_FLAG_CODEC_MASK) != VBUS_FRAME_CODEC_RAW) {
+        LOG_ERR("Compressed frame on channel %u, expand it first", frame->channel_idx);
+        return -ENOTSUP;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&sched->lock);
+    struct vbus_sched_channel *channel = find_channel(sched, frame->channel_idx);
+    int ret = 0;
+
+    if (!channel) {
+        ret = -ENOENT;
+    } else if (frame->size % channel->sample_size != 0 ||
+               (channel->period_us == 0 && frame->sample_delta_us == 0)) {
+        ret = -EINVAL;
+    }
+
+    if (ret) {
+        k_spin_unlock(&sched->lock, key);
+        LOG_DBG("Frame on channel %u not scheduled (%d)", frame->channel_idx, ret);
+        return ret;
+    }
+
+    uint32_t sample_count = frame->size / channel->sample_size;
+    uint32_t step = channel->period_us > 0 ? channel->period_us : frame->sample_delta_us;
+    uint32_t entry_size = VBUS_SCHED_ENTRY_SIZE(channel->sample_size);
+    uint32_t due = sample_count > 0 ? first_due(sched, channel, frame, now_us()) : 0;
+    uint32_t queued = 0;
+
+    for (; queued < sample_count; queued++, due += step) {
+        if (ring_buf_space_get(&channel->ring) < entry_size) {
+            channel->metrics.overruns += sample_count - queued;
+            break;
+        }
+
+        ring_buf_put(&channel->ring, (const uint8_t *)&due, ENTRY_HEADER_SIZE);
+        ring_buf_put(&channel->ring, frame->data + queued * channel->sample_size,
+                     channel->sample_size);
+        channel->last_due_us = due;
+    }
+
+    if (queued > 0 && channel->heap_idx < 0) {
+        uint8_t head_due[ENTRY_HEADER_SIZE];
+
+        ring_buf_peek(&channel->ring, head_due, sizeof(head_due));
+        memcpy(&channel->head_due_us, head_due, sizeof(head_due));
+        heap_insert(sched, channel);
+
+        // Only a new heap top needs an earlier expiry
+        if (channel->heap_idx == 0) {
+            arm_timer(sched);
+        }
+    }
+
+    k_spin_unlock(&sched->lock, key);
+
+    if (queued > 0) {
+        vbus_trace_dispatch(frame);
+    }
+    return (int)queued;
+}
+
+void vbus_sched_reset(struct vbus_sched *sched) {
+    k_spinlock_key_t key = k_spin_lock(&sched->lock);
+
+    for (uint32_t i = 0; i < sched->channel_count; i++) {
+        struct vbus_sched_channel *channel = sched->channels[i];
+
+        ring_buf_reset(&channel->ring);
+        channel->heap_idx = -1;
+        channel->anchored = false;
+        channel->has_prev = false;
+    }
+
+    sched->heap_size = 0;
+    k_timer_stop(&sched->timer);
+    k_spin_unlock(&sched->lock, key);
+}
+
+void vbus_sched_metrics_get(struct vbus_sched *sched, const struct vbus_sched_channel *channel,
+                            struct vbus_sched_metrics *metrics) {
+    k_spinlock_key_t key = k_spin_lock(&sched->lock);
+
+    *metrics = channel->metrics;
+    k_spin_unlock(&sched->lock, key);
+}
@@ -0,0 +1,311 @@
+#include <rtio_vbus/sample_codec.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(vbus_sample_codec, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+// A 32 bit zigzag value takes at most 5 varint bytes
+#define VARINT_MAX_SIZE 5
+
+/*
+* Turns samples into zigzag deltas and back, one channel lane at a time.
+*/
+struct delta_state {
+    uint32_t sample_size;
+    uint32_t lanes;
+    uint32_t lane;
+    uint32_t previous[VBUS_SAMPLE_MAX_LANES];
+};
+
+static inline uint32_t flags_sample_size(uint8_t flags) {
+    return (flags & VBUS_FRAME_FLAG_SAMPLE_32) ? 4 : 2;
+}
+
+static inline uint32_t flags_lanes(uint8_t flags) {
+    return (flags >> VBUS_FRAME_FLAG_LANES_SHIFT) + 1;
+}
+
+static void delta_state_init(struct delta_state *state, uint8_t flags) {
+    memset(state, 0, sizeof(*state));
+    state->sample_size = flags_sample_size(flags);
+    state->lanes = flags_lanes(flags);
+}
+
+static inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/*
+* The difference is wrapped to the sample width and sign extended, so small
+* steps in either direction give small zigzag values.
+*/
+static inline uint32_t delta_encode(struct delta_state *state, const uint8_t *src) {
+    uint32_t current = state->sample_size == 4 ? sys_get_be32(src) : sys_get_be16(src);
+    uint32_t delta = current - state->previous[state->lane];
+    int32_t signed_delta = state->sample_size == 4 ? (int32_t)delta : (int32_t)(int16_t)delta;
+
+    state->previous[state->lane] = current;
+    state->lane = state->lane + 1 == state->lanes ? 0 : state->lane + 1;
+    return zigzag(signed_delta);
+}
+
+static inline void delta_decode(struct delta_state *state, uint32_t value, uint8_t *dst) {
+    uint32_t current = state->previous[state->lane] + (uint32_t)unzigzag(value);
+
+    if (state->sample_size == 4) {
+        sys_put_be32(current, dst);
+    } else {
+        sys_put_be16((uint16_t)current, dst);
+    }
+
+    state->previous[state->lane] = current;
+    state->lane = state->lane + 1 == state->lanes ? 0 : state->lane + 1;
+}
+
+/*
+* Byte sink that only counts when there is no output buffer.
+*/
+struct byte_writer {
+    uint8_t *out;
+    uint32_t capacity;
+    uint32_t size;
+};
+
+static inline int write_byte(struct byte_writer *writer, uint8_t byte) {
+    if (writer->out) {
+        if (writer->size >= writer->capacity) {
+            LOG_DBG("Sample encode buffer too small (capacity=%u)", writer->capacity);
+            return -ENOBUFS;
+        }
+        writer->out[writer->size] = byte;
+    }
+
+    writer->size++;
+    return 0;
+}
+
+static int encode_varint(struct delta_state *state, const uint8_t *samples,
+                         uint32_t value_count, struct byte_writer *writer) {
+    for (uint32_t i = 0; i < value_count; i++) {
+        uint32_t value = delta_encode(state, &samples[i * state->sample_size]);
+
+        do {
+            uint8_t byte = value & 0x7F;
+
+            value >>= 7;
+            if (write_byte(writer, value ? byte | 0x80 : byte)) {
+                return -ENOBUFS;
+            }
+        } while (value);
+    }
+
+    return 0;
+}
+
+static int encode_bitpack(struct delta_state *state, const uint8_t *samples,
+                          uint32_t value_count, struct byte_writer *writer) {
+    uint32_t block[VBUS_SAMPLE_BITPACK_BLOCK];
+
+    for (uint32_t start = 0; start < value_count; start += VBUS_SAMPLE_BITPACK_BLOCK) {
+        uint32_t n = MIN(VBUS_SAMPLE_BITPACK_BLOCK, value_count - start);
+        uint32_t used = 0;
+
+        for (uint32_t k = 0; k < n; k++) {
+            block[k] = delta_encode(state, &samples[(start + k) * state->sample_size]);
+            used |= block[k];
+        }
+
+        uint32_t width = used ? 32 - __builtin_clz(used) : 0;
+        uint64_t acc = 0;
+        uint32_t bits = 0;
+
+        if (write_byte(writer, (uint8_t)width)) {
+            return -ENOBUFS;
+        }
+
+        for (uint32_t k = 0; k < n; k++) {
+            acc |= (uint64_t)block[k] << bits;
+            bits += width;
+            while (bits >= 8) {
+                if (write_byte(writer, (uint8_t)acc)) {
+                    return -ENOBUFS;
+                }
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+
+        if (bits > 0 && write_byte(writer, (uint8_t)acc)) {
+            return -ENOBUFS;
+        }
+    }
+
+    return 0;
+}
+
+int vbus_sample_encode(const uint8_t *samples, uint32_t sample_count, uint8_t flags,
+                       uint8_t *out, uint32_t capacity, uint32_t *out_size) {
+    if ((!samples && sample_count > 0) || !out_size) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    struct delta_state state;
+    struct byte_writer writer = {.out = out, .capacity = capacity, .size = 0};
+    int ret;
+
+    delta_state_init(&state, flags);
+    uint32_t value_count = sample_count * state.lanes;
+
+    switch (flags & VBUS_FRAME_FLAG_CODEC_MASK) {
+    case VBUS_FRAME_CODEC_DELTA_VARINT:
+        ret = encode_varint(&state, samples, value_count, &writer);
+        break;
+    case VBUS_FRAME_CODEC_DELTA_BITPACK:
+        ret = encode_bitpack(&state, samples, value_count, &writer);
+        break;
+    default:
+        LOG_ERR("Unsupported sample codec flags 0x%02x", flags);
+        return -EINVAL;
+    }
+
+    if (ret) {
+        return ret;
+    }
+
+    *out_size = writer.size;
+    return 0;
+}
+
+int vbus_frame_expanded_size(const struct vbus_frame *frame) {
+    switch (frame->flags & VBUS_FRAME_FLAG_CODEC_MASK) {
+    case VBUS_FRAME_CODEC_RAW:
+        return (int)frame->size;
+    case VBUS_FRAME_CODEC_DELTA_VARINT:
+    case VBUS_FRAME_CODEC_DELTA_BITPACK:
+        return (int)(frame->sample_count * flags_lanes(frame->flags) *
+                     flags_sample_size(frame->flags));
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static int expand_varint(struct delta_state *state, const struct vbus_frame *frame,
+                         uint32_t value_count, uint8_t *out) {
+    const uint8_t *in = frame->data;
+    uint32_t pos = 0;
+
+    for (uint32_t i = 0; i < value_count; i++) {
+        uint32_t value;
+
+        // Slowly changing channels mostly produce single byte varints
+        if (pos < frame->size && in[pos] < 0x80) {
+            value = in[pos++];
+        } else {
+            uint32_t shift = 0;
+            uint8_t byte;
+
+            value = 0;
+            do {
+                if (pos == frame->size || shift >= 7 * VARINT_MAX_SIZE) {
+                    return -EBADMSG;
+                }
+                byte = in[pos++];
+                value |= (uint32_t)(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+        }
+
+        delta_decode(state, value, &out[i * state->sample_size]);
+    }
+
+    return pos == frame->size ? 0 : -EBADMSG;
+}
+
+static int expand_bitpack(struct delta_state *state, const struct vbus_frame *frame,
+                          uint32_t value_count, uint8_t *out) {
+    const uint8_t *in = frame->data;
+    uint32_t pos = 0;
+
+    for (uint32_t start = 0; start < value_count; start += VBUS_SAMPLE_BITPACK_BLOCK) {
+        uint32_t n = MIN(VBUS_SAMPLE_BITPACK_BLOCK, value_count - start);
+
+        if (pos == frame->size) {
+            return -EBADMSG;
+        }
+
+        uint32_t width = in[pos++];
+        if (width > 32 || frame->size - pos < DIV_ROUND_UP(n * width, 8)) {
+            return -EBADMSG;
+        }
+
+        uint64_t mask = (1ULL << width) - 1;
+        uint64_t acc = 0;
+        uint32_t bits = 0;
+
+        // The block length was checked up front, no bounds checks per value
+        for (uint32_t k = 0; k < n; k++) {
+            while (bits < width) {
+                acc |= (uint64_t)in[pos++] << bits;
+                bits += 8;
+            }
+            delta_decode(state, (uint32_t)(acc & mask), &out[(start + k) * state->sample_size]);
+            acc >>= width;
+            bits -= width;
+        }
+    }
+
+    return pos == frame->size ? 0 : -EBADMSG;
+}
+
+int vbus_frame_expand(const struct vbus_frame *frame, uint8_t *out, uint32_t capacity) {
+    if (!frame || (!out && capacity > 0)) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    int size = vbus_frame_expanded_size(frame);
+    if (size < 0) {
+        LOG_ERR("Unsupported payload codec flags 0x%02x", frame->flags);
+        return size;
+    }
+
+    if ((uint32_t)size > capacity) {
+        LOG_DBG("Expand buffer too small (required=%d, capacity=%u)", size, capacity);
+        return -ENOBUFS;
+    }
+
+    struct delta_state state;
+    int ret;
+
+    delta_state_init(&state, frame->flags);
+    uint32_t value_count = frame->sample_count * state.lanes;
+
+    switch (frame->flags & VBUS_FRAME_FLAG_CODEC_MASK) {
+    case VBUS_FRAME_CODEC_DELTA_VARINT:
+        ret = expand_varint(&state, frame, value_count, out);
+        break;
+    case VBUS_FRAME_CODEC_DELTA_BITPACK:
+        ret = expand_bitpack(&state, frame, value_count, out);
+        break;
+    default:
+        if (size > 0) {
+            memcpy(out, frame->data, size);
+        }
+        return size;
+    }
+
+    if (ret) {
+        LOG_ERR("Malformed compressed payload on channel %u", frame->channel_idx);
+        return ret;
+    }
+
+    return size;
+}
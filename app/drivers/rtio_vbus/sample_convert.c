@@ -0,0 +1,213 @@
+#include <rtio_vbus/sample_convert.h>
+#include "sample_convert_priv.h"
+
+static void convert_scalar_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    scalar_s16_to_q31(src, dst, count);
+}
+
+static void convert_scalar_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    scalar_s32_to_q31(src, dst, count);
+}
+
+static void convert_scalar_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    scalar_f32_to_q31(src, dst, count);
+}
+
+static void convert_scalar_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                      float scale) {
+    scalar_s16_to_f32(src, dst, count, scale);
+}
+
+static void convert_scalar_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                      float scale) {
+    scalar_s32_to_f32(src, dst, count, scale);
+}
+
+static void convert_scalar_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    scalar_f32_to_f32(src, dst, count);
+}
+
+static const struct vbus_convert_ops convert_ops_scalar = {
+    .name = "scalar",
+    .s16_to_q31 = convert_scalar_s16_to_q31,
+    .s32_to_q31 = convert_scalar_s32_to_q31,
+    .f32_to_q31 = convert_scalar_f32_to_q31,
+    .s16_to_f32 = convert_scalar_s16_to_f32,
+    .s32_to_f32 = convert_scalar_s32_to_f32,
+    .f32_to_f32 = convert_scalar_f32_to_f32,
+};
+
+/*
+* SWAR kernels load 8 bytes at once and swap the bytes of all samples in
+* the word with masks and shifts. The lane arithmetic below assumes the
+* first sample sits in the low bits of the loaded word.
+*/
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+#define SWAR_MASK_8 0x00FF00FF00FF00FFULL
+#define SWAR_MASK_16 0x0000FFFF0000FFFFULL
+
+static inline uint64_t swar_load(const uint8_t *src) {
+    uint64_t word;
+
+    memcpy(&word, src, sizeof(word));
+    return word;
+}
+
+static inline uint64_t swar_swap16(uint64_t word) {
+    return ((word & SWAR_MASK_8) << 8) | ((word >> 8) & SWAR_MASK_8);
+}
+
+static inline uint64_t swar_swap32(uint64_t word) {
+    word = swar_swap16(word);
+    return ((word & SWAR_MASK_16) << 16) | ((word >> 16) & SWAR_MASK_16);
+}
+
+static void convert_swar_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint64_t word = swar_swap16(swar_load(&src[2 * i]));
+
+        dst[i] = (int32_t)((uint32_t)word << 16);
+        dst[i + 1] = (int32_t)((uint32_t)(word >> 16) << 16);
+        dst[i + 2] = (int32_t)((uint32_t)(word >> 32) << 16);
+        dst[i + 3] = (int32_t)((uint32_t)(word >> 48) << 16);
+    }
+
+    scalar_s16_to_q31(&src[2 * i], &dst[i], count - i);
+}
+
+static void convert_swar_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        uint64_t word = swar_swap32(swar_load(&src[4 * i]));
+
+        dst[i] = (int32_t)(uint32_t)word;
+        dst[i + 1] = (int32_t)(uint32_t)(word >> 32);
+    }
+
+    scalar_s32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_swar_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        uint64_t word = swar_swap32(swar_load(&src[4 * i]));
+
+        dst[i] = float_to_q31(float_from_bits((uint32_t)word));
+        dst[i + 1] = float_to_q31(float_from_bits((uint32_t)(word >> 32)));
+    }
+
+    scalar_f32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_swar_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint64_t word = swar_swap16(swar_load(&src[2 * i]));
+
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            float value = (float)(int16_t)(word >> (16 * lane));
+
+            dst[i + lane] = value * scale;
+        }
+    }
+
+    scalar_s16_to_f32(&src[2 * i], &dst[i], count - i, scale);
+}
+
+static void convert_swar_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        uint64_t word = swar_swap32(swar_load(&src[4 * i]));
+        float first = (float)(int32_t)(uint32_t)word;
+        float second = (float)(int32_t)(uint32_t)(word >> 32);
+
+        dst[i] = first * scale;
+        dst[i + 1] = second * scale;
+    }
+
+    scalar_s32_to_f32(&src[4 * i], &dst[i], count - i, scale);
+}
+
+static void convert_swar_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        uint64_t word = swar_swap32(swar_load(&src[4 * i]));
+
+        memcpy(&dst[i], &word, sizeof(word));
+    }
+
+    scalar_f32_to_f32(&src[4 * i], &dst[i], count - i);
+}
+
+static const struct vbus_convert_ops convert_ops_swar = {
+    .name = "swar",
+    .s16_to_q31 = convert_swar_s16_to_q31,
+    .s32_to_q31 = convert_swar_s32_to_q31,
+    .f32_to_q31 = convert_swar_f32_to_q31,
+    .s16_to_f32 = convert_swar_s16_to_f32,
+    .s32_to_f32 = convert_swar_s32_to_f32,
+    .f32_to_f32 = convert_swar_f32_to_f32,
+};
+
+#define CONVERT_HAVE_SWAR 1
+
+#endif
+
+#if defined(CONVERT_HAVE_SIMD)
+#define CONVERT_OPS_BEST vbus_convert_ops_simd
+#elif defined(CONVERT_HAVE_SWAR)
+#define CONVERT_OPS_BEST convert_ops_swar
+#else
+#define CONVERT_OPS_BEST convert_ops_scalar
+#endif
+
+const struct vbus_convert_ops *vbus_convert_ops_get(enum vbus_convert_impl impl) {
+    switch (impl) {
+    case VBUS_CONVERT_SCALAR:
+        return &convert_ops_scalar;
+#ifdef CONVERT_HAVE_SWAR
+    case VBUS_CONVERT_SWAR:
+        return &convert_ops_swar;
+#endif
+#ifdef CONVERT_HAVE_SIMD
+    case VBUS_CONVERT_SIMD:
+        return &vbus_convert_ops_simd;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+void vbus_convert_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    CONVERT_OPS_BEST.s16_to_q31(src, dst, count);
+}
+
+void vbus_convert_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    CONVERT_OPS_BEST.s32_to_q31(src, dst, count);
+}
+
+void vbus_convert_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    CONVERT_OPS_BEST.f32_to_q31(src, dst, count);
+}
+
+void vbus_convert_s16_to_f32(const uint8_t *src, float *dst, uint32_t count, float scale) {
+    CONVERT_OPS_BEST.s16_to_f32(src, dst, count, scale);
+}
+
+void vbus_convert_s32_to_f32(const uint8_t *src, float *dst, uint32_t count, float scale) {
+    CONVERT_OPS_BEST.s32_to_f32(src, dst, count, scale);
+}
+
+void vbus_convert_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    CONVERT_OPS_BEST.f32_to_f32(src, dst, count);
+}
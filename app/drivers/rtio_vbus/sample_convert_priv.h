@@ -0,0 +1,115 @@
+#ifndef ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CONVERT_PRIV_H
+#define ZEPHYR_DRIVER_VRTIO_BUS_SAMPLE_CONVERT_PRIV_H
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <rtio_vbus/sample_convert.h>
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_CONVERT_SIMD
+#if defined(__ARM_FEATURE_MVE)
+#define CONVERT_SIMD_MVE 1
+// Integer only Helium has no float vectors
+#if (__ARM_FEATURE_MVE & 2)
+#define CONVERT_SIMD_MVE_FLOAT 1
+#endif
+#elif defined(__SSE2__)
+#define CONVERT_SIMD_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define CONVERT_SIMD_NEON 1
+#endif
+#endif
+
+#if defined(CONVERT_SIMD_MVE) || defined(CONVERT_SIMD_SSE2) || defined(CONVERT_SIMD_NEON)
+#define CONVERT_HAVE_SIMD 1
+extern const struct vbus_convert_ops vbus_convert_ops_simd;
+#endif
+
+#define Q31_SCALE 2147483648.0f
+
+static inline float float_from_bits(uint32_t bits) {
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+* value * 2^31 rounded to nearest even without depending on the FPU
+* rounding mode. Scaling by a power of two is exact, so is taking the
+* fraction of a float.
+*/
+static inline int32_t float_to_q31(float value) {
+    float scaled = value * Q31_SCALE;
+
+    if (scaled != scaled) {
+        return 0;
+    }
+    if (scaled >= Q31_SCALE) {
+        return INT32_MAX;
+    }
+    if (scaled <= -Q31_SCALE) {
+        return INT32_MIN;
+    }
+
+    int32_t whole = (int32_t)scaled;
+    float frac = scaled - (float)whole;
+
+    if (frac > 0.5f || (frac == 0.5f && (whole & 1))) {
+        whole++;
+    } else if (frac < -0.5f || (frac == -0.5f && (whole & 1))) {
+        whole--;
+    }
+
+    return whole;
+}
+
+/*
+* Scalar kernels, also used for the tails of the wider implementations.
+*/
+static inline void scalar_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)((uint32_t)sys_get_be16(&src[2 * i]) << 16);
+    }
+}
+
+static inline void scalar_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)sys_get_be32(&src[4 * i]);
+    }
+}
+
+static inline void scalar_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = float_to_q31(float_from_bits(sys_get_be32(&src[4 * i])));
+    }
+}
+
+static inline void scalar_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                     float scale) {
+    for (uint32_t i = 0; i < count; i++) {
+        float value = (float)(int16_t)sys_get_be16(&src[2 * i]);
+
+        dst[i] = value * scale;
+    }
+}
+
+static inline void scalar_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                     float scale) {
+    for (uint32_t i = 0; i < count; i++) {
+        float value = (float)(int32_t)sys_get_be32(&src[4 * i]);
+
+        dst[i] = value * scale;
+    }
+}
+
+// Copies bits, a float load and store could quiet signaling NaNs
+static inline void scalar_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t bits = sys_get_be32(&src[4 * i]);
+
+        memcpy(&dst[i], &bits, sizeof(bits));
+    }
+}
+
+#endif
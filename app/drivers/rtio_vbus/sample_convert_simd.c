@@ -0,0 +1,326 @@
+#include <rtio_vbus/sample_convert.h>
+#include "sample_convert_priv.h"
+
+/*
+* Vector kernels handle 16 source bytes per step and leave the tail to the
+* scalar kernels. Rounding and saturation follow the scalar reference,
+* see float_to_q31().
+*/
+#if defined(CONVERT_SIMD_SSE2)
+
+#include <emmintrin.h>
+
+static inline __m128i load_bytes(const uint8_t *src) {
+    return _mm_loadu_si128((const __m128i *)src);
+}
+
+// SSE2 has no byte shuffle, swap with shifts
+static inline __m128i swap16(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static inline __m128i swap32(__m128i v) {
+    v = swap16(v);
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+}
+
+static void convert_simd_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = swap16(load_bytes(&src[2 * i]));
+
+        // Zero in the low half of every 32 bit lane is the shift by 16
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi16(zero, v));
+        _mm_storeu_si128((__m128i *)&dst[i + 4], _mm_unpackhi_epi16(zero, v));
+    }
+
+    scalar_s16_to_q31(&src[2 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)&dst[i], swap32(load_bytes(&src[4 * i])));
+    }
+
+    scalar_s32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_simd_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    const __m128 limit = _mm_set1_ps(Q31_SCALE);
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(swap32(load_bytes(&src[4 * i]))), limit);
+        // Out of range and NaN lanes convert to INT32_MIN
+        __m128i q31 = _mm_cvtps_epi32(scaled);
+        __m128i too_large = _mm_castps_si128(_mm_cmpge_ps(scaled, limit));
+        __m128i is_number = _mm_castps_si128(_mm_cmpord_ps(scaled, scaled));
+
+        q31 = _mm_and_si128(_mm_xor_si128(q31, too_large), is_number);
+        _mm_storeu_si128((__m128i *)&dst[i], q31);
+    }
+
+    scalar_f32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = swap16(load_bytes(&src[2 * i]));
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 16);
+
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+    }
+
+    scalar_s16_to_f32(&src[2 * i], &dst[i], count - i, scale);
+}
+
+static void convert_simd_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    const __m128 factor = _mm_set1_ps(scale);
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_cvtepi32_ps(swap32(load_bytes(&src[4 * i])));
+
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(value, factor));
+    }
+
+    scalar_s32_to_f32(&src[4 * i], &dst[i], count - i, scale);
+}
+
+static void convert_simd_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)&dst[i], swap32(load_bytes(&src[4 * i])));
+    }
+
+    scalar_f32_to_f32(&src[4 * i], &dst[i], count - i);
+}
+
+const struct vbus_convert_ops vbus_convert_ops_simd = {
+    .name = "sse2",
+    .s16_to_q31 = convert_simd_s16_to_q31,
+    .s32_to_q31 = convert_simd_s32_to_q31,
+    .f32_to_q31 = convert_simd_f32_to_q31,
+    .s16_to_f32 = convert_simd_s16_to_f32,
+    .s32_to_f32 = convert_simd_s32_to_f32,
+    .f32_to_f32 = convert_simd_f32_to_f32,
+};
+
+#elif defined(CONVERT_SIMD_NEON)
+
+#include <arm_neon.h>
+
+static void convert_simd_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(&src[2 * i])));
+
+        vst1q_s32(&dst[i], vshll_n_s16(vget_low_s16(v), 16));
+        vst1q_s32(&dst[i + 4], vshll_n_s16(vget_high_s16(v), 16));
+    }
+
+    scalar_s16_to_q31(&src[2 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_s32(&dst[i], vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(&src[4 * i]))));
+    }
+
+    scalar_s32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_simd_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t value = vreinterpretq_f32_u8(vrev32q_u8(vld1q_u8(&src[4 * i])));
+
+        // Rounds to nearest even, saturates and turns NaN into 0
+        vst1q_s32(&dst[i], vcvtnq_s32_f32(vmulq_n_f32(value, Q31_SCALE)));
+    }
+
+    scalar_f32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(&src[2 * i])));
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+
+        vst1q_f32(&dst[i], vmulq_n_f32(low, scale));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(high, scale));
+    }
+
+    scalar_s16_to_f32(&src[2 * i], &dst[i], count - i, scale);
+}
+
+static void convert_simd_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t v = vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(&src[4 * i])));
+
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(v), scale));
+    }
+
+    scalar_s32_to_f32(&src[4 * i], &dst[i], count - i, scale);
+}
+
+static void convert_simd_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8((uint8_t *)&dst[i], vrev32q_u8(vld1q_u8(&src[4 * i])));
+    }
+
+    scalar_f32_to_f32(&src[4 * i], &dst[i], count - i);
+}
+
+const struct vbus_convert_ops vbus_convert_ops_simd = {
+    .name = "neon",
+    .s16_to_q31 = convert_simd_s16_to_q31,
+    .s32_to_q31 = convert_simd_s32_to_q31,
+    .f32_to_q31 = convert_simd_f32_to_q31,
+    .s16_to_f32 = convert_simd_s16_to_f32,
+    .s32_to_f32 = convert_simd_s32_to_f32,
+    .f32_to_f32 = convert_simd_f32_to_f32,
+};
+
+#elif defined(CONVERT_SIMD_MVE)
+
+#include <arm_mve.h>
+
+/*
+* Byte loads keep unaligned payloads legal. Widening works on the even
+* (bottom) and odd (top) halfwords, the interleaving store puts them back
+* in order.
+*/
+static void convert_simd_s16_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(&src[2 * i])));
+        int32x4x2_t q31 = {{
+            vshlq_n_s32(vmovlbq_s16(v), 16),
+            vshlq_n_s32(vmovltq_s16(v), 16),
+        }};
+
+        vst2q_s32(&dst[i], q31);
+    }
+
+    scalar_s16_to_q31(&src[2 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_s32(&dst[i], vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(&src[4 * i]))));
+    }
+
+    scalar_s32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+#ifdef CONVERT_SIMD_MVE_FLOAT
+static void convert_simd_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t value = vreinterpretq_f32_u8(vrev32q_u8(vld1q_u8(&src[4 * i])));
+
+        // Rounds to nearest even, saturates and turns NaN into 0
+        vst1q_s32(&dst[i], vcvtnq_s32_f32(vmulq_n_f32(value, Q31_SCALE)));
+    }
+
+    scalar_f32_to_q31(&src[4 * i], &dst[i], count - i);
+}
+
+static void convert_simd_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(&src[2 * i])));
+        float32x4x2_t value = {{
+            vmulq_n_f32(vcvtq_f32_s32(vmovlbq_s16(v)), scale),
+            vmulq_n_f32(vcvtq_f32_s32(vmovltq_s16(v)), scale),
+        }};
+
+        vst2q_f32(&dst[i], value);
+    }
+
+    scalar_s16_to_f32(&src[2 * i], &dst[i], count - i, scale);
+}
+
+static void convert_simd_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t v = vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(&src[4 * i])));
+
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(v), scale));
+    }
+
+    scalar_s32_to_f32(&src[4 * i], &dst[i], count - i, scale);
+}
+#else
+static void convert_simd_f32_to_q31(const uint8_t *src, int32_t *dst, uint32_t count) {
+    scalar_f32_to_q31(src, dst, count);
+}
+
+static void convert_simd_s16_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    scalar_s16_to_f32(src, dst, count, scale);
+}
+
+static void convert_simd_s32_to_f32(const uint8_t *src, float *dst, uint32_t count,
+                                    float scale) {
+    scalar_s32_to_f32(src, dst, count, scale);
+}
+#endif
+
+// A plain byte permutation, fine without float vectors
+static void convert_simd_f32_to_f32(const uint8_t *src, float *dst, uint32_t count) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8((uint8_t *)&dst[i], vrev32q_u8(vld1q_u8(&src[4 * i])));
+    }
+
+    scalar_f32_to_f32(&src[4 * i], &dst[i], count - i);
+}
+
+const struct vbus_convert_ops vbus_convert_ops_simd = {
+    .name = "helium",
+    .s16_to_q31 = convert_simd_s16_to_q31,
+    .s32_to_q31 = convert_simd_s32_to_q31,
+    .f32_to_q31 = convert_simd_f32_to_q31,
+    .s16_to_f32 = convert_simd_s16_to_f32,
+    .s32_to_f32 = convert_simd_s32_to_f32,
+    .f32_to_f32 = convert_simd_f32_to_f32,
+};
+
+#endif
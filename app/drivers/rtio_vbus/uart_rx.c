@@ -0,0 +1,320 @@
+#include <rtio_vbus/uart_rx.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+#include <rtio_vbus/flow_ctrl.h>
+#endif
+
+LOG_MODULE_REGISTER(vbus_uart_rx, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#define RX_FLAG_RUNNING 0
+#define RX_FLAG_PAUSED 1
+#define RX_FLAG_FLOW_CTRL 2
+
+// Shortest window the arrival rate is measured over
+#define RATE_WINDOW_MIN_US 1000
+
+static inline void schedule_decode(struct vbus_uart_rx *rx, k_timeout_t delay, bool reschedule) {
+    if (rx->work_q) {
+        if (reschedule) {
+            k_work_reschedule_for_queue(rx->work_q, &rx->work, delay);
+        } else {
+            k_work_schedule_for_queue(rx->work_q, &rx->work, delay);
+        }
+    } else {
+        if (reschedule) {
+            k_work_reschedule(&rx->work, delay);
+        } else {
+            k_work_schedule(&rx->work, delay);
+        }
+    }
+}
+
+static void uart_rx_isr(const struct device *dev, void *user_data) {
+    struct vbus_uart_rx *rx = user_data;
+    bool buffered_bytes = false;
+
+    while (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
+        uint8_t *data;
+        uint32_t space = ring_buf_put_claim(&rx->ring, &data, ring_buf_capacity_get(&rx->ring));
+
+        if (space == 0) {
+            // Leave the bytes in the UART, the handler re-enables reception
+            ring_buf_put_finish(&rx->ring, 0);
+            uart_irq_rx_disable(dev);
+            atomic_set_bit(&rx->flags, RX_FLAG_PAUSED);
+            atomic_inc(&rx->pauses);
+            vbus_stats_rx_pause(VBUS_STATS_OF(rx));
+            // The full ring is above the watermark, decoding starts right away
+            break;
+        }
+
+        int read = uart_fifo_read(dev, data, space);
+        ring_buf_put_finish(&rx->ring, read > 0 ? read : 0);
+        if (read <= 0) {
+            break;
+        }
+        buffered_bytes = true;
+#if defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL) ||                   \
+    defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE)
+        atomic_add(&rx->received, read);
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+        rx->stream_pos += read;
+        vbus_trace_rx(read, rx->stream_pos);
+#endif
+    }
+
+    if (buffered_bytes) {
+        atomic_inc(&rx->irqs);
+        vbus_stats_rx_irq(VBUS_STATS_OF(rx));
+    }
+
+    uint32_t buffered = ring_buf_size_get(&rx->ring);
+    vbus_stats_ring_fill(VBUS_STATS_OF(rx), buffered);
+    if (buffered >= rx->watermark) {
+        schedule_decode(rx, K_NO_WAIT, true);
+    } else if (buffered > 0) {
+        // Keeps an already running deadline, so latency stays bounded
+        schedule_decode(rx, rx->max_latency, false);
+    }
+}
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+static inline void schedule_credit(struct vbus_uart_rx *rx, k_timeout_t delay) {
+    if (rx->work_q) {
+        k_work_reschedule_for_queue(rx->work_q, &rx->credit_work, delay);
+    } else {
+        k_work_reschedule(&rx->credit_work, delay);
+    }
+}
+
+static void send_credit(struct vbus_uart_rx *rx, uint32_t received, uint32_t limit) {
+    uint8_t frame[VBUS_FLOW_CREDIT_FRAME_SIZE];
+
+    vbus_flow_credit_encode(received, limit, frame);
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        uart_poll_out(rx->uart, frame[i]);
+    }
+
+    rx->credit_limit = limit;
+    rx->credits++;
+}
+
+// Runs on the work queue only, so credits never interleave on the wire
+static void update_credit(struct vbus_uart_rx *rx, bool force) {
+    // Reading received before the free space errs on the safe side, bytes
+    // arriving in between only shrink the advertised limit
+    uint32_t received = atomic_get(&rx->received);
+    uint32_t limit = received + ring_buf_space_get(&rx->ring);
+    int32_t advanced = (int32_t)(limit - rx->credit_limit);
+    int32_t host_window = (int32_t)(rx->credit_limit - received);
+
+    if (force || (advanced > 0 && (advanced >= (int32_t)rx->credit_threshold ||
+                                   host_window < (int32_t)rx->credit_threshold))) {
+        send_credit(rx, received, limit);
+    }
+}
+
+static void credit_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct vbus_uart_rx *rx = CONTAINER_OF(dwork, struct vbus_uart_rx, credit_work);
+
+    if (!atomic_test_bit(&rx->flags, RX_FLAG_RUNNING)) {
+        return;
+    }
+
+    update_credit(rx, true);
+    if (!K_TIMEOUT_EQ(rx->credit_refresh, K_FOREVER)) {
+        schedule_credit(rx, rx->credit_refresh);
+    }
+}
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+// Runs on the work queue only, the ISR just reads the new watermark
+static void adapt_watermark(struct vbus_uart_rx *rx) {
+    if (rx->budget_us == 0) {
+        return;
+    }
+
+    int64_t now = k_uptime_ticks();
+    uint64_t elapsed_us = k_ticks_to_us_floor64(now - rx->rate_start);
+
+    if (elapsed_us < MAX(rx->budget_us, RATE_WINDOW_MIN_US)) {
+        return;
+    }
+
+    uint32_t received = atomic_get(&rx->received);
+    uint32_t sample = (uint32_t)MIN((uint64_t)(received - rx->rate_received) * USEC_PER_SEC /
+                                        elapsed_us,
+                                    UINT32_MAX);
+
+    // After a pause the old rate says nothing, otherwise smooth over ~4 windows
+    if (elapsed_us > 4 * (uint64_t)MAX(rx->budget_us, RATE_WINDOW_MIN_US)) {
+        rx->rate = sample;
+    } else {
+        rx->rate = (uint32_t)(((uint64_t)rx->rate * 3 + sample) / 4);
+    }
+    rx->rate_received = received;
+    rx->rate_start = now;
+
+    uint64_t target = (uint64_t)rx->rate * rx->budget_us / (2 * USEC_PER_SEC);
+    rx->watermark = (uint32_t)CLAMP(target, rx->min_watermark, rx->max_watermark);
+}
+#endif
+
+static void uart_rx_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct vbus_uart_rx *rx = CONTAINER_OF(dwork, struct vbus_uart_rx, work);
+
+    atomic_inc(&rx->wakeups);
+    vbus_stats_rx_wakeup(VBUS_STATS_OF(rx));
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+    adapt_watermark(rx);
+#endif
+
+    rx->handler(rx, &rx->ring);
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    if (atomic_test_bit(&rx->flags, RX_FLAG_FLOW_CTRL) &&
+        atomic_test_bit(&rx->flags, RX_FLAG_RUNNING)) {
+        update_credit(rx, false);
+    }
+#endif
+
+    if (ring_buf_space_get(&rx->ring) > 0 &&
+        atomic_test_and_clear_bit(&rx->flags, RX_FLAG_PAUSED) &&
+        atomic_test_bit(&rx->flags, RX_FLAG_RUNNING)) {
+        uart_irq_rx_enable(rx->uart);
+    }
+}
+
+int vbus_uart_rx_init(struct vbus_uart_rx *rx, const struct device *uart,
+                      uint8_t *buf, uint32_t buf_size, uint32_t watermark,
+                      k_timeout_t max_latency, vbus_uart_rx_handler_t handler,
+                      struct k_work_q *work_q) {
+    if (!rx || !uart || !buf || buf_size == 0 || !handler) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (!device_is_ready(uart)) {
+        LOG_ERR("UART device %s is not ready", uart->name);
+        return -ENODEV;
+    }
+
+    rx->uart = uart;
+    ring_buf_init(&rx->ring, buf_size, buf);
+    k_work_init_delayable(&rx->work, uart_rx_work_handler);
+    rx->work_q = work_q;
+    rx->handler = handler;
+    rx->watermark = CLAMP(watermark, 1, buf_size);
+    rx->max_latency = max_latency;
+    atomic_clear(&rx->flags);
+    atomic_clear(&rx->pauses);
+    atomic_clear(&rx->irqs);
+    atomic_clear(&rx->wakeups);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    rx->stats = NULL;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING
+    rx->stream_pos = 0;
+#endif
+#if defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL) ||                   \
+    defined(CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE)
+    atomic_clear(&rx->received);
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+    rx->init_max_latency = max_latency;
+    rx->budget_us = 0;
+    rx->min_watermark = rx->watermark;
+    rx->max_watermark = MAX(buf_size / 2, rx->watermark);
+    rx->rate = 0;
+#endif
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    k_work_init_delayable(&rx->credit_work, credit_work_handler);
+    rx->credit_limit = 0;
+    rx->credits = 0;
+#endif
+
+    return 0;
+}
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+void vbus_uart_rx_set_stats(struct vbus_uart_rx *rx, struct vbus_stats *stats) {
+    rx->stats = stats;
+}
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+int vbus_uart_rx_set_flow_ctrl(struct vbus_uart_rx *rx, uint32_t threshold,
+                               k_timeout_t refresh) {
+    if (atomic_test_bit(&rx->flags, RX_FLAG_RUNNING)) {
+        return -EBUSY;
+    }
+
+    rx->credit_threshold = CLAMP(threshold, 1, ring_buf_capacity_get(&rx->ring));
+    rx->credit_refresh = refresh;
+    atomic_set_bit(&rx->flags, RX_FLAG_FLOW_CTRL);
+    return 0;
+}
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+int vbus_uart_rx_set_latency_budget(struct vbus_uart_rx *rx, uint32_t budget_us) {
+    if (atomic_test_bit(&rx->flags, RX_FLAG_RUNNING)) {
+        return -EBUSY;
+    }
+
+    rx->budget_us = budget_us;
+    rx->watermark = rx->min_watermark;
+    rx->max_latency = rx->init_max_latency;
+    if (budget_us > 0 && (K_TIMEOUT_EQ(rx->init_max_latency, K_FOREVER) ||
+                          K_USEC(budget_us).ticks < rx->init_max_latency.ticks)) {
+        rx->max_latency = K_USEC(budget_us);
+    }
+    return 0;
+}
+#endif
+
+int vbus_uart_rx_start(struct vbus_uart_rx *rx) {
+    int ret = uart_irq_callback_user_data_set(rx->uart, uart_rx_isr, rx);
+    if (ret) {
+        LOG_ERR("Failed to set UART callback (%d)", ret);
+        return ret;
+    }
+
+    atomic_set_bit(&rx->flags, RX_FLAG_RUNNING);
+    atomic_clear_bit(&rx->flags, RX_FLAG_PAUSED);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+    rx->rate_received = atomic_get(&rx->received);
+    rx->rate_start = k_uptime_ticks();
+#endif
+    uart_irq_rx_enable(rx->uart);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    if (atomic_test_bit(&rx->flags, RX_FLAG_FLOW_CTRL)) {
+        // The host waits for this first credit before it sends anything
+        schedule_credit(rx, K_NO_WAIT);
+    }
+#endif
+    return 0;
+}
+
+void vbus_uart_rx_stop(struct vbus_uart_rx *rx) {
+    struct k_work_sync sync;
+
+    atomic_clear_bit(&rx->flags, RX_FLAG_RUNNING);
+    uart_irq_rx_disable(rx->uart);
+    // A handler already running finishes before the caller may reset its state
+    k_work_cancel_delayable_sync(&rx->work, &sync);
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    k_work_cancel_delayable_sync(&rx->credit_work, &sync);
+#endif
+}
+
+void vbus_uart_rx_flush(struct vbus_uart_rx *rx) {
+    ring_buf_reset(&rx->ring);
+}
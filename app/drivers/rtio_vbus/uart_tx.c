@@ -0,0 +1,183 @@
+#include <rtio_vbus/uart_tx.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(vbus_uart_tx, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+#define TX_FLAG_RUNNING 0
+// The TX interrupt is enabled and drains the ring until it is empty
+#define TX_FLAG_ACTIVE 1
+
+static inline void schedule_deadline(struct vbus_uart_tx *tx) {
+    // Keeps an already running deadline, so latency stays bounded
+    if (tx->work_q) {
+        k_work_schedule_for_queue(tx->work_q, &tx->work, tx->max_latency);
+    } else {
+        k_work_schedule(&tx->work, tx->max_latency);
+    }
+}
+
+static void start_tx(struct vbus_uart_tx *tx) {
+    if (!atomic_test_bit(&tx->flags, TX_FLAG_RUNNING) ||
+        atomic_test_and_set_bit(&tx->flags, TX_FLAG_ACTIVE)) {
+        return;
+    }
+
+    uart_irq_tx_enable(tx->uart);
+}
+
+static void uart_tx_isr(const struct device *dev, void *user_data) {
+    struct vbus_uart_tx *tx = user_data;
+
+    while (uart_irq_update(dev) && uart_irq_tx_ready(dev)) {
+        uint8_t *data;
+        uint32_t claimed = ring_buf_get_claim(&tx->ring, &data, tx->chunk_size);
+
+        if (claimed == 0) {
+            ring_buf_get_finish(&tx->ring, 0);
+            uart_irq_tx_disable(dev);
+            atomic_clear_bit(&tx->flags, TX_FLAG_ACTIVE);
+
+            // A thread may have queued bytes after the claim and seen the
+            // pipeline active, nobody else would restart it
+            if (!ring_buf_is_empty(&tx->ring) &&
+                !atomic_test_and_set_bit(&tx->flags, TX_FLAG_ACTIVE)) {
+                uart_irq_tx_enable(dev);
+            }
+            return;
+        }
+
+        int sent = uart_fifo_fill(dev, data, claimed);
+        ring_buf_get_finish(&tx->ring, sent > 0 ? sent : 0);
+        if (sent <= 0) {
+            break;
+        }
+    }
+}
+
+static void uart_tx_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct vbus_uart_tx *tx = CONTAINER_OF(dwork, struct vbus_uart_tx, work);
+
+    if (!ring_buf_is_empty(&tx->ring)) {
+        start_tx(tx);
+    }
+}
+
+// Called after every enqueue, outside the lock
+static void kick(struct vbus_uart_tx *tx) {
+    if (ring_buf_size_get(&tx->ring) >= tx->watermark) {
+        start_tx(tx);
+    } else if (!atomic_test_bit(&tx->flags, TX_FLAG_ACTIVE)) {
+        schedule_deadline(tx);
+    }
+}
+
+int vbus_uart_tx_init(struct vbus_uart_tx *tx, const struct device *uart, uint8_t *buf,
+                      uint32_t buf_size, uint32_t watermark, k_timeout_t max_latency,
+                      uint32_t chunk_size, struct k_work_q *work_q) {
+    if (!tx || !uart || !buf || buf_size == 0 || chunk_size == 0) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    if (!device_is_ready(uart)) {
+        LOG_ERR("UART device %s is not ready", uart->name);
+        return -ENODEV;
+    }
+
+    tx->uart = uart;
+    ring_buf_init(&tx->ring, buf_size, buf);
+    k_mutex_init(&tx->lock);
+    k_work_init_delayable(&tx->work, uart_tx_work_handler);
+    tx->work_q = work_q;
+    tx->version = VBUS_FRAME_V1;
+    tx->watermark = CLAMP(watermark, 1, buf_size);
+    tx->max_latency = max_latency;
+    tx->chunk_size = chunk_size;
+    atomic_clear(&tx->flags);
+    tx->dropped = 0;
+
+    return 0;
+}
+
+int vbus_uart_tx_set_version(struct vbus_uart_tx *tx, enum vbus_frame_version version) {
+    if (vbus_frame_header_size(version) == 0) {
+        LOG_ERR("Unsupported frame version %d", version);
+        return -ENOTSUP;
+    }
+
+    tx->version = version;
+    return 0;
+}
+
+int vbus_uart_tx_send(struct vbus_uart_tx *tx, const struct vbus_frame **frames,
+                      uint32_t frame_count) {
+    if (!tx || !frames) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    // Producers are serialized, the TX interrupt is the only consumer
+    k_mutex_lock(&tx->lock, K_FOREVER);
+    int ret = vbus_frame_encode_ring_ver(tx->version, frames, frame_count, &tx->ring);
+    if (ret == -ENOBUFS) {
+        tx->dropped++;
+    }
+    k_mutex_unlock(&tx->lock);
+
+    if (ret) {
+        return ret;
+    }
+
+    kick(tx);
+    return 0;
+}
+
+int vbus_uart_tx_write(struct vbus_uart_tx *tx, const uint8_t *data, uint32_t size) {
+    if (!tx || (!data && size > 0)) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&tx->lock, K_FOREVER);
+    if (ring_buf_space_get(&tx->ring) < size) {
+        tx->dropped++;
+        k_mutex_unlock(&tx->lock);
+        return -ENOBUFS;
+    }
+    ring_buf_put(&tx->ring, data, size);
+    k_mutex_unlock(&tx->lock);
+
+    kick(tx);
+    return 0;
+}
+
+void vbus_uart_tx_flush(struct vbus_uart_tx *tx) {
+    if (!ring_buf_is_empty(&tx->ring)) {
+        start_tx(tx);
+    }
+}
+
+int vbus_uart_tx_start(struct vbus_uart_tx *tx) {
+    int ret = uart_irq_callback_user_data_set(tx->uart, uart_tx_isr, tx);
+    if (ret) {
+        LOG_ERR("Failed to set UART callback (%d)", ret);
+        return ret;
+    }
+
+    atomic_clear_bit(&tx->flags, TX_FLAG_ACTIVE);
+    atomic_set_bit(&tx->flags, TX_FLAG_RUNNING);
+    if (!ring_buf_is_empty(&tx->ring)) {
+        kick(tx);
+    }
+    return 0;
+}
+
+void vbus_uart_tx_stop(struct vbus_uart_tx *tx) {
+    atomic_clear_bit(&tx->flags, TX_FLAG_RUNNING);
+    uart_irq_tx_disable(tx->uart);
+    atomic_clear_bit(&tx->flags, TX_FLAG_ACTIVE);
+    k_work_cancel_delayable(&tx->work);
+}
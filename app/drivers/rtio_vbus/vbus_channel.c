@@ -0,0 +1,51 @@
+#define DT_DRV_COMPAT vsense_vbus
+
+#include <rtio_vbus/vbus_channel.h>
+
+#define CHANNEL_QUEUE_NAME(ord) _CONCAT(vbus_channel_queue_, ord)
+
+// Expands the ordinal first, VBUS_SPSC_QUEUE_DEFINE pastes onto the name
+#define CHANNEL_QUEUE_DEFINE(ord, depth, slot_size)                                 \
+    CHANNEL_QUEUE_DEFINE_(ord, depth, slot_size)
+#define CHANNEL_QUEUE_DEFINE_(ord, depth, slot_size)                                \
+    VBUS_SPSC_QUEUE_DEFINE(vbus_channel_queue_##ord, depth, slot_size)
+
+#define CHANNEL_SAME_INDEX(node_id, channel_idx) +(DT_REG_ADDR(node_id) == (channel_idx))
+
+#define CHANNEL_DEFINE(node_id)                                                     \
+    BUILD_ASSERT(DT_REG_ADDR(node_id) < VBUS_DEMUX_CHANNEL_COUNT,                   \
+                 "vbus channel index out of range");                                \
+    BUILD_ASSERT((0 DT_FOREACH_CHILD_STATUS_OKAY_VARGS(DT_PARENT(node_id),          \
+                                                       CHANNEL_SAME_INDEX,          \
+                                                       DT_REG_ADDR(node_id))) == 1, \
+                 "Two vbus channels share an index");                               \
+    BUILD_ASSERT(DT_PROP(node_id, frame_size) <= UINT16_MAX,                        \
+                 "vbus channel frame-size out of range");                           \
+    CHANNEL_QUEUE_DEFINE(DT_DEP_ORD(node_id), DT_PROP(node_id, queue_depth),        \
+                         DT_PROP(node_id, frame_size));                             \
+    const struct vbus_channel VBUS_CHANNEL_DT_NAME(node_id) = {                     \
+        .queue = &CHANNEL_QUEUE_NAME(DT_DEP_ORD(node_id)),                          \
+        .latency_budget_us = DT_PROP(node_id, latency_budget_us),                   \
+        .frame_size = DT_PROP(node_id, frame_size),                                 \
+        .channel_idx = DT_REG_ADDR(node_id),                                        \
+        .sample_format = DT_ENUM_IDX(node_id, sample_format),                       \
+    };
+
+#define CHANNEL_ROUTE(node_id)                                                      \
+    [DT_REG_ADDR(node_id)] = &CHANNEL_QUEUE_NAME(DT_DEP_ORD(node_id)),
+
+#define CHANNEL_ENTRY(node_id) [DT_REG_ADDR(node_id)] = VBUS_CHANNEL_DT_GET(node_id),
+
+#define BUS_DEFINE(inst)                                                            \
+    DT_INST_FOREACH_CHILD_STATUS_OKAY(inst, CHANNEL_DEFINE)                         \
+                                                                                    \
+    const struct vbus_channel *const                                                \
+        VBUS_CHANNEL_TABLE_DT_NAME(DT_DRV_INST(inst))[VBUS_DEMUX_CHANNEL_COUNT] = { \
+        DT_INST_FOREACH_CHILD_STATUS_OKAY(inst, CHANNEL_ENTRY)                      \
+    };                                                                              \
+                                                                                    \
+    struct vbus_demux VBUS_DEMUX_DT_NAME(DT_DRV_INST(inst)) = {                     \
+        .queues = {DT_INST_FOREACH_CHILD_STATUS_OKAY(inst, CHANNEL_ROUTE)},         \
+    };
+
+DT_INST_FOREACH_STATUS_OKAY(BUS_DEFINE)
@@ -0,0 +1,128 @@
+#include <rtio_vbus/vbus_rtio.h>
+#include <rtio_vbus/sample_codec.h>
+#include <rtio_vbus/vbus_trace.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(vbus_rtio, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+static void vbus_rtio_submit(struct rtio_iodev_sqe *iodev_sqe) {
+    const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+    struct vbus_rtio_channel *channel = sqe->iodev->data;
+
+    if (sqe->op != RTIO_OP_RX) {
+        LOG_ERR("Unsupported operation %d on channel %u", sqe->op, channel->channel_idx);
+        rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+        return;
+    }
+
+    mpsc_push(&channel->pending, &iodev_sqe->q);
+}
+
+const struct rtio_iodev_api vbus_rtio_iodev_api = {
+    .submit = vbus_rtio_submit,
+};
+
+void vbus_rtio_init(struct vbus_rtio *bus) {
+    memset(bus, 0, sizeof(*bus));
+}
+
+int vbus_rtio_attach(struct vbus_rtio *bus, const struct rtio_iodev *iodev) {
+    if (!bus || !iodev || iodev->api != &vbus_rtio_iodev_api) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    const struct vbus_rtio_channel *channel = iodev->data;
+
+    if (bus->iodevs[channel->channel_idx]) {
+        LOG_ERR("Channel %u already has an iodev", channel->channel_idx);
+        return -EALREADY;
+    }
+
+    bus->iodevs[channel->channel_idx] = iodev;
+    return 0;
+}
+
+static int complete_read(struct rtio_iodev_sqe *iodev_sqe, const struct vbus_frame *frame) {
+    uint8_t *buf;
+    uint32_t buf_len;
+
+    int size = vbus_frame_expanded_size(frame);
+    if (size < 0) {
+        rtio_iodev_sqe_err(iodev_sqe, size);
+        return size;
+    }
+
+    int ret = rtio_sqe_rx_buf(iodev_sqe, size, size, &buf, &buf_len);
+    if (ret) {
+        LOG_ERR("No read buffer for frame of %d bytes (%d)", size, ret);
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return ret;
+    }
+
+    // Compressed payloads are expanded straight into the read buffer
+    ret = vbus_frame_expand(frame, buf, buf_len);
+    if (ret < 0) {
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return ret;
+    }
+
+    rtio_iodev_sqe_ok(iodev_sqe, ret);
+    return 0;
+}
+
+uint32_t vbus_rtio_complete(struct vbus_rtio *bus, const struct vbus_frame *frames,
+                            uint32_t frame_count) {
+    uint32_t completed = 0;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const struct rtio_iodev *iodev = bus->iodevs[frames[i].channel_idx];
+
+        if (!iodev) {
+            bus->unrouted++;
+            continue;
+        }
+
+        struct vbus_rtio_channel *channel = iodev->data;
+
+        // Multishot reads are resubmitted while completing, so pop per frame
+        struct mpsc_node *node = mpsc_pop(&channel->pending);
+        if (!node) {
+            channel->dropped++;
+            continue;
+        }
+
+        struct rtio_iodev_sqe *iodev_sqe = CONTAINER_OF(node, struct rtio_iodev_sqe, q);
+        vbus_trace_dispatch(&frames[i]);
+        if (complete_read(iodev_sqe, &frames[i]) == 0) {
+            // The payload is in the buffer of the reader
+            vbus_trace_consumed(&frames[i]);
+            channel->completed++;
+            completed++;
+        }
+    }
+
+    return completed;
+}
+
+int vbus_rtio_process(struct vbus_rtio *bus, struct vbus_frame_view *view, uint32_t buf_size) {
+    if (!bus || !view) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    int ret = vbus_frame_decode_view(view, buf_size);
+    if (ret) {
+        return ret;
+    }
+
+    uint32_t completed = vbus_rtio_complete(bus, view->frames, view->frame_count);
+
+    ret = vbus_frame_view_release(view);
+    if (ret) {
+        return ret;
+    }
+
+    return (int)completed;
+}
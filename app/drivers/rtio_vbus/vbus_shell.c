@@ -0,0 +1,67 @@
+#include <rtio_vbus/vbus_stats.h>
+#include <zephyr/shell/shell.h>
+#include <string.h>
+
+struct stats_print_ctx {
+    const struct shell *sh;
+    const char *name;
+    uint32_t printed;
+};
+
+static void print_instance(struct vbus_stats *stats, void *user_data) {
+    struct stats_print_ctx *ctx = user_data;
+    const struct shell *sh = ctx->sh;
+
+    if (ctx->name && strcmp(ctx->name, stats->name) != 0) {
+        return;
+    }
+
+    ctx->printed++;
+    shell_print(sh, "%s: frames=%u bytes=%u decode_calls=%u stalls=%u drops=%u crc_errors=%u",
+                stats->name, stats->s.frames, stats->s.bytes, stats->s.decode_calls,
+                stats->s.stalls, stats->s.drops, stats->s.crc_errors);
+    shell_print(sh, "  ring_hwm=%u rx_pauses=%u", stats->s.ring_hwm, stats->s.rx_pauses);
+    // Every RX interrupt would otherwise wake the decoder
+    shell_print(sh, "  rx_irqs=%u rx_wakeups=%u wakeups_saved=%u", stats->s.rx_irqs,
+                stats->s.rx_wakeups,
+                stats->s.rx_irqs > stats->s.rx_wakeups ? stats->s.rx_irqs - stats->s.rx_wakeups
+                                                       : 0);
+    shell_print(sh, "  decode time <16us=%u <64us=%u <256us=%u <1ms=%u <4ms=%u >=4ms=%u",
+                stats->s.decode_lt_16us, stats->s.decode_lt_64us, stats->s.decode_lt_256us,
+                stats->s.decode_lt_1ms, stats->s.decode_lt_4ms, stats->s.decode_ge_4ms);
+
+    // Only channels that saw traffic
+    for (uint32_t i = 0; i < VBUS_STATS_CHANNELS; i++) {
+        if (stats->chan[i].frames == 0 && stats->chan[i].drops == 0) {
+            continue;
+        }
+
+        shell_print(sh, "  ch%-3u frames=%u bytes=%u drops=%u", i, stats->chan[i].frames,
+                    stats->chan[i].bytes, stats->chan[i].drops);
+    }
+}
+
+static int cmd_vbus_stats(const struct shell *sh, size_t argc, char **argv) {
+    struct stats_print_ctx ctx = {
+        .sh = sh,
+        .name = argc > 1 ? argv[1] : NULL,
+    };
+
+    vbus_stats_foreach(print_instance, &ctx);
+
+    if (ctx.name && ctx.printed == 0) {
+        shell_error(sh, "No vbus instance named %s", ctx.name);
+        return -ENOENT;
+    }
+
+    shell_print(sh, "codec: alloc_fails=%u", vbus_stats_alloc_fails());
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_vbus,
+    SHELL_CMD_ARG(stats, NULL, "Show data path counters: stats [instance]", cmd_vbus_stats,
+                  1, 1),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(vbus, &sub_vbus, "vbus data path commands", NULL);
@@ -0,0 +1,127 @@
+#include <rtio_vbus/vbus_stats.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(vbus_stats, CONFIG_APP_DRIVERS_RTIO_VBUS_LOG_LEVEL);
+
+STATS_NAME_START(vbus)
+STATS_NAME(vbus, frames)
+STATS_NAME(vbus, bytes)
+STATS_NAME(vbus, decode_calls)
+STATS_NAME(vbus, stalls)
+STATS_NAME(vbus, drops)
+STATS_NAME(vbus, crc_errors)
+STATS_NAME(vbus, rx_pauses)
+STATS_NAME(vbus, rx_irqs)
+STATS_NAME(vbus, rx_wakeups)
+STATS_NAME(vbus, ring_hwm)
+STATS_NAME(vbus, decode_lt_16us)
+STATS_NAME(vbus, decode_lt_64us)
+STATS_NAME(vbus, decode_lt_256us)
+STATS_NAME(vbus, decode_lt_1ms)
+STATS_NAME(vbus, decode_lt_4ms)
+STATS_NAME(vbus, decode_ge_4ms)
+STATS_NAME_END(vbus);
+
+STATS_NAME_START(vbus_chan)
+STATS_NAME(vbus_chan, frames)
+STATS_NAME(vbus_chan, bytes)
+STATS_NAME(vbus_chan, drops)
+STATS_NAME_END(vbus_chan);
+
+// Failures of the heap decoder, which has no instance to report to
+STATS_SECT_START(vbus_codec)
+STATS_SECT_ENTRY32(alloc_fails)
+STATS_SECT_END;
+
+STATS_NAME_START(vbus_codec)
+STATS_NAME(vbus_codec, alloc_fails)
+STATS_NAME_END(vbus_codec);
+
+static STATS_SECT_DECL(vbus_codec) codec_stats;
+
+static sys_slist_t instances = SYS_SLIST_STATIC_INIT(&instances);
+static K_MUTEX_DEFINE(instances_lock);
+
+int vbus_stats_init(struct vbus_stats *stats, const char *name) {
+    if (!stats || !name) {
+        LOG_ERR("Invalid parameters");
+        return -EINVAL;
+    }
+
+    // Channel group names must stay unique, snprintk() would cut them off
+    if (strlen(name) > VBUS_STATS_NAME_MAX - sizeof("_ch255")) {
+        LOG_ERR("Stats name %s is too long", name);
+        return -ENAMETOOLONG;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+
+    int ret = stats_init_and_reg(&stats->s.s_hdr, STATS_SIZE_INIT_PARMS(stats->s, STATS_SIZE_32),
+                                 STATS_NAME_INIT_PARMS(vbus), name);
+    if (ret) {
+        LOG_ERR("Failed to register stats %s (%d)", name, ret);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < VBUS_STATS_CHANNELS; i++) {
+        snprintk(stats->chan_names[i], VBUS_STATS_NAME_MAX, "%s_ch%u", name, i);
+        ret = stats_init_and_reg(&stats->chan[i].s_hdr,
+                                 STATS_SIZE_INIT_PARMS(stats->chan[i], STATS_SIZE_32),
+                                 STATS_NAME_INIT_PARMS(vbus_chan), stats->chan_names[i]);
+        if (ret) {
+            LOG_ERR("Failed to register stats %s (%d)", stats->chan_names[i], ret);
+            return ret;
+        }
+    }
+
+    k_mutex_lock(&instances_lock, K_FOREVER);
+    sys_slist_append(&instances, &stats->node);
+    k_mutex_unlock(&instances_lock);
+    return 0;
+}
+
+// Counters follow the registered header of each group
+#define CLEAR_COUNTERS(group) \
+    memset((uint8_t *)&(group) + sizeof(struct stats_hdr), 0, \
+           sizeof(group) - sizeof(struct stats_hdr))
+
+void vbus_stats_reset(struct vbus_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&stats->lock);
+
+    CLEAR_COUNTERS(stats->s);
+    for (uint32_t i = 0; i < VBUS_STATS_CHANNELS; i++) {
+        CLEAR_COUNTERS(stats->chan[i]);
+    }
+    k_spin_unlock(&stats->lock, key);
+}
+
+void vbus_stats_foreach(void (*fn)(struct vbus_stats *stats, void *user_data),
+                        void *user_data) {
+    struct vbus_stats *stats;
+
+    k_mutex_lock(&instances_lock, K_FOREVER);
+    SYS_SLIST_FOR_EACH_CONTAINER(&instances, stats, node) {
+        fn(stats, user_data);
+    }
+    k_mutex_unlock(&instances_lock);
+}
+
+uint32_t vbus_stats_alloc_fails(void) {
+    return codec_stats.alloc_fails;
+}
+
+void vbus_stats_alloc_failed(void) {
+    STATS_INC(codec_stats, alloc_fails);
+}
+
+static int vbus_stats_sys_init(void) {
+    return stats_init_and_reg(&codec_stats.s_hdr, STATS_SIZE_INIT_PARMS(codec_stats, STATS_SIZE_32),
+                              STATS_NAME_INIT_PARMS(vbus_codec), "vbus_codec");
+}
+
+SYS_INIT(vbus_stats_sys_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,466 @@
+/*
+* Frame codec microbenchmarks. Every case prints one line of key=value
+* pairs starting with "BENCH", for example
+*
+*   BENCH op=decode ver=0x01 payload=256 batch=8 wrap=1 iters=2000 ns_per_frame=412
+*         mb_per_s=629.13 allocs_per_frame=2.12
+*
+* (on a single line) so runs can be collected with grep and compared across
+* commits. Throughput counts wire bytes, headers and sync framing included.
+*
+* Sample conversion cases print ns_per_sample and the speedup over the
+* scalar kernel of the same op and sample count.
+*
+* Times come from the host monotonic clock. On native_sim the kernel clock
+* is simulated and does not advance while code runs, which is why the
+* native_sim configuration links the host C library.
+*/
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/sample_convert.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(frame_benchmark, LOG_LEVEL_INF);
+
+#define BENCH_RING_SIZE (256 * 1024)
+#define BENCH_MAX_PAYLOAD 65535
+#define BENCH_MAX_BATCH 64
+// Each case runs until about this many wire bytes went through the codec
+#define BENCH_TARGET_BYTES (4 * 1024 * 1024)
+#define BENCH_MIN_ITERS 8
+#define BENCH_MAX_ITERS 2000
+#define BENCH_CONVERT_MAX_SAMPLES 4096
+// Conversions run until about this many samples were produced
+#define BENCH_CONVERT_TARGET_SAMPLES (4 * 1024 * 1024)
+
+static const uint32_t payload_sizes[] = {0, 16, 64, 256, 1024, 4096, 16384, BENCH_MAX_PAYLOAD};
+static const uint32_t batch_sizes[] = {1, 8, BENCH_MAX_BATCH};
+static const enum vbus_frame_version versions[] = {
+    VBUS_FRAME_V1,
+    VBUS_FRAME_V2 | VBUS_FRAME_SYNC,
+};
+
+static uint8_t ring_storage[BENCH_RING_SIZE];
+static struct ring_buf ring;
+static uint8_t wire[BENCH_RING_SIZE];
+static uint8_t payload[BENCH_MAX_PAYLOAD];
+static uint8_t bounce[BENCH_MAX_PAYLOAD];
+
+static const uint32_t convert_counts[] = {16, 256, BENCH_CONVERT_MAX_SAMPLES};
+static int32_t convert_q31[BENCH_CONVERT_MAX_SAMPLES];
+static float convert_f32[BENCH_CONVERT_MAX_SAMPLES];
+
+static struct vbus_frame frames[BENCH_MAX_BATCH];
+static const struct vbus_frame *frame_ptrs[BENCH_MAX_BATCH];
+static struct vbus_frame view_frames[BENCH_MAX_BATCH];
+
+static uint64_t clock_overhead_ns;
+
+enum bench_op {
+    BENCH_DECODE,
+    BENCH_DECODE_VIEW,
+    BENCH_ENCODE,
+    BENCH_ENCODE_RING,
+};
+
+static const char *const op_names[] = {
+    [BENCH_DECODE] = "decode",
+    [BENCH_DECODE_VIEW] = "decode_view",
+    [BENCH_ENCODE] = "encode",
+    [BENCH_ENCODE_RING] = "encode_ring",
+};
+
+enum convert_op {
+    CONVERT_S16_TO_Q31,
+    CONVERT_S32_TO_Q31,
+    CONVERT_F32_TO_Q31,
+    CONVERT_S16_TO_F32,
+    CONVERT_S32_TO_F32,
+    CONVERT_F32_TO_F32,
+    CONVERT_OP_COUNT,
+};
+
+static const char *const convert_names[] = {
+    [CONVERT_S16_TO_Q31] = "convert_s16_to_q31",
+    [CONVERT_S32_TO_Q31] = "convert_s32_to_q31",
+    [CONVERT_F32_TO_Q31] = "convert_f32_to_q31",
+    [CONVERT_S16_TO_F32] = "convert_s16_to_f32",
+    [CONVERT_S32_TO_F32] = "convert_s32_to_f32",
+    [CONVERT_F32_TO_F32] = "convert_f32_to_f32",
+};
+
+struct bench_case {
+    enum bench_op op;
+    enum vbus_frame_version version;
+    uint32_t payload_size;
+    uint32_t batch;
+    bool wrap;
+    // Encoded size of the whole batch
+    uint32_t wire_size;
+};
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t elapsed_ns(uint64_t start)
+{
+    uint64_t ns = now_ns() - start;
+
+    return ns > clock_overhead_ns ? ns - clock_overhead_ns : 0;
+}
+
+/*
+* Cost of one now_ns() pair, subtracted from every timed region so that
+* small frames are not dominated by the clock itself.
+*/
+static void measure_clock_overhead(void)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = now_ns();
+        uint64_t ns = now_ns() - start;
+
+        best = MIN(best, ns);
+    }
+
+    clock_overhead_ns = best;
+}
+
+/*
+* Empty the ring and move its read/write position to offset without
+* copying anything.
+*/
+static void ring_set_position(uint32_t offset)
+{
+    uint8_t *data;
+
+    ring_buf_reset(&ring);
+    if (offset == 0) {
+        return;
+    }
+
+    zassert_equal(ring_buf_put_claim(&ring, &data, offset), offset);
+    zassert_ok(ring_buf_put_finish(&ring, offset));
+    zassert_equal(ring_buf_get_claim(&ring, &data, offset), offset);
+    zassert_ok(ring_buf_get_finish(&ring, offset));
+}
+
+// Start offset of the batch, straddling the wrap point in the middle
+static uint32_t case_position(const struct bench_case *bc)
+{
+    return bc->wrap ? BENCH_RING_SIZE - bc->wire_size / 2 : 0;
+}
+
+static void free_decoded(struct vbus_frame **decoded, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        k_free(decoded[i]->data);
+        k_free(decoded[i]);
+    }
+    k_free(decoded);
+}
+
+/*
+* Run one iteration of the case, returning the time spent inside the
+* codec. Ring setup and freeing decoded frames are not timed.
+*/
+static uint64_t run_once(const struct bench_case *bc, struct vbus_frame_view *view)
+{
+    struct vbus_frame **decoded;
+    uint32_t count = 0;
+    uint8_t *encoded;
+    uint32_t encoded_size;
+    uint64_t start;
+    uint64_t ns;
+    int ret;
+
+    switch (bc->op) {
+    case BENCH_DECODE:
+        ring_set_position(case_position(bc));
+        zassert_equal(ring_buf_put(&ring, wire, bc->wire_size), bc->wire_size);
+        start = now_ns();
+        ret = vbus_frame_decode_ver(bc->version, &ring, bc->wire_size, &decoded, &count);
+        ns = elapsed_ns(start);
+        zassert_ok(ret);
+        zassert_equal(count, bc->batch);
+        free_decoded(decoded, count);
+        return ns;
+
+    case BENCH_DECODE_VIEW:
+        ring_set_position(case_position(bc));
+        zassert_equal(ring_buf_put(&ring, wire, bc->wire_size), bc->wire_size);
+        start = now_ns();
+        ret = vbus_frame_decode_view(view, bc->wire_size);
+        if (ret == 0) {
+            count = view->frame_count;
+            ret = vbus_frame_view_release(view);
+        }
+        ns = elapsed_ns(start);
+        zassert_ok(ret);
+        zassert_equal(count, bc->batch);
+        return ns;
+
+    case BENCH_ENCODE:
+        start = now_ns();
+        ret = vbus_frame_encode(frame_ptrs, bc->batch, &encoded, &encoded_size);
+        ns = elapsed_ns(start);
+        zassert_ok(ret);
+        zassert_equal(encoded_size, bc->wire_size);
+        k_free(encoded);
+        return ns;
+
+    case BENCH_ENCODE_RING:
+        ring_set_position(case_position(bc));
+        start = now_ns();
+        ret = vbus_frame_encode_ring_ver(bc->version, frame_ptrs, bc->batch, &ring);
+        ns = elapsed_ns(start);
+        zassert_ok(ret);
+        zassert_equal(ring_buf_size_get(&ring), bc->wire_size);
+        return ns;
+    }
+
+    return 0;
+}
+
+static uint32_t case_iterations(const struct bench_case *bc)
+{
+    uint32_t iters = BENCH_TARGET_BYTES / MAX(bc->wire_size, 64U);
+
+    return CLAMP(iters, BENCH_MIN_ITERS, BENCH_MAX_ITERS);
+}
+
+static void run_case(const struct bench_case *bc)
+{
+    struct vbus_frame_view view;
+    uint32_t iters = case_iterations(bc);
+    uint64_t total_ns = 0;
+    uint32_t allocs;
+
+    if (bc->op == BENCH_DECODE_VIEW) {
+        vbus_frame_view_init(&view, &ring, view_frames, ARRAY_SIZE(view_frames));
+        vbus_frame_view_set_bounce(&view, bounce, sizeof(bounce));
+        zassert_ok(vbus_frame_view_set_version(&view, bc->version));
+    }
+
+    // Warm up caches and the heap before measuring
+    run_once(bc, &view);
+
+    allocs = vbus_frame_alloc_count();
+    for (uint32_t i = 0; i < iters; i++) {
+        total_ns += run_once(bc, &view);
+    }
+    allocs = vbus_frame_alloc_count() - allocs;
+
+    uint64_t frame_total = (uint64_t)iters * bc->batch;
+    uint64_t ns_per_frame = total_ns / frame_total;
+    // bytes per ns is GB/s, scaled to MB/s with two decimals
+    uint64_t mbps_x100 = total_ns ? (uint64_t)iters * bc->wire_size * 100000 / total_ns : 0;
+    uint64_t allocs_x100 = (uint64_t)allocs * 100 / frame_total;
+
+    TC_PRINT("BENCH op=%s ver=0x%02x payload=%u batch=%u wrap=%d iters=%u "
+             "ns_per_frame=%u mb_per_s=%u.%02u allocs_per_frame=%u.%02u\n",
+             op_names[bc->op], (unsigned int)bc->version, bc->payload_size, bc->batch,
+             bc->wrap ? 1 : 0, iters, (unsigned int)ns_per_frame,
+             (unsigned int)(mbps_x100 / 100), (unsigned int)(mbps_x100 % 100),
+             (unsigned int)(allocs_x100 / 100), (unsigned int)(allocs_x100 % 100));
+
+    // The zero-copy paths must stay off the heap
+    if (bc->op == BENCH_DECODE_VIEW || bc->op == BENCH_ENCODE_RING) {
+        zassert_equal(allocs, 0, "%s allocated %u times", op_names[bc->op], allocs);
+    }
+}
+
+/*
+* Prepare a batch of equally sized frames and its encoded form, returns
+* false if the batch does not fit the ring.
+*/
+static bool prepare_batch(struct bench_case *bc)
+{
+    for (uint32_t i = 0; i < bc->batch; i++) {
+        frames[i] = (struct vbus_frame) {
+            .channel_idx = i % 4,
+            .data = bc->payload_size ? payload : NULL,
+            .size = bc->payload_size,
+            .seq = i,
+        };
+        frame_ptrs[i] = &frames[i];
+    }
+
+    if (vbus_frame_encode_to_ver(bc->version, frame_ptrs, bc->batch, NULL, 0,
+                                 &bc->wire_size) != 0) {
+        return false;
+    }
+
+    if (bc->wire_size > BENCH_RING_SIZE) {
+        return false;
+    }
+
+    zassert_ok(vbus_frame_encode_to_ver(bc->version, frame_ptrs, bc->batch, wire,
+                                        sizeof(wire), &bc->wire_size));
+    return true;
+}
+
+static void run_sweep(enum bench_op op)
+{
+    for (size_t v = 0; v < ARRAY_SIZE(versions); v++) {
+        // The heap encoder only speaks v1
+        if (op == BENCH_ENCODE && versions[v] != VBUS_FRAME_V1) {
+            continue;
+        }
+
+        for (size_t p = 0; p < ARRAY_SIZE(payload_sizes); p++) {
+            for (size_t b = 0; b < ARRAY_SIZE(batch_sizes); b++) {
+                struct bench_case bc = {
+                    .op = op,
+                    .version = versions[v],
+                    .payload_size = payload_sizes[p],
+                    .batch = batch_sizes[b],
+                };
+
+                if (!prepare_batch(&bc)) {
+                    continue;
+                }
+
+                bc.wrap = false;
+                run_case(&bc);
+
+                // Wrap position only matters when a ring buffer is involved
+                if (op != BENCH_ENCODE) {
+                    bc.wrap = true;
+                    run_case(&bc);
+                }
+            }
+        }
+    }
+}
+
+static void convert_once(const struct vbus_convert_ops *ops, enum convert_op op, uint32_t count)
+{
+    // Odd source offset, payload samples are not aligned in a frame
+    const uint8_t *src = &payload[1];
+
+    switch (op) {
+    case CONVERT_S16_TO_Q31:
+        ops->s16_to_q31(src, convert_q31, count);
+        break;
+    case CONVERT_S32_TO_Q31:
+        ops->s32_to_q31(src, convert_q31, count);
+        break;
+    case CONVERT_F32_TO_Q31:
+        ops->f32_to_q31(src, convert_q31, count);
+        break;
+    case CONVERT_S16_TO_F32:
+        ops->s16_to_f32(src, convert_f32, count, 1.0f / 32768.0f);
+        break;
+    case CONVERT_S32_TO_F32:
+        ops->s32_to_f32(src, convert_f32, count, 1.0f / 2147483648.0f);
+        break;
+    case CONVERT_F32_TO_F32:
+        ops->f32_to_f32(src, convert_f32, count);
+        break;
+    default:
+        break;
+    }
+}
+
+static uint64_t run_convert_case(const struct vbus_convert_ops *ops, enum convert_op op,
+                                 uint32_t count, uint64_t scalar_ns)
+{
+    uint32_t iters = CLAMP(BENCH_CONVERT_TARGET_SAMPLES / count, BENCH_MIN_ITERS, 100000U);
+    uint64_t start;
+    uint64_t total_ns;
+
+    // Warm up caches before measuring
+    convert_once(ops, op, count);
+
+    start = now_ns();
+    for (uint32_t i = 0; i < iters; i++) {
+        convert_once(ops, op, count);
+    }
+    total_ns = elapsed_ns(start);
+
+    uint64_t ns_per_sample_x100 = total_ns * 100 / ((uint64_t)iters * count);
+    // The scalar baseline passes 0 and reports 1.00
+    uint64_t speedup_x100 = scalar_ns ? scalar_ns * 100 / MAX(total_ns, 1U) : 100;
+
+    TC_PRINT("BENCH op=%s impl=%s samples=%u iters=%u ns_per_sample=%u.%02u "
+             "speedup=%u.%02u\n",
+             convert_names[op], ops->name, count, iters,
+             (unsigned int)(ns_per_sample_x100 / 100), (unsigned int)(ns_per_sample_x100 % 100),
+             (unsigned int)(speedup_x100 / 100), (unsigned int)(speedup_x100 % 100));
+
+    return total_ns;
+}
+
+static void *benchmark_setup(void)
+{
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    measure_clock_overhead();
+    TC_PRINT("BENCH_INFO clock_overhead_ns=%u ring_size=%u\n",
+             (unsigned int)clock_overhead_ns, BENCH_RING_SIZE);
+    return NULL;
+}
+
+static void benchmark_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    ring_buf_init(&ring, sizeof(ring_storage), ring_storage);
+}
+
+ZTEST_SUITE(vbus_frame_benchmark, NULL, benchmark_setup, benchmark_before, NULL, NULL);
+
+ZTEST(vbus_frame_benchmark, test_decode)
+{
+    run_sweep(BENCH_DECODE);
+}
+
+ZTEST(vbus_frame_benchmark, test_decode_view)
+{
+    run_sweep(BENCH_DECODE_VIEW);
+}
+
+ZTEST(vbus_frame_benchmark, test_encode)
+{
+    run_sweep(BENCH_ENCODE);
+}
+
+ZTEST(vbus_frame_benchmark, test_encode_ring)
+{
+    run_sweep(BENCH_ENCODE_RING);
+}
+
+ZTEST(vbus_frame_benchmark, test_convert)
+{
+    const struct vbus_convert_ops *scalar = vbus_convert_ops_get(VBUS_CONVERT_SCALAR);
+
+    for (int op = 0; op < CONVERT_OP_COUNT; op++) {
+        for (size_t c = 0; c < ARRAY_SIZE(convert_counts); c++) {
+            // The scalar case runs first and is the baseline of the others
+            uint64_t scalar_ns = run_convert_case(scalar, op, convert_counts[c], 0);
+
+            scalar_ns = MAX(scalar_ns, 1U);
+            for (int impl = VBUS_CONVERT_SWAR; impl < VBUS_CONVERT_IMPL_COUNT; impl++) {
+                const struct vbus_convert_ops *ops = vbus_convert_ops_get(impl);
+
+                if (ops) {
+                    run_convert_case(ops, op, convert_counts[c], scalar_ns);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,336 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/littlefs.h>
+#include <zephyr/storage/flash_map.h>
+#include <string.h>
+#include <rtio_vbus/capture.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_PATH "/lfs/capture.bin"
+#define TEST_FRAME_COUNT 200
+#define TEST_MAX_PAYLOAD 40
+// Small blocks give a capture of many blocks from a short stream
+#define TEST_BLOCK_SIZE 128
+#define TEST_BLOCK_DATA (TEST_BLOCK_SIZE - VBUS_CAPTURE_BLOCK_HEADER_SIZE)
+#define TEST_FRAMES_PER_GROUP 20
+#define BLOCK_DATA_POSITION(block_no)                                               \
+    (VBUS_CAPTURE_FILE_HEADER_SIZE + (block_no) * TEST_BLOCK_SIZE +                 \
+     VBUS_CAPTURE_BLOCK_HEADER_SIZE)
+
+LOG_MODULE_REGISTER(capture_test, LOG_LEVEL_DBG);
+
+FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(lfs_storage);
+
+static struct fs_mount_t lfs_mount = {
+    .type = FS_LITTLEFS,
+    .fs_data = &lfs_storage,
+    .storage_dev = (void *)FIXED_PARTITION_ID(storage_partition),
+    .mnt_point = "/lfs",
+};
+
+static uint8_t stream[TEST_FRAME_COUNT * (VBUS_FRAME_HEADER_SIZE + TEST_MAX_PAYLOAD)];
+static uint32_t stream_size;
+// Stream offset of every frame and of the end of the stream
+static uint32_t frame_offsets[TEST_FRAME_COUNT + 1];
+// Uptime at which each group of frames was captured
+static uint64_t group_ns[TEST_FRAME_COUNT / TEST_FRAMES_PER_GROUP];
+
+static struct vbus_capture capture;
+static uint8_t write_block[TEST_BLOCK_SIZE];
+
+static struct vbus_capture_reader reader;
+static uint8_t read_block[TEST_BLOCK_SIZE];
+static uint8_t ring_storage[2 * TEST_BLOCK_SIZE];
+static struct vbus_frame view_frames[8];
+
+struct replay_result {
+    uint32_t count;
+    int first;
+    bool in_order;
+    bool intact;
+};
+
+static uint32_t payload_size(uint32_t i)
+{
+    return 1 + (i * 7) % TEST_MAX_PAYLOAD;
+}
+
+// Frame i carries its index and the payload size in every byte
+static void build_stream(void)
+{
+    uint8_t payload[TEST_MAX_PAYLOAD];
+
+    stream_size = 0;
+    for (uint32_t i = 0; i < TEST_FRAME_COUNT; i++) {
+        struct vbus_frame frame = {.channel_idx = i % 4, .size = payload_size(i), .data = payload};
+        const struct vbus_frame *frame_ptr = &frame;
+        uint32_t encoded_size;
+
+        memset(payload, (uint8_t)i, frame.size);
+        zassert_ok(vbus_frame_encode_to_ver(VBUS_FRAME_V1, &frame_ptr, 1, &stream[stream_size],
+                                            sizeof(stream) - stream_size, &encoded_size));
+        frame_offsets[i] = stream_size;
+        stream_size += encoded_size;
+    }
+    frame_offsets[TEST_FRAME_COUNT] = stream_size;
+}
+
+static void on_frames(const struct vbus_frame *frames, uint32_t frame_count, void *user_data)
+{
+    struct replay_result *result = user_data;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        int index = frames[i].data[0];
+
+        if (result->count == 0) {
+            result->first = index;
+        } else if (index != (uint8_t)(result->first + result->count)) {
+            result->in_order = false;
+        }
+
+        if (frames[i].channel_idx != index % 4 || frames[i].size != payload_size(index) ||
+            frames[i].data[frames[i].size - 1] != (uint8_t)index) {
+            result->intact = false;
+        }
+        result->count++;
+    }
+}
+
+static int replay(struct replay_result *result)
+{
+    *result = (struct replay_result) {.first = -1, .in_order = true, .intact = true};
+    return vbus_capture_replay(&reader, on_frames, result);
+}
+
+static void open_reader(void)
+{
+    zassert_ok(vbus_capture_reader_open(&reader, TEST_PATH, read_block, sizeof(read_block),
+                                        ring_storage, sizeof(ring_storage), view_frames,
+                                        ARRAY_SIZE(view_frames)));
+}
+
+// Whole frames per write call, every group of frames a bit later than the last
+static void capture_frames(void)
+{
+    zassert_ok(vbus_capture_open(&capture, TEST_PATH, write_block, sizeof(write_block),
+                                 VBUS_FRAME_V1));
+    for (uint32_t i = 0; i < TEST_FRAME_COUNT; i++) {
+        if (i % TEST_FRAMES_PER_GROUP == 0) {
+            if (i > 0) {
+                k_sleep(K_MSEC(10));
+            }
+            group_ns[i / TEST_FRAMES_PER_GROUP] = k_ticks_to_ns_floor64(k_uptime_ticks());
+        }
+        zassert_ok(vbus_capture_write(&capture, &stream[frame_offsets[i]],
+                                      frame_offsets[i + 1] - frame_offsets[i], true));
+    }
+    zassert_ok(vbus_capture_close(&capture));
+}
+
+static void *capture_setup(void)
+{
+    zassert_ok(fs_mount(&lfs_mount));
+    build_stream();
+    return NULL;
+}
+
+static void capture_after(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    vbus_capture_reader_close(&reader);
+}
+
+ZTEST_SUITE(vbus_capture_tests, NULL, capture_setup, NULL, capture_after, NULL);
+
+ZTEST(vbus_capture_tests, test_replay_unaligned_chunks)
+{
+    struct replay_result result;
+
+    // Chunks cut anywhere, as taken straight from a receive ring
+    zassert_ok(vbus_capture_open(&capture, TEST_PATH, write_block, sizeof(write_block),
+                                 VBUS_FRAME_V1));
+    for (uint32_t offset = 0; offset < stream_size; offset += 37) {
+        zassert_ok(vbus_capture_write(&capture, &stream[offset], MIN(37, stream_size - offset),
+                                      offset == 0));
+    }
+    zassert_ok(vbus_capture_close(&capture));
+
+    open_reader();
+    zassert_equal(reader.block_count, DIV_ROUND_UP(stream_size, TEST_BLOCK_DATA));
+
+    // No frame is longer than a block, so every block has an entry point
+    for (uint32_t block_no = 0; block_no < reader.block_count; block_no++) {
+        struct vbus_capture_block_info info;
+
+        zassert_ok(vbus_capture_block_info(&reader, block_no, &info));
+        zassert_not_equal(info.frame_offset, VBUS_CAPTURE_NO_FRAME, "block %u", block_no);
+    }
+
+    zassert_equal(replay(&result), TEST_FRAME_COUNT);
+    zassert_equal(result.first, 0);
+    zassert_true(result.in_order);
+    zassert_true(result.intact);
+}
+
+ZTEST(vbus_capture_tests, test_block_headers)
+{
+    struct vbus_capture_block_info info;
+
+    capture_frames();
+    open_reader();
+
+    zassert_ok(vbus_capture_block_info(&reader, 0, &info));
+    zassert_equal(info.block_no, 0);
+    zassert_equal(info.used, TEST_BLOCK_DATA);
+    zassert_equal(info.stream_offset, 0);
+    zassert_equal(info.frame_offset, 0);
+
+    zassert_ok(vbus_capture_block_info(&reader, 1, &info));
+    zassert_equal(info.block_no, 1);
+    zassert_equal(info.stream_offset, TEST_BLOCK_DATA);
+    zassert_true(info.frame_offset < TEST_BLOCK_DATA);
+
+    // Only the last block is partial
+    zassert_ok(vbus_capture_block_info(&reader, reader.block_count - 1, &info));
+    zassert_equal(info.stream_offset + info.used, stream_size);
+    zassert_equal(vbus_capture_block_info(&reader, reader.block_count, &info), -ENOENT);
+}
+
+ZTEST(vbus_capture_tests, test_seek_offset)
+{
+    struct replay_result result;
+    const uint32_t target = 120;
+    int ret;
+
+    capture_frames();
+    open_reader();
+
+    zassert_ok(vbus_capture_seek_offset(&reader, frame_offsets[target]));
+    ret = replay(&result);
+    zassert_equal(ret, TEST_FRAME_COUNT - result.first);
+    zassert_true(result.in_order);
+    zassert_true(result.intact);
+    // Replay starts within the block holding the target frame
+    zassert_true(result.first <= target);
+    zassert_true(frame_offsets[result.first] + TEST_BLOCK_DATA > frame_offsets[target]);
+
+    // Seeking back replays again
+    zassert_ok(vbus_capture_seek_offset(&reader, 0));
+    zassert_equal(replay(&result), TEST_FRAME_COUNT);
+    zassert_equal(result.first, 0);
+}
+
+ZTEST(vbus_capture_tests, test_frame_after_large_write)
+{
+    struct vbus_capture_block_info info;
+    struct replay_result result;
+    uint8_t payload[100];
+    struct vbus_frame frames[] = {
+        {.channel_idx = 0, .size = sizeof(payload), .data = payload},
+        // Frame 3 of build_stream(), so on_frames() knows it
+        {.channel_idx = 3, .size = payload_size(3), .data = payload},
+    };
+    uint8_t data[2 * (VBUS_FRAME_HEADER_SIZE + sizeof(payload))];
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(frames); i++) {
+        const struct vbus_frame *frame_ptr = &frames[i];
+        uint32_t encoded_size;
+
+        memset(payload, i == 0 ? 0 : 3, sizeof(payload));
+        zassert_ok(vbus_frame_encode_to_ver(VBUS_FRAME_V1, &frame_ptr, 1, &data[size],
+                                            sizeof(data) - size, &encoded_size));
+        size += encoded_size;
+    }
+
+    // One write spanning two blocks, the second frame starts in the one its tail filled
+    zassert_ok(vbus_capture_open(&capture, TEST_PATH, write_block, sizeof(write_block),
+                                 VBUS_FRAME_V1));
+    zassert_ok(vbus_capture_write(&capture, data, size, true));
+    zassert_ok(vbus_capture_close(&capture));
+
+    open_reader();
+    zassert_equal(reader.block_count, 2);
+    zassert_ok(vbus_capture_block_info(&reader, 1, &info));
+    zassert_equal(info.frame_offset, VBUS_FRAME_HEADER_SIZE + sizeof(payload) - TEST_BLOCK_DATA);
+
+    zassert_ok(vbus_capture_seek_offset(&reader, VBUS_FRAME_HEADER_SIZE + sizeof(payload)));
+    zassert_equal(replay(&result), 1);
+    zassert_equal(result.first, 3);
+    zassert_true(result.intact);
+}
+
+ZTEST(vbus_capture_tests, test_seek_time)
+{
+    struct replay_result result;
+    const uint32_t group = 5;
+    const uint32_t target = group * TEST_FRAMES_PER_GROUP;
+    int ret;
+
+    capture_frames();
+    open_reader();
+
+    zassert_ok(vbus_capture_seek_time(&reader, group_ns[group]));
+    ret = replay(&result);
+    zassert_equal(ret, TEST_FRAME_COUNT - result.first);
+    zassert_true(result.in_order);
+    zassert_true(result.first <= target);
+    zassert_true(result.first > target - TEST_FRAMES_PER_GROUP);
+
+    zassert_ok(vbus_capture_seek_time(&reader, 0));
+    zassert_equal(replay(&result), TEST_FRAME_COUNT);
+}
+
+ZTEST(vbus_capture_tests, test_corrupted_blocks)
+{
+    struct replay_result result;
+    struct fs_file_t file;
+    uint32_t block_count;
+    uint8_t garbage = 0xEE;
+
+    capture_frames();
+    open_reader();
+    block_count = reader.block_count;
+    vbus_capture_reader_close(&reader);
+
+    // A torn last block is dropped
+    fs_file_t_init(&file);
+    zassert_ok(fs_open(&file, TEST_PATH, FS_O_RDWR));
+    zassert_ok(fs_seek(&file, BLOCK_DATA_POSITION(block_count - 1), FS_SEEK_SET));
+    zassert_equal(fs_write(&file, &garbage, 1), 1);
+    zassert_ok(fs_close(&file));
+
+    open_reader();
+    zassert_equal(reader.block_count, block_count - 1);
+    zassert_true(replay(&result) > 0);
+    zassert_true(result.intact);
+    vbus_capture_reader_close(&reader);
+
+    // One in the middle stops the replay
+    zassert_ok(fs_open(&file, TEST_PATH, FS_O_RDWR));
+    zassert_ok(fs_seek(&file, BLOCK_DATA_POSITION(3) + 8, FS_SEEK_SET));
+    zassert_equal(fs_write(&file, &garbage, 1), 1);
+    zassert_ok(fs_close(&file));
+
+    open_reader();
+    zassert_equal(replay(&result), -EBADMSG);
+    zassert_equal(reader.crc_errors, 1);
+}
+
+ZTEST(vbus_capture_tests, test_not_a_capture)
+{
+    struct fs_file_t file;
+
+    fs_file_t_init(&file);
+    fs_unlink(TEST_PATH);
+    zassert_ok(fs_open(&file, TEST_PATH, FS_O_CREATE | FS_O_WRITE));
+    zassert_equal(fs_write(&file, "not a capture log", 17), 17);
+    zassert_ok(fs_close(&file));
+
+    zassert_equal(vbus_capture_reader_open(&reader, TEST_PATH, read_block, sizeof(read_block),
+                                           ring_storage, sizeof(ring_storage), view_frames,
+                                           ARRAY_SIZE(view_frames)),
+                  -EBADMSG);
+}
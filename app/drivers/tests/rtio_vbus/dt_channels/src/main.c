@@ -0,0 +1,116 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <rtio_vbus/vbus_channel.h>
+#include <zephyr/logging/log.h>
+
+#define VBUS_NODE DT_NODELABEL(vbus0)
+#define ACCEL_NODE DT_NODELABEL(accel)
+#define BARO_NODE DT_NODELABEL(baro)
+
+LOG_MODULE_REGISTER(dt_channels_test, LOG_LEVEL_DBG);
+
+static const struct vbus_channel *const accel = VBUS_CHANNEL_DT_GET(ACCEL_NODE);
+static const struct vbus_channel *const baro = VBUS_CHANNEL_DT_GET(BARO_NODE);
+
+static void drain_queue(struct vbus_spsc_queue *queue)
+{
+    while (vbus_spsc_peek(queue)) {
+        vbus_spsc_release(queue);
+    }
+    queue->overflows = 0;
+    queue->oversized = 0;
+}
+
+static void before_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    drain_queue(accel->queue);
+    drain_queue(baro->queue);
+    VBUS_DEMUX_DT_GET(VBUS_NODE)->unrouted = 0;
+}
+
+ZTEST_SUITE(vbus_dt_channels_tests, NULL, NULL, before_each, NULL, NULL);
+
+ZTEST(vbus_dt_channels_tests, test_descriptors_from_devicetree)
+{
+    zassert_equal(accel->channel_idx, 2);
+    zassert_equal(accel->sample_format, VBUS_SAMPLE_S16);
+    zassert_equal(accel->frame_size, 12);
+    zassert_equal(accel->latency_budget_us, 2000);
+    zassert_equal(accel->queue->mask, 3);
+    zassert_equal(accel->queue->slot_size, 12);
+
+    zassert_equal(baro->channel_idx, 9);
+    zassert_equal(baro->sample_format, VBUS_SAMPLE_F32);
+    zassert_equal(baro->queue->mask, 1);
+    zassert_equal(baro->queue->slot_size, 8);
+}
+
+ZTEST(vbus_dt_channels_tests, test_table_lookup)
+{
+    const struct vbus_channel *const *table = VBUS_CHANNEL_TABLE_DT_GET(VBUS_NODE);
+
+    zassert_equal_ptr(table[2], accel);
+    zassert_equal_ptr(table[9], baro);
+    // Disabled channels get no descriptor
+    zassert_is_null(table[5]);
+    zassert_is_null(table[0]);
+    zassert_is_null(table[VBUS_DEMUX_CHANNEL_COUNT - 1]);
+}
+
+ZTEST(vbus_dt_channels_tests, test_min_latency_budget)
+{
+    zassert_equal(vbus_channel_min_latency_budget_us(VBUS_CHANNEL_TABLE_DT_GET(VBUS_NODE)), 500);
+}
+
+ZTEST(vbus_dt_channels_tests, test_dispatch_without_registration)
+{
+    struct vbus_demux *demux = VBUS_DEMUX_DT_GET(VBUS_NODE);
+    uint8_t accel_payload[] = {0x00, 0x10, 0xFF, 0xF0, 0x40, 0x00};
+    uint8_t baro_payload[] = {0x44, 0x7D, 0x00, 0x00};
+    struct vbus_frame frames[] = {
+        {.channel_idx = 2, .size = sizeof(accel_payload), .data = accel_payload},
+        {.channel_idx = 5, .size = sizeof(accel_payload), .data = accel_payload},
+        {.channel_idx = 9, .size = sizeof(baro_payload), .data = baro_payload},
+        {.channel_idx = 2, .size = sizeof(accel_payload), .data = accel_payload, .seq = 1},
+    };
+
+    zassert_equal(vbus_demux_dispatch(demux, frames, ARRAY_SIZE(frames)), 3);
+    zassert_equal(demux->unrouted, 1);
+    zassert_equal(vbus_spsc_count(accel->queue), 2);
+    zassert_equal(vbus_spsc_count(baro->queue), 1);
+
+    const struct vbus_frame *out = vbus_spsc_peek(baro->queue);
+    zassert_not_null(out);
+    zassert_equal(out->channel_idx, 9);
+    zassert_mem_equal(out->data, baro_payload, sizeof(baro_payload));
+    vbus_spsc_release(baro->queue);
+
+    out = vbus_spsc_peek(accel->queue);
+    zassert_not_null(out);
+    zassert_equal(out->seq, 0);
+    vbus_spsc_release(accel->queue);
+    out = vbus_spsc_peek(accel->queue);
+    zassert_not_null(out);
+    zassert_equal(out->seq, 1);
+    vbus_spsc_release(accel->queue);
+}
+
+ZTEST(vbus_dt_channels_tests, test_queue_sized_from_devicetree)
+{
+    struct vbus_demux *demux = VBUS_DEMUX_DT_GET(VBUS_NODE);
+    uint8_t payload[12] = {0};
+    struct vbus_frame big = {.channel_idx = 9, .size = 12, .data = payload};
+    struct vbus_frame fits = {.channel_idx = 9, .size = 8, .data = payload};
+
+    zassert_equal(vbus_demux_dispatch(demux, &big, 1), 0);
+    zassert_equal(baro->queue->oversized, 1);
+
+    // Depth 2
+    zassert_equal(vbus_demux_dispatch(demux, &fits, 1), 1);
+    zassert_equal(vbus_demux_dispatch(demux, &fits, 1), 1);
+    zassert_equal(vbus_demux_dispatch(demux, &fits, 1), 0);
+    zassert_equal(baro->queue->overflows, 1);
+}
@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <rtio_vbus/flow_ctrl.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/uart_rx.h>
+#include <vbus_host/flow.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_RING_SIZE 64
+#define TEST_THRESHOLD 16
+#define TEST_PAYLOAD_SIZE 16
+#define TEST_FRAME_COUNT 100
+#define TEST_FRAME_SIZE (VBUS_FRAME_HEADER_SIZE + TEST_PAYLOAD_SIZE)
+
+LOG_MODULE_REGISTER(flow_ctrl_test, LOG_LEVEL_DBG);
+
+BUILD_ASSERT(VBUS_FLOW_CHANNEL == VBUS_HOST_FLOW_CHANNEL);
+BUILD_ASSERT(VBUS_FLOW_CREDIT_SIZE == VBUS_HOST_FLOW_CREDIT_SIZE);
+
+static const struct device *const test_uart = DEVICE_DT_GET(DT_NODELABEL(euart0));
+
+static uint8_t test_ring_buffer[TEST_RING_SIZE];
+static struct vbus_uart_rx test_rx;
+
+static uint8_t payload_storage[TEST_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+static uint32_t received_count;
+static uint32_t sequence_errors;
+static uint32_t ring_fill_max;
+
+static uint8_t stream[TEST_FRAME_COUNT * TEST_FRAME_SIZE];
+
+static void on_frame(const struct vbus_frame *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (frame->size != TEST_PAYLOAD_SIZE || frame->data[0] != (uint8_t)received_count) {
+        sequence_errors++;
+    }
+    received_count++;
+}
+
+// Drains far slower than the host can fill the ring
+static void slow_handler(struct vbus_uart_rx *rx, struct ring_buf *buffer)
+{
+    ARG_UNUSED(rx);
+
+    ring_fill_max = MAX(ring_fill_max, ring_buf_size_get(buffer));
+    vbus_frame_decoder_feed_ring(&decoder, buffer);
+    k_sleep(K_MSEC(1));
+}
+
+static void start_rx(k_timeout_t refresh)
+{
+    zassert_ok(vbus_uart_rx_init(&test_rx, test_uart, test_ring_buffer, sizeof(test_ring_buffer),
+                                 1, K_MSEC(1), slow_handler, NULL));
+    zassert_ok(vbus_uart_rx_set_flow_ctrl(&test_rx, TEST_THRESHOLD, refresh));
+    zassert_ok(vbus_uart_rx_start(&test_rx));
+}
+
+static void before_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    received_count = 0;
+    sequence_errors = 0;
+    ring_fill_max = 0;
+    vbus_frame_decoder_init(&decoder, payload_storage, sizeof(payload_storage), on_frame, NULL);
+    uart_emul_flush_tx_data(test_uart);
+}
+
+static void after_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    vbus_uart_rx_stop(&test_rx);
+}
+
+ZTEST_SUITE(vbus_flow_ctrl_tests, NULL, NULL, before_each, after_each, NULL);
+
+ZTEST(vbus_flow_ctrl_tests, test_first_credit_grants_the_ring)
+{
+    uint8_t credit[2 * VBUS_FLOW_CREDIT_FRAME_SIZE];
+
+    start_rx(K_FOREVER);
+    k_sleep(K_MSEC(10));
+
+    zassert_equal(uart_emul_get_tx_data(test_uart, credit, sizeof(credit)),
+                  VBUS_FLOW_CREDIT_FRAME_SIZE);
+    zassert_equal(credit[0], VBUS_FLOW_CHANNEL);
+    zassert_equal(sys_get_be16(&credit[1]), VBUS_FLOW_CREDIT_SIZE);
+    zassert_equal(sys_get_be32(&credit[3]), 0);
+    zassert_equal(sys_get_be32(&credit[7]), TEST_RING_SIZE);
+    zassert_equal(test_rx.credits, 1);
+
+    // Settings cannot change while running
+    zassert_equal(vbus_uart_rx_set_flow_ctrl(&test_rx, 1, K_FOREVER), -EBUSY);
+}
+
+ZTEST(vbus_flow_ctrl_tests, test_credit_is_refreshed)
+{
+    struct vbus_host_flow host;
+    uint8_t credits[8 * VBUS_FLOW_CREDIT_FRAME_SIZE];
+
+    // A host that opens the port late still learns its window
+    start_rx(K_MSEC(20));
+    k_sleep(K_MSEC(70));
+
+    vbus_host_flow_init(&host);
+    uint32_t size = uart_emul_get_tx_data(test_uart, credits, sizeof(credits));
+    zassert_true(vbus_host_flow_feed(&host, credits, size) >= 3);
+    zassert_equal(vbus_host_flow_window(&host), TEST_RING_SIZE);
+}
+
+ZTEST(vbus_flow_ctrl_tests, test_slow_consumer_end_to_end)
+{
+    struct vbus_host_flow host;
+    uint32_t sent = 0;
+    int64_t deadline = k_uptime_get() + 5000;
+
+    for (uint32_t i = 0; i < TEST_FRAME_COUNT; i++) {
+        uint8_t *frame = &stream[i * TEST_FRAME_SIZE];
+
+        frame[0] = i % 4;
+        sys_put_be16(TEST_PAYLOAD_SIZE, &frame[1]);
+        memset(&frame[VBUS_FRAME_HEADER_SIZE], i, TEST_PAYLOAD_SIZE);
+    }
+
+    vbus_host_flow_init(&host);
+    start_rx(K_MSEC(100));
+
+    // The host sends as fast as its window allows, the stream is 30 times
+    // the ring size
+    while (sent < sizeof(stream) && k_uptime_get() < deadline) {
+        uint8_t rx[64];
+        uint32_t size = uart_emul_get_tx_data(test_uart, rx, sizeof(rx));
+
+        vbus_host_flow_feed(&host, rx, size);
+
+        uint32_t window = MIN(vbus_host_flow_window(&host), sizeof(stream) - sent);
+        if (window == 0) {
+            k_sleep(K_USEC(200));
+            continue;
+        }
+
+        uint32_t put = uart_emul_put_rx_data(test_uart, &stream[sent], window);
+        vbus_host_flow_sent(&host, put);
+        sent += put;
+    }
+
+    zassert_equal(sent, sizeof(stream), "host stalled");
+    while (received_count < TEST_FRAME_COUNT && k_uptime_get() < deadline) {
+        k_sleep(K_MSEC(1));
+    }
+
+    zassert_equal(received_count, TEST_FRAME_COUNT);
+    zassert_equal(sequence_errors, 0);
+    zassert_equal(decoder.dropped_frames, 0);
+    // The ring was never full with bytes waiting, so the RX interrupt
+    // never had to be paused
+    zassert_equal(atomic_get(&test_rx.pauses), 0);
+    zassert_true(ring_fill_max <= TEST_RING_SIZE);
+    zassert_true(test_rx.credits > sizeof(stream) / TEST_RING_SIZE);
+}
@@ -0,0 +1,198 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <rtio_vbus/frame_bus.h>
+#include <zephyr/logging/log.h>
+
+#define BUF_COUNT CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_BUS_BUF_COUNT
+#define BUF_SIZE CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_BUS_BUF_SIZE
+#define KEEP_MAX BUF_COUNT
+
+LOG_MODULE_REGISTER(frame_bus_test, LOG_LEVEL_DBG);
+
+// Frames kept by a listener past its callback, as a consumer thread would
+struct keeper {
+    struct vbus_frame_msg msgs[KEEP_MAX];
+    uint32_t count;
+};
+
+static struct keeper fusion;
+static struct keeper logger;
+
+static void keep(struct keeper *keeper, const struct zbus_channel *chan)
+{
+    if (keeper->count < KEEP_MAX) {
+        vbus_frame_msg_ref(&keeper->msgs[keeper->count++], zbus_chan_const_msg(chan));
+    }
+}
+
+static void drop_all(struct keeper *keeper)
+{
+    for (uint32_t i = 0; i < keeper->count; i++) {
+        vbus_frame_msg_unref(&keeper->msgs[i]);
+    }
+    keeper->count = 0;
+}
+
+static void fusion_cb(const struct zbus_channel *chan)
+{
+    keep(&fusion, chan);
+}
+
+static void logger_cb(const struct zbus_channel *chan)
+{
+    keep(&logger, chan);
+}
+
+ZBUS_LISTENER_DEFINE(fusion_lis, fusion_cb);
+ZBUS_LISTENER_DEFINE(logger_lis, logger_cb);
+#define MONITOR_QUEUE_SIZE 4
+ZBUS_SUBSCRIBER_DEFINE(monitor_sub, MONITOR_QUEUE_SIZE);
+
+VBUS_FRAME_CHAN_DEFINE(accel_chan, fusion_lis, logger_lis, monitor_sub);
+VBUS_FRAME_CHAN_DEFINE(baro_chan, logger_lis);
+
+static struct vbus_frame_bus test_bus;
+
+static void before_each(void *fixture)
+{
+    const struct zbus_channel *chan;
+
+    ARG_UNUSED(fixture);
+
+    drop_all(&fusion);
+    drop_all(&logger);
+    zassert_ok(vbus_frame_bus_clear(&accel_chan, K_NO_WAIT));
+    zassert_ok(vbus_frame_bus_clear(&baro_chan, K_NO_WAIT));
+    while (zbus_sub_wait(&monitor_sub, &chan, K_NO_WAIT) == 0) {
+    }
+    vbus_frame_bus_init(&test_bus);
+}
+
+ZTEST_SUITE(vbus_frame_bus_tests, NULL, NULL, before_each, NULL, NULL);
+
+ZTEST(vbus_frame_bus_tests, test_fan_out_shares_payload)
+{
+    uint8_t payload[] = {0x00, 0x10, 0xFF, 0xF0, 0x40, 0x00};
+    struct vbus_frame frame = {.channel_idx = 2, .size = sizeof(payload), .data = payload,
+                               .seq = 7};
+    const struct zbus_channel *chan;
+    struct vbus_frame_msg monitor;
+
+    zassert_ok(vbus_frame_bus_publish(&accel_chan, &frame, K_NO_WAIT));
+    payload[0] = 0xAA;
+
+    // One buffer, seen by both listeners
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT - 1);
+    zassert_equal(fusion.count, 1);
+    zassert_equal(logger.count, 1);
+    zassert_equal_ptr(fusion.msgs[0].buf, logger.msgs[0].buf);
+    zassert_equal_ptr(fusion.msgs[0].frame.data, logger.msgs[0].frame.data);
+    zassert_equal(fusion.msgs[0].frame.seq, 7);
+    zassert_equal(fusion.msgs[0].frame.size, sizeof(payload));
+    zassert_equal(fusion.msgs[0].frame.data[0], 0x00);
+    zassert_mem_equal(&fusion.msgs[0].frame.data[1], &payload[1], sizeof(payload) - 1);
+
+    // and by the subscriber once it gets to run
+    zassert_ok(zbus_sub_wait(&monitor_sub, &chan, K_NO_WAIT));
+    zassert_equal_ptr(chan, &accel_chan);
+    zassert_ok(vbus_frame_bus_read(chan, &monitor, K_NO_WAIT));
+    zassert_equal_ptr(monitor.buf, fusion.msgs[0].buf);
+
+    // The buffer returns with the last reference, the channel holds one
+    drop_all(&fusion);
+    drop_all(&logger);
+    vbus_frame_msg_unref(&monitor);
+    zassert_is_null(monitor.buf);
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT - 1);
+    zassert_ok(vbus_frame_bus_clear(&accel_chan, K_NO_WAIT));
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT);
+}
+
+ZTEST(vbus_frame_bus_tests, test_publish_replaces_channel_reference)
+{
+    uint8_t payload[] = {1, 2, 3, 4};
+    struct vbus_frame frame = {.channel_idx = 9, .size = sizeof(payload), .data = payload};
+
+    zassert_ok(vbus_frame_bus_publish(&baro_chan, &frame, K_NO_WAIT));
+    zassert_ok(vbus_frame_bus_publish(&baro_chan, &frame, K_NO_WAIT));
+    zassert_equal(logger.count, 2);
+    zassert_not_equal(logger.msgs[0].buf, logger.msgs[1].buf);
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT - 2);
+
+    // The channel let go of the first frame, the logger still has both
+    vbus_frame_msg_unref(&logger.msgs[0]);
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT - 1);
+    vbus_frame_msg_unref(&logger.msgs[1]);
+    zassert_equal(vbus_frame_buf_num_free(), BUF_COUNT - 1);
+}
+
+ZTEST(vbus_frame_bus_tests, test_pool_exhaustion)
+{
+    uint8_t payload[BUF_SIZE + 1] = {0};
+    struct vbus_frame frame = {.channel_idx = 9, .size = 4, .data = payload};
+    struct vbus_frame empty = {.channel_idx = 9};
+
+    for (uint32_t i = 0; i < BUF_COUNT; i++) {
+        zassert_ok(vbus_frame_bus_publish(&baro_chan, &frame, K_NO_WAIT));
+    }
+    zassert_equal(vbus_frame_bus_publish(&baro_chan, &frame, K_NO_WAIT), -ENOMEM);
+    zassert_equal(logger.count, BUF_COUNT);
+
+    frame.size = sizeof(payload);
+    zassert_equal(vbus_frame_bus_publish(&baro_chan, &frame, K_NO_WAIT), -EMSGSIZE);
+
+    drop_all(&logger);
+    zassert_ok(vbus_frame_bus_publish(&baro_chan, &empty, K_NO_WAIT));
+    zassert_equal(logger.msgs[0].frame.size, 0);
+    zassert_is_null(logger.msgs[0].frame.data);
+}
+
+ZTEST(vbus_frame_bus_tests, test_dispatch)
+{
+    uint8_t accel_payload[] = {0x00, 0x10, 0xFF, 0xF0, 0x40, 0x00};
+    uint8_t baro_payload[] = {0x44, 0x7D, 0x00, 0x00};
+    uint8_t big_payload[BUF_SIZE + 1] = {0};
+    struct vbus_frame frames[] = {
+        {.channel_idx = 2, .size = sizeof(accel_payload), .data = accel_payload},
+        {.channel_idx = 5, .size = sizeof(accel_payload), .data = accel_payload},
+        {.channel_idx = 9, .size = sizeof(baro_payload), .data = baro_payload},
+        {.channel_idx = 9, .size = sizeof(big_payload), .data = big_payload},
+    };
+
+    zassert_ok(vbus_frame_bus_register(&test_bus, 2, &accel_chan));
+    zassert_ok(vbus_frame_bus_register(&test_bus, 9, &baro_chan));
+    zassert_equal(vbus_frame_bus_register(&test_bus, 9, &accel_chan), -EALREADY);
+
+    zassert_equal(vbus_frame_bus_dispatch(&test_bus, frames, ARRAY_SIZE(frames), K_NO_WAIT), 2);
+    zassert_equal(test_bus.unrouted, 1);
+    zassert_equal(test_bus.dropped, 1);
+
+    zassert_equal(fusion.count, 1);
+    zassert_equal(fusion.msgs[0].frame.channel_idx, 2);
+    zassert_equal(logger.count, 2);
+    zassert_equal(logger.msgs[1].frame.channel_idx, 9);
+    zassert_mem_equal(logger.msgs[1].frame.data, baro_payload, sizeof(baro_payload));
+}
+
+ZTEST(vbus_frame_bus_tests, test_dispatch_unnotified)
+{
+    uint8_t payload[] = {1, 2, 3, 4};
+    struct vbus_frame frame = {.channel_idx = 2, .size = sizeof(payload), .data = payload};
+
+    zassert_ok(vbus_frame_bus_register(&test_bus, 2, &accel_chan));
+
+    // The monitor never gets to run, its queue fills up
+    for (uint32_t i = 0; i < MONITOR_QUEUE_SIZE; i++) {
+        zassert_equal(vbus_frame_bus_dispatch(&test_bus, &frame, 1, K_NO_WAIT), 1);
+        drop_all(&fusion);
+        drop_all(&logger);
+    }
+
+    // Stored and seen by the listeners, so published but not dropped
+    zassert_equal(vbus_frame_bus_dispatch(&test_bus, &frame, 1, K_NO_WAIT), 1);
+    zassert_equal(test_bus.dropped, 0);
+    zassert_equal(test_bus.unnotified, 1);
+    zassert_equal(fusion.count, 1);
+    zassert_equal(logger.count, 1);
+}
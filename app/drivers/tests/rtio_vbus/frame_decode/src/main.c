@@ -60,6 +60,7 @@ ZTEST(vbus_frame_tests, test_decode_single_frame_with_data)
             if (frames[i]->data) {
                 k_free(frames[i]->data);
             }
+            k_free(frames[i]);
         }
         k_free(frames);
     }
@@ -99,4 +100,167 @@ ZTEST(vbus_frame_tests, test_decode_incomplete_frame) {
     zassert_mem_equal(frames[0]->data, "HELLO_WORLD\0", FRAME_SIZE);
 
     LOG_INF("Received data: %s", frames[0]->data);
-}
\ No newline at end of file
+
+    k_free(frames[0]->data);
+    k_free(frames[0]);
+    k_free(frames);
+}
+
+ZTEST(vbus_frame_tests, test_decode_view_zero_copy)
+{
+    setup_test_buffer();
+
+    uint8_t test_data[] = {0x03, 0x00, 0x02, 'H', 'I', 0x04, 0x00, 0x00, 0x05, 0x00, 0x03, 'A'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame frames[4];
+    struct vbus_frame_view view;
+    vbus_frame_view_init(&view, &test_buf, frames, ARRAY_SIZE(frames));
+
+    int ret = vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf));
+
+    zassert_equal(ret, 0);
+    zassert_equal(view.frame_count, 2);
+    zassert_equal(frames[0].channel_idx, 3);
+    zassert_equal(frames[0].size, 2);
+    // payload is referenced in place, not copied
+    zassert_equal(frames[0].data, &test_ring_buffer[3]);
+    zassert_mem_equal(frames[0].data, "HI", 2);
+    zassert_equal(frames[1].channel_idx, 4);
+    zassert_equal(frames[1].size, 0);
+    zassert_is_null(frames[1].data);
+
+    // a second decode before release must be refused
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), -EBUSY);
+
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    // the incomplete trailing frame is left in the buffer
+    zassert_equal(ring_buf_size_get(&test_buf), 4);
+
+    uint8_t test_data2[] = {'B', 'C'};
+    ring_buf_put(&test_buf, test_data2, sizeof(test_data2));
+
+    ret = vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf));
+
+    zassert_equal(ret, 0);
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(frames[0].channel_idx, 5);
+    zassert_mem_equal(frames[0].data, "ABC", 3);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+}
+
+ZTEST(vbus_frame_tests, test_decode_view_frame_capacity)
+{
+    setup_test_buffer();
+
+    uint8_t test_data[] = {0x01, 0x00, 0x01, 'X', 0x02, 0x00, 0x01, 'Y'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame frames[1];
+    struct vbus_frame_view view;
+    vbus_frame_view_init(&view, &test_buf, frames, ARRAY_SIZE(frames));
+
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), 0);
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(frames[0].channel_idx, 1);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), 0);
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(frames[0].channel_idx, 2);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+}
+
+/* Move the ring buffer read/write position so that the next put starts
+ * `tail_space` bytes before the end of the backing array. */
+static void setup_test_buffer_near_wrap(uint32_t tail_space)
+{
+    setup_test_buffer();
+
+    uint8_t filler[TEST_BUFFER_SIZE];
+    uint32_t filler_size = TEST_BUFFER_SIZE - tail_space;
+    memset(filler, 0, sizeof(filler));
+    ring_buf_put(&test_buf, filler, filler_size);
+    ring_buf_get(&test_buf, NULL, filler_size);
+}
+
+ZTEST(vbus_frame_tests, test_decode_wrapped_frames)
+{
+    // header and payload of the second frame straddle the wrap point
+    setup_test_buffer_near_wrap(6);
+
+    uint8_t test_data[] = {0x01, 0x00, 0x01, 'A', 0x02, 0x00, 0x04, 'W', 'R', 'A', 'P',
+                           0x03, 0x00, 0x02, 'O', 'K'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame **frames = NULL;
+    uint32_t frame_count = 0;
+
+    int ret = vbus_frame_decode(&test_buf, ring_buf_size_get(&test_buf), &frames, &frame_count);
+
+    zassert_equal(ret, 0);
+    zassert_equal(frame_count, 3);
+    zassert_equal(frames[1]->channel_idx, 2);
+    zassert_equal(frames[1]->size, 4);
+    zassert_mem_equal(frames[1]->data, "WRAP", 4);
+    zassert_equal(frames[2]->channel_idx, 3);
+    zassert_mem_equal(frames[2]->data, "OK", 2);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        k_free(frames[i]->data);
+        k_free(frames[i]);
+    }
+    k_free(frames);
+}
+
+ZTEST(vbus_frame_tests, test_decode_view_wrapped_frames)
+{
+    // the header of the first frame straddles the wrap point, its payload does not
+    setup_test_buffer_near_wrap(2);
+
+    uint8_t test_data[] = {0x01, 0x00, 0x02, 'H', 'I', 0x02, 0x00, 0x03, 'A', 'B', 'C'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame frames[4];
+    struct vbus_frame_view view;
+    vbus_frame_view_init(&view, &test_buf, frames, ARRAY_SIZE(frames));
+
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), 0);
+    zassert_equal(view.frame_count, 2);
+    zassert_equal(frames[0].data, &test_ring_buffer[1]);
+    zassert_mem_equal(frames[0].data, "HI", 2);
+    zassert_mem_equal(frames[1].data, "ABC", 3);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+
+    // the payload straddles the wrap point: needs the bounce buffer
+    setup_test_buffer_near_wrap(5);
+    uint8_t test_data2[] = {0x04, 0x00, 0x05, 'S', 'P', 'L', 'I', 'T', 0x05, 0x00, 0x01, 'X'};
+    ring_buf_put(&test_buf, test_data2, sizeof(test_data2));
+
+    // without one the frame is dropped instead of stalling the stream
+    vbus_frame_view_init(&view, &test_buf, frames, ARRAY_SIZE(frames));
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), 0);
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(view.oversized, 1);
+    zassert_mem_equal(frames[0].data, "X", 1);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+
+    setup_test_buffer_near_wrap(5);
+    ring_buf_put(&test_buf, test_data2, sizeof(test_data2));
+
+    uint8_t bounce[8];
+    vbus_frame_view_set_bounce(&view, bounce, sizeof(bounce));
+    zassert_equal(vbus_frame_decode_view(&view, ring_buf_size_get(&test_buf)), 0);
+    zassert_equal(view.frame_count, 2);
+    zassert_equal(frames[0].data, bounce);
+    zassert_mem_equal(frames[0].data, "SPLIT", 5);
+    zassert_equal(frames[1].data, &test_ring_buffer[6]);
+    zassert_mem_equal(frames[1].data, "X", 1);
+    zassert_equal(vbus_frame_view_release(&view), 0);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+}
@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <rtio_vbus/frame_demux.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(frame_demux_test, LOG_LEVEL_DBG);
+
+VBUS_SPSC_QUEUE_DEFINE(test_queue_a, 4, 8);
+VBUS_SPSC_QUEUE_DEFINE(test_queue_b, 2, 4);
+
+static struct vbus_demux test_demux;
+
+static void drain_queue(struct vbus_spsc_queue *queue)
+{
+    while (vbus_spsc_peek(queue)) {
+        vbus_spsc_release(queue);
+    }
+    queue->overflows = 0;
+    queue->oversized = 0;
+}
+
+static void before_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    drain_queue(&test_queue_a);
+    drain_queue(&test_queue_b);
+    vbus_demux_init(&test_demux);
+}
+
+ZTEST_SUITE(vbus_frame_demux_tests, NULL, NULL, before_each, NULL, NULL);
+
+ZTEST(vbus_frame_demux_tests, test_queue_alignment)
+{
+    zassert_equal((uintptr_t)&test_queue_a % VBUS_CACHE_LINE_SIZE, 0);
+    zassert_equal((uintptr_t)&test_queue_a.tail % VBUS_CACHE_LINE_SIZE, 0);
+    zassert_true((uintptr_t)&test_queue_a.tail - (uintptr_t)&test_queue_a.head >=
+                 VBUS_CACHE_LINE_SIZE);
+}
+
+ZTEST(vbus_frame_demux_tests, test_queue_fifo_and_overflow)
+{
+    uint8_t payload[] = {'Q', 0};
+    struct vbus_frame frame = {.channel_idx = 1, .size = 2, .data = payload};
+
+    for (uint8_t i = 0; i < 4; i++) {
+        payload[1] = i;
+        zassert_equal(vbus_spsc_push(&test_queue_a, &frame), 0);
+    }
+    zassert_equal(vbus_spsc_push(&test_queue_a, &frame), -ENOBUFS);
+    zassert_equal(test_queue_a.overflows, 1);
+    zassert_equal(vbus_spsc_count(&test_queue_a), 4);
+
+    // slots own their payload copy
+    payload[1] = 0xFF;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        const struct vbus_frame *out = vbus_spsc_peek(&test_queue_a);
+        zassert_not_null(out);
+        zassert_equal(out->size, 2);
+        zassert_equal(out->data[0], 'Q');
+        zassert_equal(out->data[1], i);
+        vbus_spsc_release(&test_queue_a);
+    }
+    zassert_is_null(vbus_spsc_peek(&test_queue_a));
+
+    uint8_t large[9] = {0};
+    struct vbus_frame large_frame = {.channel_idx = 1, .size = sizeof(large), .data = large};
+    zassert_equal(vbus_spsc_push(&test_queue_a, &large_frame), -EMSGSIZE);
+    zassert_equal(test_queue_a.oversized, 1);
+}
+
+ZTEST(vbus_frame_demux_tests, test_demux_routes_by_channel)
+{
+    zassert_equal(vbus_demux_register(&test_demux, 3, &test_queue_a), 0);
+    zassert_equal(vbus_demux_register(&test_demux, 200, &test_queue_b), 0);
+    zassert_equal(vbus_demux_register(&test_demux, 3, &test_queue_b), -EALREADY);
+
+    uint8_t a[] = {'A'};
+    uint8_t b[] = {'B', 'B'};
+    struct vbus_frame frames[] = {
+        {.channel_idx = 3, .size = 1, .data = a},
+        {.channel_idx = 200, .size = 2, .data = b},
+        {.channel_idx = 7, .size = 1, .data = a},
+        {.channel_idx = 200, .size = 0, .data = NULL},
+        {.channel_idx = 200, .size = 1, .data = a},
+    };
+
+    zassert_equal(vbus_demux_dispatch(&test_demux, frames, ARRAY_SIZE(frames)), 3);
+    zassert_equal(test_demux.unrouted, 1);
+    zassert_equal(test_queue_b.overflows, 1);
+
+    const struct vbus_frame *out = vbus_spsc_peek(&test_queue_a);
+    zassert_not_null(out);
+    zassert_equal(out->channel_idx, 3);
+    zassert_mem_equal(out->data, "A", 1);
+
+    out = vbus_spsc_peek(&test_queue_b);
+    zassert_not_null(out);
+    zassert_mem_equal(out->data, "BB", 2);
+    vbus_spsc_release(&test_queue_b);
+
+    out = vbus_spsc_peek(&test_queue_b);
+    zassert_not_null(out);
+    zassert_equal(out->size, 0);
+}
@@ -104,3 +104,72 @@ ZTEST(vbus_frame_tests, test_encode_multiple_frames) {
         offset += frame->size + 3;
     }
 }
+
+ZTEST(vbus_frame_tests, test_encode_to_caller_buffer)
+{
+    uint8_t data1[] = {'A', 'B'};
+    uint8_t data2[] = {'C'};
+    struct vbus_frame frame1 = {.channel_idx = 1, .size = 2, .data = data1};
+    struct vbus_frame frame2 = {.channel_idx = 2, .size = 1, .data = data2};
+    const struct vbus_frame *frames[] = {&frame1, &frame2};
+    uint32_t buf_size = 0;
+
+    // size query mode
+    zassert_equal(vbus_frame_encode_to(frames, 2, NULL, 0, &buf_size), 0);
+    zassert_equal(buf_size, 9);
+
+    // too small buffer is left untouched
+    uint8_t small[8];
+    memset(small, 0xEE, sizeof(small));
+    zassert_equal(vbus_frame_encode_to(frames, 2, small, sizeof(small), &buf_size), -ENOBUFS);
+    zassert_equal(small[0], 0xEE);
+
+    uint8_t buffer[16];
+    zassert_equal(vbus_frame_encode_to(frames, 2, buffer, sizeof(buffer), &buf_size), 0);
+    zassert_equal(buf_size, 9);
+
+    uint8_t expected[] = {0x01, 0x00, 0x02, 'A', 'B', 0x02, 0x00, 0x01, 'C'};
+    zassert_mem_equal(buffer, expected, sizeof(expected));
+}
+
+ZTEST(vbus_frame_tests, test_encode_rejects_oversized_frame)
+{
+    uint8_t data[1];
+    struct vbus_frame frame = {.channel_idx = 1, .size = 0x10000, .data = data};
+    const struct vbus_frame *frames[] = {&frame};
+    uint8_t *buf_ptr = NULL;
+    uint32_t buf_size = 0;
+
+    // validation happens before anything is allocated
+    zassert_equal(vbus_frame_encode(frames, 1, &buf_ptr, &buf_size), -EINVAL);
+    zassert_is_null(buf_ptr);
+}
+
+ZTEST(vbus_frame_tests, test_encode_ring_wraps)
+{
+    uint8_t ring_storage[16];
+    struct ring_buf ring;
+    ring_buf_init(&ring, sizeof(ring_storage), ring_storage);
+
+    // move the ring position close to the end so the frame wraps
+    uint8_t filler[14] = {0};
+    uint8_t drain[14];
+    ring_buf_put(&ring, filler, sizeof(filler));
+    ring_buf_get(&ring, drain, sizeof(drain));
+
+    uint8_t data[] = {'W', 'R', 'A', 'P'};
+    struct vbus_frame frame = {.channel_idx = 9, .size = 4, .data = data};
+    const struct vbus_frame *frames[] = {&frame, &frame};
+
+    zassert_equal(vbus_frame_encode_ring(frames, 1, &ring), 0);
+    zassert_equal(ring_buf_size_get(&ring), 7);
+
+    // a second frame does not fit, nothing is committed
+    zassert_equal(vbus_frame_encode_ring(frames, 2, &ring), -ENOBUFS);
+    zassert_equal(ring_buf_size_get(&ring), 7);
+
+    uint8_t out[7];
+    uint8_t expected[] = {0x09, 0x00, 0x04, 'W', 'R', 'A', 'P'};
+    zassert_equal(ring_buf_get(&ring, out, sizeof(out)), 7);
+    zassert_mem_equal(out, expected, sizeof(expected));
+}
@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/frame_pool.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_BUFFER_SIZE 256
+
+LOG_MODULE_REGISTER(frame_pool_test, LOG_LEVEL_DBG);
+
+static uint8_t test_ring_buffer[TEST_BUFFER_SIZE];
+static struct ring_buf test_buf;
+
+static void setup_test_buffer(void)
+{
+    ring_buf_init(&test_buf, TEST_BUFFER_SIZE, test_ring_buffer);
+}
+
+ZTEST_SUITE(vbus_frame_pool_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(vbus_frame_pool_tests, test_decode_batch_single_block)
+{
+    setup_test_buffer();
+
+    uint8_t test_data[] = {0x01, 0x00, 0x03, 'A', 'B', 'C', 0x02, 0x00, 0x00,
+                           0x03, 0x00, 0x02, 'D', 'E', 0x04, 0x00, 0x05, 'F'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    uint32_t free_blocks = vbus_frame_pool_num_free();
+    struct vbus_frame_batch batch;
+
+    int ret = vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &batch, K_NO_WAIT);
+
+    zassert_equal(ret, 0);
+    zassert_equal(batch.frame_count, 3);
+    zassert_not_null(batch.block);
+    zassert_equal(vbus_frame_pool_num_free(), free_blocks - 1);
+
+    zassert_equal(batch.frames[0].channel_idx, 1);
+    zassert_mem_equal(batch.frames[0].data, "ABC", 3);
+    zassert_equal(batch.frames[1].channel_idx, 2);
+    zassert_equal(batch.frames[1].size, 0);
+    zassert_is_null(batch.frames[1].data);
+    zassert_equal(batch.frames[2].channel_idx, 3);
+    zassert_mem_equal(batch.frames[2].data, "DE", 2);
+
+    // descriptors and payloads come from the same block
+    for (uint32_t i = 0; i < batch.frame_count; i++) {
+        if (batch.frames[i].data) {
+            zassert_true(batch.frames[i].data > (uint8_t *)batch.block);
+            zassert_true(batch.frames[i].data <
+                         (uint8_t *)batch.block + CONFIG_APP_DRIVERS_RTIO_VBUS_FRAME_POOL_BLOCK_SIZE);
+        }
+    }
+
+    // the incomplete frame stays in the ring buffer
+    zassert_equal(ring_buf_size_get(&test_buf), 4);
+
+    vbus_frame_batch_free(&batch);
+    zassert_is_null(batch.block);
+    zassert_equal(vbus_frame_pool_num_free(), free_blocks);
+}
+
+ZTEST(vbus_frame_pool_tests, test_decode_batch_splits_on_block_full)
+{
+    setup_test_buffer();
+
+    uint8_t frame[3 + 60] = {0x07, 0x00, 60};
+    memset(&frame[3], 0xAA, 60);
+    for (int i = 0; i < 3; i++) {
+        ring_buf_put(&test_buf, frame, sizeof(frame));
+    }
+
+    struct vbus_frame_batch first;
+    struct vbus_frame_batch second;
+
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &first, K_NO_WAIT), 0);
+    zassert_true(first.frame_count >= 1 && first.frame_count < 3);
+
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &second, K_NO_WAIT), 0);
+    zassert_true(second.frame_count >= 1);
+
+    // pool is exhausted while both batches are held
+    struct vbus_frame_batch third;
+    ring_buf_put(&test_buf, frame, sizeof(frame));
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &third, K_NO_WAIT), -ENOMEM);
+    zassert_is_null(third.block);
+
+    vbus_frame_batch_free(&first);
+    vbus_frame_batch_free(&second);
+}
+
+ZTEST(vbus_frame_pool_tests, test_decode_batch_frame_too_large)
+{
+    setup_test_buffer();
+
+    uint8_t frame[3 + 200] = {0x01, 0x00, 200};
+    uint8_t small[] = {0x02, 0x00, 0x01, 'S'};
+    ring_buf_put(&test_buf, frame, sizeof(frame));
+
+    uint32_t free_blocks = vbus_frame_pool_num_free();
+    struct vbus_frame_batch batch;
+
+    // Dropped instead of blocking the ring for good
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &batch, K_NO_WAIT), 0);
+    zassert_equal(batch.frame_count, 0);
+    zassert_equal(batch.oversized, 1);
+    zassert_equal(vbus_frame_pool_num_free(), free_blocks);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+
+    // The frames behind it still get through
+    ring_buf_put(&test_buf, frame, sizeof(frame));
+    ring_buf_put(&test_buf, small, sizeof(small));
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &batch, K_NO_WAIT), 0);
+    zassert_equal(batch.frame_count, 1);
+    zassert_equal(batch.oversized, 1);
+    zassert_equal(batch.frames[0].channel_idx, 2);
+    zassert_mem_equal(batch.frames[0].data, "S", 1);
+    vbus_frame_batch_free(&batch);
+}
+
+ZTEST(vbus_frame_pool_tests, test_decode_batch_wrapped_frame)
+{
+    setup_test_buffer();
+
+    uint8_t filler[TEST_BUFFER_SIZE - 4] = {0};
+    ring_buf_put(&test_buf, filler, sizeof(filler));
+    ring_buf_get(&test_buf, NULL, sizeof(filler));
+
+    uint8_t test_data[] = {0x08, 0x00, 0x06, 'W', 'R', 'A', 'P', 'E', 'D'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame_batch batch;
+
+    zassert_equal(vbus_frame_decode_batch(&test_buf, ring_buf_size_get(&test_buf), &batch, K_NO_WAIT), 0);
+    zassert_equal(batch.frame_count, 1);
+    zassert_equal(batch.frames[0].channel_idx, 8);
+    zassert_mem_equal(batch.frames[0].data, "WRAPED", 6);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+
+    vbus_frame_batch_free(&batch);
+}
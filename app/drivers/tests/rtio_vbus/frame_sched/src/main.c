@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/frame_sched.h>
+#include <rtio_vbus/sample_codec.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_PLAYOUT_US 5000
+#define TEST_LATE_US 500
+#define TEST_SAMPLE_SIZE 2
+#define TEST_CHANNEL_SAMPLES 16
+#define TEST_LOG_SIZE 64
+// Releases happen on tick boundaries
+#define TEST_TICK_US (1000000 / CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+
+LOG_MODULE_REGISTER(frame_sched_test, LOG_LEVEL_DBG);
+
+struct release_record {
+    uint8_t channel_idx;
+    uint16_t value;
+    uint32_t due_us;
+    uint32_t released_us;
+};
+
+static struct release_record release_log[TEST_LOG_SIZE];
+static uint32_t release_count;
+
+static struct vbus_sched sched;
+static struct vbus_sched_channel channels[3];
+static uint8_t channel_bufs[3][TEST_CHANNEL_SAMPLES * VBUS_SCHED_ENTRY_SIZE(TEST_SAMPLE_SIZE)];
+
+static void on_release(struct vbus_sched_channel *channel, const uint8_t *sample, uint32_t due_us,
+                       void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (release_count < TEST_LOG_SIZE) {
+        struct release_record *record = &release_log[release_count];
+
+        record->channel_idx = channel->channel_idx;
+        memcpy(&record->value, sample, sizeof(record->value));
+        record->due_us = due_us;
+        record->released_us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+    }
+    release_count++;
+}
+
+static void setup_channel(uint32_t idx, uint8_t channel_idx, uint32_t period_us)
+{
+    zassert_ok(vbus_sched_channel_init(&channels[idx], channel_idx, TEST_SAMPLE_SIZE, period_us,
+                                       channel_bufs[idx], sizeof(channel_bufs[idx]), on_release,
+                                       NULL));
+    zassert_ok(vbus_sched_attach(&sched, &channels[idx]));
+}
+
+static int push_samples(uint8_t channel_idx, uint16_t first, uint32_t count,
+                        uint32_t timestamp_us, uint32_t delta_us)
+{
+    uint16_t samples[TEST_CHANNEL_SAMPLES];
+    struct vbus_frame frame = {
+        .channel_idx = channel_idx,
+        .data = (uint8_t *)samples,
+        .size = count * TEST_SAMPLE_SIZE,
+        .sample_count = count,
+        .timestamp_us = timestamp_us,
+        .sample_delta_us = delta_us,
+    };
+
+    for (uint32_t i = 0; i < count; i++) {
+        samples[i] = first + i;
+    }
+
+    return vbus_sched_push(&sched, &frame);
+}
+
+static void sched_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    vbus_sched_init(&sched, TEST_PLAYOUT_US, TEST_LATE_US);
+    memset(release_log, 0, sizeof(release_log));
+    release_count = 0;
+}
+
+static void sched_after(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    vbus_sched_reset(&sched);
+}
+
+ZTEST_SUITE(vbus_frame_sched_tests, NULL, NULL, sched_before, sched_after, NULL);
+
+ZTEST(vbus_frame_sched_tests, test_burst_is_paced_at_odr)
+{
+    struct vbus_sched_metrics metrics;
+
+    setup_channel(0, 1, 1000);
+
+    // Two frames arriving back to back, as after a USB burst
+    zassert_equal(push_samples(1, 0, 4, 0, 0), 4);
+    zassert_equal(push_samples(1, 4, 4, 0, 0), 4);
+    zassert_equal(release_count, 0);
+
+    k_sleep(K_USEC(TEST_PLAYOUT_US / 2));
+    zassert_equal(release_count, 0, "released before the playout delay");
+
+    k_sleep(K_MSEC(20));
+    zassert_equal(release_count, 8);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        zassert_equal(release_log[i].value, i);
+        zassert_equal(release_log[i].due_us - release_log[0].due_us, i * 1000);
+        zassert_true(release_log[i].released_us - release_log[i].due_us <= TEST_TICK_US);
+    }
+
+    vbus_sched_metrics_get(&sched, &channels[0], &metrics);
+    zassert_equal(metrics.released, 8);
+    zassert_equal(metrics.late, 0);
+    zassert_true(metrics.lateness_max_us <= TEST_TICK_US);
+    zassert_true(metrics.jitter_max_us <= TEST_TICK_US);
+}
+
+ZTEST(vbus_frame_sched_tests, test_channels_share_one_timeline)
+{
+    static const uint32_t periods[] = {1000, 1500, 2500};
+    uint32_t per_channel[3] = {0};
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(periods); i++) {
+        setup_channel(i, 10 + i, periods[i]);
+        zassert_equal(push_samples(10 + i, 0, 8, 0, 0), 8);
+    }
+
+    k_sleep(K_MSEC(40));
+    zassert_equal(release_count, 24);
+
+    // One timer and the heap keep the global release order by due time
+    for (uint32_t i = 0; i < release_count; i++) {
+        uint32_t idx = release_log[i].channel_idx - 10;
+
+        zassert_equal(release_log[i].value, per_channel[idx]++);
+        if (i > 0) {
+            zassert_true((int32_t)(release_log[i].due_us - release_log[i - 1].due_us) >= 0);
+        }
+        zassert_true(release_log[i].released_us - release_log[i].due_us <= TEST_TICK_US);
+    }
+}
+
+ZTEST(vbus_frame_sched_tests, test_embedded_timestamps)
+{
+    setup_channel(0, 2, 0);
+
+    zassert_equal(push_samples(2, 0, 3, 1000000, 2000), 3);
+    // Next frame continues after a gap in the source timeline
+    zassert_equal(push_samples(2, 3, 2, 1010000, 500), 2);
+
+    k_sleep(K_MSEC(30));
+    zassert_equal(release_count, 5);
+
+    static const uint32_t expected_offsets[] = {0, 2000, 4000, 10000, 10500};
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(expected_offsets); i++) {
+        zassert_equal(release_log[i].value, i);
+        zassert_equal(release_log[i].due_us - release_log[0].due_us, expected_offsets[i]);
+    }
+
+    // Frames without timing metadata cannot be placed on the timeline
+    zassert_equal(push_samples(2, 0, 1, 0, 0), -EINVAL);
+}
+
+ZTEST(vbus_frame_sched_tests, test_late_samples_are_counted)
+{
+    struct vbus_sched_metrics metrics;
+
+    setup_channel(0, 3, 0);
+
+    zassert_equal(push_samples(3, 0, 2, 0, 1000), 2);
+    k_sleep(K_MSEC(10));
+    zassert_equal(release_count, 2);
+
+    // Arrives long after its slot on the source timeline
+    zassert_equal(push_samples(3, 2, 2, 2000, 1000), 2);
+    k_sleep(K_MSEC(1));
+    zassert_equal(release_count, 4);
+
+    vbus_sched_metrics_get(&sched, &channels[0], &metrics);
+    zassert_equal(metrics.released, 4);
+    zassert_equal(metrics.late, 2);
+    zassert_true(metrics.lateness_max_us >= 10000 - TEST_PLAYOUT_US - 2000);
+    zassert_true(metrics.jitter_max_us > 0);
+}
+
+ZTEST(vbus_frame_sched_tests, test_overruns_and_errors)
+{
+    struct vbus_sched_metrics metrics;
+    struct vbus_frame frame = {
+        .channel_idx = 4,
+        .data = (uint8_t *)"abc",
+        .size = 3,
+    };
+
+    setup_channel(0, 4, 1000);
+    zassert_equal(vbus_sched_attach(&sched, &channels[0]), -EALREADY);
+
+    zassert_equal(push_samples(4, 0, TEST_CHANNEL_SAMPLES, 0, 0), TEST_CHANNEL_SAMPLES);
+    zassert_equal(push_samples(4, 0, 4, 0, 0), 0);
+    vbus_sched_metrics_get(&sched, &channels[0], &metrics);
+    zassert_equal(metrics.overruns, 4);
+
+    zassert_equal(push_samples(5, 0, 1, 0, 0), -ENOENT);
+    zassert_equal(vbus_sched_push(&sched, &frame), -EINVAL);
+
+    frame.size = 2;
+    frame.flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 2, 1);
+    zassert_equal(vbus_sched_push(&sched, &frame), -ENOTSUP);
+
+    // Reset drops what is held
+    vbus_sched_reset(&sched);
+    k_sleep(K_MSEC(30));
+    zassert_equal(release_count, 0);
+}
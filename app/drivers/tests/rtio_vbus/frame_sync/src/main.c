@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/crc32c.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_BUFFER_SIZE 256
+#define TEST_FRAME_COUNT 4
+#define TEST_PAYLOAD_SIZE 8
+#define TEST_SYNC_V1 (VBUS_FRAME_V1 | VBUS_FRAME_SYNC)
+#define TEST_SYNC_FRAME_SIZE (VBUS_FRAME_SYNC_MARKER_SIZE + VBUS_FRAME_HEADER_SIZE + \
+                              TEST_PAYLOAD_SIZE + VBUS_FRAME_CRC_SIZE)
+
+LOG_MODULE_REGISTER(frame_sync_test, LOG_LEVEL_DBG);
+
+static uint8_t ring_storage[TEST_BUFFER_SIZE];
+static struct ring_buf test_ring;
+
+static uint8_t payloads[TEST_FRAME_COUNT][TEST_PAYLOAD_SIZE];
+static struct vbus_frame frames[TEST_FRAME_COUNT];
+static uint8_t stream[TEST_FRAME_COUNT * TEST_SYNC_FRAME_SIZE];
+static uint32_t stream_size;
+
+static struct vbus_frame view_frames[TEST_FRAME_COUNT + 1];
+static struct vbus_frame_view view;
+
+static void *setup_frames(void)
+{
+    const struct vbus_frame *frame_ptrs[TEST_FRAME_COUNT];
+
+    for (uint32_t i = 0; i < TEST_FRAME_COUNT; i++) {
+        // Payloads full of marker bytes must not confuse the resync
+        memset(payloads[i], VBUS_FRAME_SYNC_MARKER_0, TEST_PAYLOAD_SIZE);
+        payloads[i][1] = VBUS_FRAME_SYNC_MARKER_1;
+        payloads[i][TEST_PAYLOAD_SIZE - 1] = (uint8_t)i;
+
+        frames[i].channel_idx = (uint8_t)(i + 1);
+        frames[i].data = payloads[i];
+        frames[i].size = TEST_PAYLOAD_SIZE;
+        frame_ptrs[i] = &frames[i];
+    }
+
+    zassert_ok(vbus_frame_encode_to_ver(TEST_SYNC_V1, frame_ptrs, TEST_FRAME_COUNT,
+                                        stream, sizeof(stream), &stream_size));
+    zassert_equal(stream_size, sizeof(stream));
+    return NULL;
+}
+
+static void put_stream(const uint8_t *data, uint32_t size)
+{
+    zassert_equal(ring_buf_put(&test_ring, data, size), size);
+}
+
+static void reset_ring(void)
+{
+    ring_buf_init(&test_ring, sizeof(ring_storage), ring_storage);
+    vbus_frame_view_init(&view, &test_ring, view_frames, ARRAY_SIZE(view_frames));
+    zassert_ok(vbus_frame_view_set_version(&view, TEST_SYNC_V1));
+}
+
+static void assert_view_channels(const uint8_t *channels, uint32_t count)
+{
+    zassert_equal(view.frame_count, count);
+    for (uint32_t i = 0; i < count; i++) {
+        zassert_equal(view_frames[i].channel_idx, channels[i]);
+        zassert_equal(view_frames[i].size, TEST_PAYLOAD_SIZE);
+        zassert_mem_equal(view_frames[i].data, payloads[channels[i] - 1], TEST_PAYLOAD_SIZE);
+    }
+}
+
+ZTEST_SUITE(vbus_frame_sync_tests, NULL, setup_frames, NULL, NULL, NULL);
+
+ZTEST(vbus_frame_sync_tests, test_crc32c)
+{
+    static const uint8_t check[] = "123456789";
+    uint8_t data[61];
+
+    zassert_equal(vbus_crc32c_update(0, check, 9), 0xE3069283);
+
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    // Chained calls over every split point match a single pass
+    uint32_t expected = vbus_crc32c_update(0, data, sizeof(data));
+    for (uint32_t split = 0; split <= sizeof(data); split++) {
+        uint32_t crc = vbus_crc32c_update(0, data, split);
+        zassert_equal(vbus_crc32c_update(crc, data + split, sizeof(data) - split), expected);
+    }
+}
+
+ZTEST(vbus_frame_sync_tests, test_roundtrip)
+{
+    static const uint8_t channels[] = {1, 2, 3, 4};
+
+    reset_ring();
+    put_stream(stream, stream_size);
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    assert_view_channels(channels, ARRAY_SIZE(channels));
+    zassert_equal(view.crc_errors, 0);
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
+
+ZTEST(vbus_frame_sync_tests, test_flipped_byte_costs_one_frame)
+{
+    static const uint8_t channels[] = {1, 3, 4};
+    uint8_t corrupt[sizeof(stream)];
+
+    memcpy(corrupt, stream, stream_size);
+    corrupt[TEST_SYNC_FRAME_SIZE + VBUS_FRAME_SYNC_MARKER_SIZE + 4] ^= 0x10;
+
+    reset_ring();
+    put_stream(corrupt, stream_size);
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    assert_view_channels(channels, ARRAY_SIZE(channels));
+    zassert_true(view.crc_errors >= 1);
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
+
+ZTEST(vbus_frame_sync_tests, test_dropped_byte_costs_one_frame)
+{
+    static const uint8_t channels[] = {1, 2, 4};
+    struct vbus_frame **decoded;
+    uint32_t decoded_count;
+    uint32_t cut = 2 * TEST_SYNC_FRAME_SIZE + VBUS_FRAME_SYNC_MARKER_SIZE + 1;
+
+    // Losing a size byte makes the third frame claim the wrong length
+    reset_ring();
+    put_stream(stream, cut);
+    put_stream(stream + cut + 1, stream_size - cut - 1);
+
+    zassert_ok(vbus_frame_decode_ver(TEST_SYNC_V1, &test_ring, ring_buf_size_get(&test_ring),
+                                     &decoded, &decoded_count));
+    zassert_equal(decoded_count, ARRAY_SIZE(channels));
+    for (uint32_t i = 0; i < decoded_count; i++) {
+        zassert_equal(decoded[i]->channel_idx, channels[i]);
+        zassert_mem_equal(decoded[i]->data, payloads[channels[i] - 1], TEST_PAYLOAD_SIZE);
+        k_free(decoded[i]->data);
+        k_free(decoded[i]);
+    }
+    k_free(decoded);
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
+
+ZTEST(vbus_frame_sync_tests, test_garbage_and_partial_frame)
+{
+    static const uint8_t channels[] = {1, 2};
+    static const uint8_t garbage[] = {0x00, VBUS_FRAME_SYNC_MARKER_0, 0x13,
+                                      VBUS_FRAME_SYNC_MARKER_0, VBUS_FRAME_SYNC_MARKER_1,
+                                      0x01, 0xFF, 0xFF, 0x42};
+
+    reset_ring();
+    put_stream(garbage, sizeof(garbage));
+    put_stream(stream, 2 * TEST_SYNC_FRAME_SIZE + 5);
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    assert_view_channels(channels, ARRAY_SIZE(channels));
+    zassert_ok(vbus_frame_view_release(&view));
+
+    // The partial third frame is kept until the rest arrives
+    zassert_equal(ring_buf_size_get(&test_ring), 5);
+    put_stream(stream + 2 * TEST_SYNC_FRAME_SIZE + 5, TEST_SYNC_FRAME_SIZE - 5);
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(view_frames[0].channel_idx, 3);
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
+
+ZTEST(vbus_frame_sync_tests, test_garbage_only_is_consumed)
+{
+    uint8_t garbage[64];
+
+    memset(garbage, 0x33, sizeof(garbage));
+    garbage[sizeof(garbage) - 1] = VBUS_FRAME_SYNC_MARKER_0;
+
+    reset_ring();
+    put_stream(garbage, sizeof(garbage));
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_equal(view.frame_count, 0);
+    // Only the trailing marker byte may still start a frame
+    zassert_equal(ring_buf_size_get(&test_ring), 1);
+}
+
+ZTEST(vbus_frame_sync_tests, test_encode_ring_across_wrap)
+{
+    static const uint8_t channels[] = {1, 2, 3, 4};
+    const struct vbus_frame *frame_ptrs[] = {&frames[0], &frames[1], &frames[2], &frames[3]};
+    uint8_t filler[TEST_BUFFER_SIZE - 30];
+
+    reset_ring();
+    put_stream(filler, sizeof(filler));
+    zassert_equal(ring_buf_get(&test_ring, NULL, sizeof(filler)), sizeof(filler));
+
+    zassert_ok(vbus_frame_encode_ring_ver(TEST_SYNC_V1, frame_ptrs, TEST_FRAME_COUNT, &test_ring));
+    zassert_equal(ring_buf_size_get(&test_ring), stream_size);
+
+    uint8_t bounce[TEST_PAYLOAD_SIZE];
+    vbus_frame_view_set_bounce(&view, bounce, sizeof(bounce));
+    uint32_t total = 0;
+    while (total < TEST_FRAME_COUNT) {
+        zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+        zassert_true(view.frame_count > 0);
+        for (uint32_t i = 0; i < view.frame_count; i++) {
+            zassert_equal(view_frames[i].channel_idx, channels[total + i]);
+            zassert_mem_equal(view_frames[i].data, payloads[total + i], TEST_PAYLOAD_SIZE);
+        }
+        total += view.frame_count;
+        zassert_ok(vbus_frame_view_release(&view));
+    }
+    zassert_equal(view.crc_errors, 0);
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_BUFFER_SIZE 128
+
+LOG_MODULE_REGISTER(frame_v2_test, LOG_LEVEL_DBG);
+
+static uint8_t ring_storage[TEST_BUFFER_SIZE];
+static struct ring_buf test_ring;
+
+static uint8_t accel_data[] = {0x00, 0x10, 0x00, 0x20, 0x00, 0x30};
+
+static const struct vbus_frame test_frames[] = {
+    {
+        .channel_idx = 3,
+        .data = accel_data,
+        .size = sizeof(accel_data),
+        .flags = 0x01,
+        .seq = 0xBEEF,
+        .sample_count = 3,
+        .timestamp_us = 0x01020304,
+        .sample_delta_us = 1000,
+    },
+    {
+        .channel_idx = 4,
+        .data = NULL,
+        .size = 0,
+        .seq = 0xBEF0,
+    },
+};
+
+static void assert_metadata_equal(const struct vbus_frame *actual,
+                                  const struct vbus_frame *expected)
+{
+    zassert_equal(actual->channel_idx, expected->channel_idx);
+    zassert_equal(actual->size, expected->size);
+    zassert_equal(actual->flags, expected->flags);
+    zassert_equal(actual->seq, expected->seq);
+    zassert_equal(actual->sample_count, expected->sample_count);
+    zassert_equal(actual->timestamp_us, expected->timestamp_us);
+    zassert_equal(actual->sample_delta_us, expected->sample_delta_us);
+    if (expected->size > 0) {
+        zassert_mem_equal(actual->data, expected->data, expected->size);
+    }
+}
+
+ZTEST_SUITE(vbus_frame_v2_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(vbus_frame_v2_tests, test_negotiate)
+{
+    zassert_equal(vbus_frame_negotiate(VBUS_FRAME_VERSIONS_SUPPORTED), VBUS_FRAME_V2);
+    zassert_equal(vbus_frame_negotiate(VBUS_FRAME_VERSION_BIT(VBUS_FRAME_V1)), VBUS_FRAME_V1);
+    // Unknown or missing offers fall back to v1
+    zassert_equal(vbus_frame_negotiate(0), VBUS_FRAME_V1);
+    zassert_equal(vbus_frame_negotiate(VBUS_FRAME_VERSION_BIT(8)), VBUS_FRAME_V1);
+
+    zassert_equal(vbus_frame_header_size(VBUS_FRAME_V1), VBUS_FRAME_HEADER_SIZE);
+    zassert_equal(vbus_frame_header_size(VBUS_FRAME_V2), VBUS_FRAME_V2_HEADER_SIZE);
+    zassert_equal(vbus_frame_header_size(7), 0);
+}
+
+ZTEST(vbus_frame_v2_tests, test_encode_header_layout)
+{
+    const struct vbus_frame *frames[] = {&test_frames[0]};
+    uint8_t buffer[32];
+    uint32_t size;
+
+    zassert_ok(vbus_frame_encode_to_ver(VBUS_FRAME_V2, frames, 1, buffer, sizeof(buffer), &size));
+    zassert_equal(size, VBUS_FRAME_V2_HEADER_SIZE + sizeof(accel_data));
+
+    uint8_t expected_header[] = {
+        0x03, 0x00, 0x06,           // channel, payload size
+        0x01,                       // flags
+        0xBE, 0xEF,                 // seq
+        0x00, 0x03,                 // sample count
+        0x01, 0x02, 0x03, 0x04,     // timestamp
+        0x00, 0x00, 0x03, 0xE8,     // sample delta
+    };
+    zassert_mem_equal(buffer, expected_header, sizeof(expected_header));
+    zassert_mem_equal(&buffer[VBUS_FRAME_V2_HEADER_SIZE], accel_data, sizeof(accel_data));
+
+    zassert_equal(vbus_frame_encode_to_ver(7, frames, 1, buffer, sizeof(buffer), &size),
+                  -ENOTSUP);
+}
+
+ZTEST(vbus_frame_v2_tests, test_ring_roundtrip)
+{
+    const struct vbus_frame *frames[] = {&test_frames[0], &test_frames[1]};
+    struct vbus_frame **decoded;
+    uint32_t decoded_count;
+
+    ring_buf_init(&test_ring, sizeof(ring_storage), ring_storage);
+    zassert_ok(vbus_frame_encode_ring_ver(VBUS_FRAME_V2, frames, 2, &test_ring));
+
+    zassert_ok(vbus_frame_decode_ver(VBUS_FRAME_V2, &test_ring, ring_buf_size_get(&test_ring),
+                                     &decoded, &decoded_count));
+    zassert_equal(decoded_count, 2);
+    assert_metadata_equal(decoded[0], &test_frames[0]);
+    assert_metadata_equal(decoded[1], &test_frames[1]);
+    zassert_true(ring_buf_is_empty(&test_ring));
+
+    for (uint32_t i = 0; i < decoded_count; i++) {
+        k_free(decoded[i]->data);
+        k_free(decoded[i]);
+    }
+    k_free(decoded);
+}
+
+ZTEST(vbus_frame_v2_tests, test_view_roundtrip)
+{
+    const struct vbus_frame *frames[] = {&test_frames[0], &test_frames[1]};
+    struct vbus_frame view_frames[4];
+    struct vbus_frame_view view;
+
+    ring_buf_init(&test_ring, sizeof(ring_storage), ring_storage);
+    zassert_ok(vbus_frame_encode_ring_ver(VBUS_FRAME_V2, frames, 2, &test_ring));
+
+    vbus_frame_view_init(&view, &test_ring, view_frames, ARRAY_SIZE(view_frames));
+    zassert_ok(vbus_frame_view_set_version(&view, VBUS_FRAME_V2));
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_equal(view.frame_count, 2);
+    assert_metadata_equal(&view_frames[0], &test_frames[0]);
+    assert_metadata_equal(&view_frames[1], &test_frames[1]);
+
+    zassert_equal(vbus_frame_view_set_version(&view, VBUS_FRAME_V1), -EBUSY);
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_true(ring_buf_is_empty(&test_ring));
+}
+
+ZTEST(vbus_frame_v2_tests, test_v1_frames_have_no_metadata)
+{
+    const struct vbus_frame *frames[] = {&test_frames[0]};
+    struct vbus_frame **decoded;
+    uint32_t decoded_count;
+
+    ring_buf_init(&test_ring, sizeof(ring_storage), ring_storage);
+    zassert_ok(vbus_frame_encode_ring(frames, 1, &test_ring));
+    zassert_equal(ring_buf_size_get(&test_ring), VBUS_FRAME_HEADER_SIZE + sizeof(accel_data));
+
+    zassert_ok(vbus_frame_decode(&test_ring, ring_buf_size_get(&test_ring),
+                                 &decoded, &decoded_count));
+    zassert_equal(decoded_count, 1);
+    zassert_equal(decoded[0]->channel_idx, 3);
+    zassert_equal(decoded[0]->seq, 0);
+    zassert_equal(decoded[0]->sample_count, 0);
+    zassert_equal(decoded[0]->timestamp_us, 0);
+
+    k_free(decoded[0]->data);
+    k_free(decoded[0]);
+    k_free(decoded);
+}
+
+static struct vbus_frame stream_frames[2];
+static uint8_t stream_payloads[2][16];
+static uint32_t stream_count;
+
+static void on_frame(const struct vbus_frame *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    zassert_true(stream_count < ARRAY_SIZE(stream_frames));
+    stream_frames[stream_count] = *frame;
+    if (frame->size > 0) {
+        memcpy(stream_payloads[stream_count], frame->data, frame->size);
+        stream_frames[stream_count].data = stream_payloads[stream_count];
+    }
+    stream_count++;
+}
+
+ZTEST(vbus_frame_v2_tests, test_stream_decoder_split_header)
+{
+    const struct vbus_frame *frames[] = {&test_frames[0], &test_frames[1]};
+    uint8_t buffer[64];
+    uint8_t payload[16];
+    uint32_t size;
+    struct vbus_frame_decoder decoder;
+
+    zassert_ok(vbus_frame_encode_to_ver(VBUS_FRAME_V2, frames, 2, buffer, sizeof(buffer), &size));
+
+    stream_count = 0;
+    vbus_frame_decoder_init(&decoder, payload, sizeof(payload), on_frame, NULL);
+    zassert_ok(vbus_frame_decoder_set_version(&decoder, VBUS_FRAME_V2));
+    zassert_equal(vbus_frame_decoder_set_version(&decoder, 7), -ENOTSUP);
+
+    // Split inside the first header, then feed the rest byte by byte
+    zassert_equal(vbus_frame_decoder_feed(&decoder, buffer, 5), 0);
+    int delivered = 0;
+    for (uint32_t i = 5; i < size; i++) {
+        delivered += vbus_frame_decoder_feed_byte(&decoder, buffer[i]);
+    }
+
+    zassert_equal(delivered, 2);
+    zassert_equal(stream_count, 2);
+    assert_metadata_equal(&stream_frames[0], &test_frames[0]);
+    assert_metadata_equal(&stream_frames[1], &test_frames[1]);
+
+    // Whole frames in one chunk go through the in place path
+    stream_count = 0;
+    zassert_equal(vbus_frame_decoder_feed(&decoder, buffer, size), 2);
+    assert_metadata_equal(&stream_frames[0], &test_frames[0]);
+    assert_metadata_equal(&stream_frames[1], &test_frames[1]);
+}
@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/uart_rx.h>
+#include <rtio_vbus/vbus_trace.h>
+
+/*
+* Loopback firmware for the host tool vbus-loopback. Frames arrive on the
+* vbus-uart pty through the same receive pipeline as on a board. Every
+* frame starts with a big endian sequence number, the sequence numbers of
+* the frames of one decode run go back in one frame per channel, so the
+* host can time every frame without the echoes costing as much link time
+* as the frames themselves.
+*/
+
+LOG_MODULE_REGISTER(vbus_loopback, LOG_LEVEL_INF);
+
+#define RX_RING_SIZE 4096
+#define RX_WATERMARK 512
+#define RX_MAX_LATENCY K_USEC(200)
+#define MAX_PAYLOAD_SIZE 1024
+#define CREDIT_THRESHOLD (RX_RING_SIZE / 4)
+#define CREDIT_REFRESH K_MSEC(250)
+#define SEQ_SIZE 4
+#define ECHO_MAX_SEQS 64
+#define STATS_PERIOD K_SECONDS(5)
+
+static const struct device *const uart_dev = DEVICE_DT_GET(DT_NODELABEL(vbus_uart));
+
+static uint8_t rx_ring[RX_RING_SIZE];
+static struct vbus_uart_rx uart_rx;
+
+static uint8_t payload[MAX_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+
+static uint8_t echo_seqs[ECHO_MAX_SEQS * SEQ_SIZE];
+static uint32_t echo_count;
+static uint8_t echo_channel;
+
+static uint32_t frame_count;
+static uint32_t short_frames;
+static uint32_t echo_frames;
+
+// Runs on the work queue like the credits, so the two never interleave
+static void flush_echo(void) {
+    struct vbus_frame frame = {
+        .channel_idx = echo_channel,
+        .size = echo_count * SEQ_SIZE,
+        .data = echo_seqs,
+    };
+    const struct vbus_frame *frame_ptr = &frame;
+    uint8_t out[VBUS_FRAME_HEADER_SIZE + sizeof(echo_seqs)];
+    uint32_t size;
+
+    if (echo_count == 0) {
+        return;
+    }
+
+    if (vbus_frame_encode_to(&frame_ptr, 1, out, sizeof(out), &size) == 0) {
+        for (uint32_t i = 0; i < size; i++) {
+            uart_poll_out(uart_dev, out[i]);
+        }
+        echo_frames++;
+    }
+    echo_count = 0;
+}
+
+static void on_frame(const struct vbus_frame *frame, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    frame_count++;
+    if (frame->size < SEQ_SIZE) {
+        short_frames++;
+        return;
+    }
+
+    if (echo_count == ECHO_MAX_SEQS || (echo_count > 0 && frame->channel_idx != echo_channel)) {
+        flush_echo();
+    }
+
+    echo_channel = frame->channel_idx;
+    memcpy(&echo_seqs[echo_count++ * SEQ_SIZE], frame->data, SEQ_SIZE);
+    vbus_trace_consumed(frame);
+}
+
+static void decode_handler(struct vbus_uart_rx *rx, struct ring_buf *buffer) {
+    ARG_UNUSED(rx);
+
+    vbus_frame_decoder_feed_ring(&decoder, buffer);
+    flush_echo();
+}
+
+int main(void) {
+    int err;
+
+    vbus_frame_decoder_init(&decoder, payload, sizeof(payload), on_frame, NULL);
+
+    err = vbus_uart_rx_init(&uart_rx, uart_dev, rx_ring, sizeof(rx_ring), RX_WATERMARK,
+                            RX_MAX_LATENCY, decode_handler, NULL);
+    if (err) {
+        LOG_ERR("Failed to initialize receive pipeline");
+        return err;
+    }
+
+    // Used by vbus-loopback -f, other hosts skip the credit frames
+    err = vbus_uart_rx_set_flow_ctrl(&uart_rx, CREDIT_THRESHOLD, CREDIT_REFRESH);
+    if (err) {
+        return err;
+    }
+
+    err = vbus_uart_rx_start(&uart_rx);
+    if (err) {
+        return err;
+    }
+
+    while (1) {
+        k_sleep(STATS_PERIOD);
+        LOG_INF("frames=%u short=%u dropped=%u echoes=%u pauses=%u credits=%u", frame_count,
+                short_frames, decoder.dropped_frames, echo_frames,
+                (uint32_t)atomic_get(&uart_rx.pauses), uart_rx.credits);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/vbus_rtio.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_BUFFER_SIZE 64
+
+LOG_MODULE_REGISTER(rtio_iodev_test, LOG_LEVEL_DBG);
+
+RTIO_DEFINE_WITH_MEMPOOL(test_rtio, 4, 8, 8, 16, 4);
+
+VBUS_RTIO_IODEV_DEFINE(test_iodev_a, 1);
+VBUS_RTIO_IODEV_DEFINE(test_iodev_b, 2);
+
+static struct vbus_rtio test_bus;
+
+static uint8_t test_ring_buffer[TEST_BUFFER_SIZE];
+static struct ring_buf test_buf;
+
+static void *suite_setup(void)
+{
+    vbus_rtio_init(&test_bus);
+    zassert_equal(vbus_rtio_attach(&test_bus, &test_iodev_a), 0);
+    zassert_equal(vbus_rtio_attach(&test_bus, &test_iodev_b), 0);
+    return NULL;
+}
+
+ZTEST_SUITE(vbus_rtio_iodev_tests, NULL, suite_setup, NULL, NULL, NULL);
+
+ZTEST(vbus_rtio_iodev_tests, test_attach_twice)
+{
+    zassert_equal(vbus_rtio_attach(&test_bus, &test_iodev_a), -EALREADY);
+}
+
+ZTEST(vbus_rtio_iodev_tests, test_mempool_read)
+{
+    struct rtio_sqe *sqe = rtio_sqe_acquire(&test_rtio);
+    zassert_not_null(sqe);
+    rtio_sqe_prep_read_with_pool(sqe, &test_iodev_a, RTIO_PRIO_NORM, &test_iodev_a);
+    zassert_ok(rtio_submit(&test_rtio, 0));
+
+    // no frame decoded yet, nothing completes
+    zassert_is_null(rtio_cqe_consume(&test_rtio));
+
+    uint8_t payload[] = {'R', 'T', 'I', 'O'};
+    struct vbus_frame frames[] = {
+        {.channel_idx = 2, .size = 1, .data = payload},
+        {.channel_idx = 1, .size = 4, .data = payload},
+    };
+
+    zassert_equal(vbus_rtio_complete(&test_bus, frames, ARRAY_SIZE(frames)), 1);
+
+    struct rtio_cqe *cqe = rtio_cqe_consume(&test_rtio);
+    zassert_not_null(cqe);
+    zassert_equal(cqe->result, 4);
+    zassert_equal(cqe->userdata, &test_iodev_a);
+
+    uint8_t *buf;
+    uint32_t buf_len;
+    zassert_ok(rtio_cqe_get_mempool_buffer(&test_rtio, cqe, &buf, &buf_len));
+    zassert_equal(buf_len, 4);
+    zassert_mem_equal(buf, "RTIO", 4);
+    rtio_release_buffer(&test_rtio, buf, buf_len);
+    rtio_cqe_release(&test_rtio, cqe);
+
+    zassert_is_null(rtio_cqe_consume(&test_rtio));
+}
+
+ZTEST(vbus_rtio_iodev_tests, test_multishot_read_from_ring)
+{
+    ring_buf_init(&test_buf, TEST_BUFFER_SIZE, test_ring_buffer);
+
+    struct rtio_sqe *sqe = rtio_sqe_acquire(&test_rtio);
+    zassert_not_null(sqe);
+    rtio_sqe_prep_read_multishot(sqe, &test_iodev_b, RTIO_PRIO_NORM, &test_iodev_b);
+    zassert_ok(rtio_submit(&test_rtio, 0));
+
+    uint8_t test_data[] = {0x02, 0x00, 0x02, 'A', 'B', 0x02, 0x00, 0x01, 'C',
+                           0x09, 0x00, 0x01, 'X'};
+    ring_buf_put(&test_buf, test_data, sizeof(test_data));
+
+    struct vbus_frame frames[4];
+    struct vbus_frame_view view;
+    vbus_frame_view_init(&view, &test_buf, frames, ARRAY_SIZE(frames));
+
+    // both frames of channel 2 complete from one submission
+    zassert_equal(vbus_rtio_process(&test_bus, &view, ring_buf_size_get(&test_buf)), 2);
+    zassert_equal(ring_buf_size_get(&test_buf), 0);
+    zassert_equal(test_bus.unrouted, 1);
+
+    const char *expected[] = {"AB", "C"};
+    for (int i = 0; i < 2; i++) {
+        struct rtio_cqe *cqe = rtio_cqe_consume(&test_rtio);
+        uint8_t *buf;
+        uint32_t buf_len;
+
+        zassert_not_null(cqe);
+        zassert_equal(cqe->result, strlen(expected[i]));
+        zassert_ok(rtio_cqe_get_mempool_buffer(&test_rtio, cqe, &buf, &buf_len));
+        zassert_mem_equal(buf, expected[i], strlen(expected[i]));
+        rtio_release_buffer(&test_rtio, buf, buf_len);
+        rtio_cqe_release(&test_rtio, cqe);
+    }
+
+    zassert_is_null(rtio_cqe_consume(&test_rtio));
+}
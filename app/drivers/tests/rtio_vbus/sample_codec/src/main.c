@@ -0,0 +1,220 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <rtio_vbus/sample_codec.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_SETS 64
+#define TEST_LANES 3
+
+LOG_MODULE_REGISTER(sample_codec_test, LOG_LEVEL_DBG);
+
+static uint8_t samples[TEST_SETS * TEST_LANES * 4];
+static uint8_t packed[TEST_SETS * TEST_LANES * 5];
+static uint8_t expanded[TEST_SETS * TEST_LANES * 4];
+
+static struct vbus_frame packed_frame(uint8_t flags, uint32_t sample_count, uint32_t size)
+{
+    struct vbus_frame frame = {
+        .channel_idx = 1,
+        .data = packed,
+        .size = size,
+        .flags = flags,
+        .sample_count = sample_count,
+    };
+
+    return frame;
+}
+
+ZTEST_SUITE(vbus_sample_codec_tests, NULL, NULL, NULL, NULL, NULL);
+
+/*
+* Compress the first sample_count sets, expand them again and return the
+* compression ratio times ten.
+*/
+static uint32_t roundtrip(uint8_t flags, uint32_t sample_count, uint32_t sample_size)
+{
+    uint32_t raw_size = sample_count * TEST_LANES * sample_size;
+    uint32_t packed_size;
+    uint32_t counted_size;
+
+    zassert_ok(vbus_sample_encode(samples, sample_count, flags, NULL, 0, &counted_size));
+    zassert_ok(vbus_sample_encode(samples, sample_count, flags, packed, sizeof(packed),
+                                  &packed_size));
+    zassert_equal(counted_size, packed_size);
+
+    struct vbus_frame frame = packed_frame(flags, sample_count, packed_size);
+    zassert_equal(vbus_frame_expanded_size(&frame), raw_size);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), raw_size);
+    zassert_mem_equal(expanded, samples, raw_size);
+
+    return raw_size * 10 / packed_size;
+}
+
+ZTEST(vbus_sample_codec_tests, test_slow_imu_channels_compress)
+{
+    // Accelerometer at rest, 1 g on z with a couple of counts of noise
+    for (uint32_t i = 0; i < TEST_SETS; i++) {
+        int16_t noise = (int16_t)((i * 7) % 5) - 2;
+
+        sys_put_be16((uint16_t)(120 + noise), &samples[(i * TEST_LANES + 0) * 2]);
+        sys_put_be16((uint16_t)(-340 - noise), &samples[(i * TEST_LANES + 1) * 2]);
+        sys_put_be16((uint16_t)(16384 + noise / 2), &samples[(i * TEST_LANES + 2) * 2]);
+    }
+
+    zassert_true(roundtrip(VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_BITPACK, 2, TEST_LANES),
+                           TEST_SETS, 2) >= 30);
+    zassert_true(roundtrip(VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 2, TEST_LANES),
+                           TEST_SETS, 2) >= 15);
+    // A partial last block
+    roundtrip(VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_BITPACK, 2, TEST_LANES), 7, 2);
+}
+
+ZTEST(vbus_sample_codec_tests, test_temperature_channels_compress)
+{
+    // Three 32 bit temperature channels drifting by a count every few samples
+    for (uint32_t i = 0; i < TEST_SETS; i++) {
+        for (uint32_t lane = 0; lane < TEST_LANES; lane++) {
+            sys_put_be32(25000 + lane * 1000 + i / (lane + 3), &samples[(i * TEST_LANES + lane) * 4]);
+        }
+    }
+
+    zassert_true(roundtrip(VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_BITPACK, 4, TEST_LANES),
+                           TEST_SETS, 4) >= 50);
+    zassert_true(roundtrip(VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 4, TEST_LANES),
+                           TEST_SETS, 4) >= 30);
+}
+
+ZTEST(vbus_sample_codec_tests, test_extreme_32bit_steps_are_exact)
+{
+    static const uint32_t values[] = {0, 0x7FFFFFFF, 0x80000000, 1, 0xFFFFFFFF, 0x80000000, 0};
+    uint8_t flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 4, 1);
+    uint32_t packed_size;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(values); i++) {
+        sys_put_be32(values[i], &samples[i * 4]);
+    }
+
+    zassert_ok(vbus_sample_encode(samples, ARRAY_SIZE(values), flags, packed, sizeof(packed),
+                                  &packed_size));
+
+    struct vbus_frame frame = packed_frame(flags, ARRAY_SIZE(values), packed_size);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)),
+                  ARRAY_SIZE(values) * 4);
+    zassert_mem_equal(expanded, samples, ARRAY_SIZE(values) * 4);
+
+    flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_BITPACK, 4, 1);
+    zassert_ok(vbus_sample_encode(samples, ARRAY_SIZE(values), flags, packed, sizeof(packed),
+                                  &packed_size));
+    zassert_equal(packed[0], 32);
+
+    frame = packed_frame(flags, ARRAY_SIZE(values), packed_size);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)),
+                  ARRAY_SIZE(values) * 4);
+    zassert_mem_equal(expanded, samples, ARRAY_SIZE(values) * 4);
+}
+
+ZTEST(vbus_sample_codec_tests, test_extreme_16bit_steps_are_exact)
+{
+    static const uint16_t values[] = {0x8000, 0x7FFF, 0x8000, 0xFFFF, 0x0000, 0x7FFF};
+    uint8_t flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 2, 2);
+    uint32_t packed_size;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(values); i++) {
+        sys_put_be16(values[i], &samples[i * 2]);
+    }
+
+    zassert_ok(vbus_sample_encode(samples, ARRAY_SIZE(values) / 2, flags, packed,
+                                  sizeof(packed), &packed_size));
+    // Wrapped 16 bit deltas never need more than three varint bytes
+    zassert_true(packed_size <= ARRAY_SIZE(values) * 3);
+
+    struct vbus_frame frame = packed_frame(flags, ARRAY_SIZE(values) / 2, packed_size);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)),
+                  ARRAY_SIZE(values) * 2);
+    zassert_mem_equal(expanded, samples, ARRAY_SIZE(values) * 2);
+}
+
+ZTEST(vbus_sample_codec_tests, test_malformed_payloads)
+{
+    uint8_t flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 2, 1);
+    struct vbus_frame frame;
+
+    // Truncated varint
+    packed[0] = 0x02;
+    packed[1] = 0x80;
+    frame = packed_frame(flags, 2, 2);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), -EBADMSG);
+
+    // Bytes left over after the last sample
+    packed[1] = 0x04;
+    packed[2] = 0x06;
+    frame = packed_frame(flags, 2, 3);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), -EBADMSG);
+
+    frame = packed_frame(flags, 2, 2);
+    zassert_equal(vbus_frame_expand(&frame, expanded, 3), -ENOBUFS);
+    zassert_equal(vbus_frame_expand(&frame, expanded, 4), 4);
+    zassert_equal(sys_get_be16(&expanded[0]), 1);
+    zassert_equal(sys_get_be16(&expanded[2]), 3);
+
+    frame.flags = 0x03;
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), -ENOTSUP);
+
+    // Bit packed block shorter than its width says, then an impossible width
+    flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_BITPACK, 2, 1);
+    packed[0] = 9;
+    frame = packed_frame(flags, 2, 3);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), -EBADMSG);
+    packed[0] = 33;
+    frame = packed_frame(flags, 2, 10);
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), -EBADMSG);
+}
+
+ZTEST(vbus_sample_codec_tests, test_raw_frames_are_copied)
+{
+    uint8_t raw[] = {1, 2, 3, 4, 5};
+    struct vbus_frame frame = {.channel_idx = 2, .data = raw, .size = sizeof(raw)};
+    uint32_t packed_size;
+
+    zassert_equal(vbus_frame_expand(&frame, expanded, sizeof(expanded)), sizeof(raw));
+    zassert_mem_equal(expanded, raw, sizeof(raw));
+    zassert_equal(vbus_frame_expand(&frame, expanded, 4), -ENOBUFS);
+
+    zassert_equal(vbus_sample_encode(raw, 1, VBUS_FRAME_CODEC_RAW, packed, sizeof(packed),
+                                     &packed_size), -EINVAL);
+}
+
+ZTEST(vbus_sample_codec_tests, test_v2_frame_roundtrip)
+{
+    uint8_t flags = VBUS_SAMPLE_FLAGS(VBUS_FRAME_CODEC_DELTA_VARINT, 2, 1);
+    uint32_t packed_size;
+    uint32_t size;
+    uint8_t wire[64];
+
+    for (uint32_t i = 0; i < 8; i++) {
+        sys_put_be16((uint16_t)(2500 + i), &samples[i * 2]);
+    }
+    zassert_ok(vbus_sample_encode(samples, 8, flags, packed, sizeof(packed), &packed_size));
+
+    struct vbus_frame frame = packed_frame(flags, 8, packed_size);
+    const struct vbus_frame *frames[] = {&frame};
+    zassert_ok(vbus_frame_encode_to_ver(VBUS_FRAME_V2, frames, 1, wire, sizeof(wire), &size));
+
+    struct vbus_frame_view view;
+    struct vbus_frame view_frame;
+    uint8_t ring_storage[64];
+    struct ring_buf ring;
+
+    ring_buf_init(&ring, sizeof(ring_storage), ring_storage);
+    zassert_equal(ring_buf_put(&ring, wire, size), size);
+    vbus_frame_view_init(&view, &ring, &view_frame, 1);
+    zassert_ok(vbus_frame_view_set_version(&view, VBUS_FRAME_V2));
+    zassert_ok(vbus_frame_decode_view(&view, size));
+    zassert_equal(view.frame_count, 1);
+
+    zassert_equal(vbus_frame_expand(&view_frame, expanded, sizeof(expanded)), 16);
+    zassert_mem_equal(expanded, samples, 16);
+    zassert_ok(vbus_frame_view_release(&view));
+}
@@ -0,0 +1,210 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <rtio_vbus/sample_convert.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_MAX_COUNT 67
+// Source offsets 0 to 3 cover every misalignment of 16 and 32 bit samples
+#define TEST_MAX_OFFSET 4
+
+LOG_MODULE_REGISTER(sample_convert_test, LOG_LEVEL_DBG);
+
+static uint8_t source[TEST_MAX_COUNT * 4 + TEST_MAX_OFFSET];
+static int32_t expected_q31[TEST_MAX_COUNT + 1];
+static int32_t actual_q31[TEST_MAX_COUNT + 1];
+static float expected_f32[TEST_MAX_COUNT + 1];
+static float actual_f32[TEST_MAX_COUNT + 1];
+
+static const float scales[] = {1.0f, 1.0f / 32768.0f, 3.7e-3f, -2.5e4f};
+
+static uint32_t rng_state;
+
+static uint32_t next_random(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state;
+}
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/*
+* Random words mixed with floats that exercise rounding: values with a
+* tie at the q31 lsb, values within [-1, 1), out of range and NaN.
+*/
+static void fill_source(uint32_t seed)
+{
+    rng_state = seed;
+    for (uint32_t i = 0; i + 4 <= sizeof(source); i += 4) {
+        uint32_t r = next_random();
+        uint32_t word;
+
+        switch (r % 4) {
+        case 0:
+            // k / 2^32 with k odd is a tie once scaled by 2^31
+            word = float_bits((float)(((int32_t)next_random() >> 8) | 1) / 4294967296.0f);
+            break;
+        case 1:
+            word = float_bits((float)(int32_t)next_random() / 2147483648.0f);
+            break;
+        default:
+            word = next_random();
+            break;
+        }
+        sys_put_be32(word, &source[i]);
+    }
+}
+
+static void check_impl(const struct vbus_convert_ops *ops, const struct vbus_convert_ops *ref)
+{
+    for (uint32_t offset = 0; offset < TEST_MAX_OFFSET; offset++) {
+        const uint8_t *src = &source[offset];
+
+        for (uint32_t count = 0; count <= TEST_MAX_COUNT; count++) {
+            // The element after the last must stay untouched
+            memset(actual_q31, 0xA5, sizeof(actual_q31));
+            memset(expected_q31, 0xA5, sizeof(expected_q31));
+
+            ref->s16_to_q31(src, expected_q31, count);
+            ops->s16_to_q31(src, actual_q31, count);
+            zassert_mem_equal(actual_q31, expected_q31, sizeof(actual_q31),
+                              "%s s16_to_q31 count %u offset %u", ops->name, count, offset);
+
+            ref->s32_to_q31(src, expected_q31, count);
+            ops->s32_to_q31(src, actual_q31, count);
+            zassert_mem_equal(actual_q31, expected_q31, sizeof(actual_q31),
+                              "%s s32_to_q31 count %u offset %u", ops->name, count, offset);
+
+            ref->f32_to_q31(src, expected_q31, count);
+            ops->f32_to_q31(src, actual_q31, count);
+            zassert_mem_equal(actual_q31, expected_q31, sizeof(actual_q31),
+                              "%s f32_to_q31 count %u offset %u", ops->name, count, offset);
+
+            memset(actual_f32, 0xA5, sizeof(actual_f32));
+            memset(expected_f32, 0xA5, sizeof(expected_f32));
+
+            ref->f32_to_f32(src, expected_f32, count);
+            ops->f32_to_f32(src, actual_f32, count);
+            zassert_mem_equal(actual_f32, expected_f32, sizeof(actual_f32),
+                              "%s f32_to_f32 count %u offset %u", ops->name, count, offset);
+
+            for (uint32_t i = 0; i < ARRAY_SIZE(scales); i++) {
+                ref->s16_to_f32(src, expected_f32, count, scales[i]);
+                ops->s16_to_f32(src, actual_f32, count, scales[i]);
+                zassert_mem_equal(actual_f32, expected_f32, sizeof(actual_f32),
+                                  "%s s16_to_f32 count %u offset %u", ops->name, count, offset);
+
+                ref->s32_to_f32(src, expected_f32, count, scales[i]);
+                ops->s32_to_f32(src, actual_f32, count, scales[i]);
+                zassert_mem_equal(actual_f32, expected_f32, sizeof(actual_f32),
+                                  "%s s32_to_f32 count %u offset %u", ops->name, count, offset);
+            }
+        }
+    }
+}
+
+ZTEST_SUITE(vbus_sample_convert_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(vbus_sample_convert_tests, test_integer_reference_values)
+{
+    static const uint8_t s16[] = {0x00, 0x01, 0x7F, 0xFF, 0x80, 0x00, 0xFF, 0xFF};
+    static const uint8_t s32[] = {0x80, 0x00, 0x00, 0x00, 0x12, 0x34, 0x56, 0x78};
+    const struct vbus_convert_ops *ref = vbus_convert_ops_get(VBUS_CONVERT_SCALAR);
+    int32_t q31[4];
+    float f32[4];
+
+    ref->s16_to_q31(s16, q31, 4);
+    zassert_equal(q31[0], 0x00010000);
+    zassert_equal(q31[1], 0x7FFF0000);
+    zassert_equal(q31[2], INT32_MIN);
+    zassert_equal(q31[3], -0x10000);
+
+    ref->s16_to_f32(s16, f32, 4, 1.0f / 32768.0f);
+    zassert_equal(f32[2], -1.0f);
+    zassert_equal(f32[3], -1.0f / 32768.0f);
+
+    ref->s32_to_q31(s32, q31, 2);
+    zassert_equal(q31[0], INT32_MIN);
+    zassert_equal(q31[1], 0x12345678);
+
+    // Rounded to float before scaling
+    ref->s32_to_f32(s32, f32, 2, 0.5f);
+    zassert_equal(f32[0], -1073741824.0f);
+    zassert_equal(f32[1], (float)0x12345678 * 0.5f);
+}
+
+ZTEST(vbus_sample_convert_tests, test_float_rounding_and_saturation)
+{
+    static const float inputs[] = {
+        0.5f, -1.0f, 1.0f, 2.0f, -3.0f, 1.0f / 4294967296.0f, 3.0f / 4294967296.0f,
+        -1.0f / 4294967296.0f, -3.0f / 4294967296.0f, 5.0f / 4294967296.0f,
+    };
+    static const int32_t expected[] = {
+        0x40000000, INT32_MIN, INT32_MAX, INT32_MAX, INT32_MIN, 0, 2, 0, -2, 2,
+    };
+    const struct vbus_convert_ops *ref = vbus_convert_ops_get(VBUS_CONVERT_SCALAR);
+    uint8_t src[4 * (ARRAY_SIZE(inputs) + 1)];
+    int32_t q31[ARRAY_SIZE(inputs) + 1];
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(inputs); i++) {
+        sys_put_be32(float_bits(inputs[i]), &src[4 * i]);
+    }
+    // Quiet NaN
+    sys_put_be32(0x7FC00000, &src[4 * ARRAY_SIZE(inputs)]);
+
+    ref->f32_to_q31(src, q31, ARRAY_SIZE(q31));
+    for (uint32_t i = 0; i < ARRAY_SIZE(inputs); i++) {
+        zassert_equal(q31[i], expected[i], "input %u", i);
+    }
+    zassert_equal(q31[ARRAY_SIZE(inputs)], 0);
+}
+
+ZTEST(vbus_sample_convert_tests, test_implementations_match_scalar)
+{
+    const struct vbus_convert_ops *ref = vbus_convert_ops_get(VBUS_CONVERT_SCALAR);
+
+    zassert_not_null(ref);
+    zassert_is_null(vbus_convert_ops_get(VBUS_CONVERT_IMPL_COUNT));
+#if defined(CONFIG_APP_DRIVERS_RTIO_VBUS_CONVERT_SIMD) && \
+    (defined(__SSE2__) || defined(__aarch64__))
+    // Host builds must exercise the vector kernels, not fall back silently
+    zassert_not_null(vbus_convert_ops_get(VBUS_CONVERT_SIMD));
+#endif
+
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        fill_source(seed);
+        for (int impl = VBUS_CONVERT_SWAR; impl < VBUS_CONVERT_IMPL_COUNT; impl++) {
+            const struct vbus_convert_ops *ops = vbus_convert_ops_get(impl);
+
+            if (ops) {
+                check_impl(ops, ref);
+            }
+        }
+    }
+}
+
+ZTEST(vbus_sample_convert_tests, test_default_functions)
+{
+    const struct vbus_convert_ops *ref = vbus_convert_ops_get(VBUS_CONVERT_SCALAR);
+
+    fill_source(42);
+
+    ref->s16_to_q31(source, expected_q31, TEST_MAX_COUNT);
+    vbus_convert_s16_to_q31(source, actual_q31, TEST_MAX_COUNT);
+    zassert_mem_equal(actual_q31, expected_q31, TEST_MAX_COUNT * sizeof(int32_t));
+
+    ref->f32_to_q31(source, expected_q31, TEST_MAX_COUNT);
+    vbus_convert_f32_to_q31(source, actual_q31, TEST_MAX_COUNT);
+    zassert_mem_equal(actual_q31, expected_q31, TEST_MAX_COUNT * sizeof(int32_t));
+
+    ref->s32_to_f32(source, expected_f32, TEST_MAX_COUNT, 1e-3f);
+    vbus_convert_s32_to_f32(source, actual_f32, TEST_MAX_COUNT, 1e-3f);
+    zassert_mem_equal(actual_f32, expected_f32, TEST_MAX_COUNT * sizeof(float));
+}
@@ -0,0 +1,223 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/vbus_stats.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_BUFFER_SIZE 256
+#define TEST_PAYLOAD_SIZE 8
+#define TEST_SYNC_V1 (VBUS_FRAME_V1 | VBUS_FRAME_SYNC)
+// Beyond CONFIG_APP_DRIVERS_RTIO_VBUS_STATS_CHANNELS of the test config
+#define TEST_UNTRACKED_CHANNEL 200
+
+LOG_MODULE_REGISTER(stats_test, LOG_LEVEL_DBG);
+
+static uint8_t ring_storage[TEST_BUFFER_SIZE];
+static struct ring_buf test_ring;
+
+static uint8_t payload[TEST_PAYLOAD_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
+static struct vbus_frame view_frames[4];
+static struct vbus_frame_view view;
+static uint8_t decoder_payload[TEST_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+
+static struct vbus_stats stats;
+static struct vbus_stats other_stats;
+
+static void put_frames(enum vbus_frame_version version, const uint8_t *channels,
+                       uint32_t count, uint32_t size)
+{
+    struct vbus_frame frames[4];
+    const struct vbus_frame *frame_ptrs[4];
+
+    for (uint32_t i = 0; i < count; i++) {
+        frames[i] = (struct vbus_frame) {
+            .channel_idx = channels[i],
+            .data = size ? payload : NULL,
+            .size = size,
+        };
+        frame_ptrs[i] = &frames[i];
+    }
+
+    zassert_ok(vbus_frame_encode_ring_ver(version, frame_ptrs, count, &test_ring));
+}
+
+static void *stats_setup(void)
+{
+    zassert_ok(vbus_stats_init(&stats, "vbus_test"));
+    zassert_ok(vbus_stats_init(&other_stats, "vbus_other"));
+    return NULL;
+}
+
+static void stats_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    ring_buf_init(&test_ring, sizeof(ring_storage), ring_storage);
+    vbus_frame_view_init(&view, &test_ring, view_frames, ARRAY_SIZE(view_frames));
+    vbus_frame_view_set_stats(&view, &stats);
+    vbus_frame_decoder_init(&decoder, decoder_payload, sizeof(decoder_payload), NULL, NULL);
+    vbus_frame_decoder_set_stats(&decoder, &stats);
+    vbus_stats_reset(&stats);
+}
+
+static uint32_t decode_time_total(void)
+{
+    return stats.s.decode_lt_16us + stats.s.decode_lt_64us + stats.s.decode_lt_256us +
+           stats.s.decode_lt_1ms + stats.s.decode_lt_4ms + stats.s.decode_ge_4ms;
+}
+
+ZTEST_SUITE(vbus_stats_tests, NULL, stats_setup, stats_before, NULL, NULL);
+
+ZTEST(vbus_stats_tests, test_view_counts_frames_per_channel)
+{
+    static const uint8_t channels[] = {0, 1, 1, TEST_UNTRACKED_CHANNEL};
+
+    put_frames(VBUS_FRAME_V1, channels, ARRAY_SIZE(channels), TEST_PAYLOAD_SIZE);
+    uint32_t buffered = ring_buf_size_get(&test_ring);
+
+    zassert_ok(vbus_frame_decode_view(&view, buffered));
+    zassert_equal(view.frame_count, 4);
+    zassert_ok(vbus_frame_view_release(&view));
+
+    zassert_equal(stats.s.frames, 4);
+    zassert_equal(stats.s.bytes, 4 * TEST_PAYLOAD_SIZE);
+    zassert_equal(stats.s.decode_calls, 1);
+    zassert_equal(stats.s.stalls, 0);
+    zassert_equal(stats.s.ring_hwm, buffered);
+    zassert_equal(decode_time_total(), 1);
+
+    zassert_equal(stats.chan[0].frames, 1);
+    zassert_equal(stats.chan[1].frames, 2);
+    zassert_equal(stats.chan[1].bytes, 2 * TEST_PAYLOAD_SIZE);
+    // Untracked channels only show in the totals
+    for (uint32_t i = 2; i < VBUS_STATS_CHANNELS; i++) {
+        zassert_equal(stats.chan[i].frames, 0);
+    }
+}
+
+ZTEST(vbus_stats_tests, test_view_counts_stall_on_partial_frame)
+{
+    static const uint8_t channels[] = {2, 3};
+
+    put_frames(VBUS_FRAME_V1, channels, ARRAY_SIZE(channels), TEST_PAYLOAD_SIZE);
+    uint32_t buffered = ring_buf_size_get(&test_ring);
+
+    // Second frame is one byte short
+    zassert_ok(vbus_frame_decode_view(&view, buffered - 1));
+    zassert_equal(view.frame_count, 1);
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_equal(stats.s.stalls, 1);
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_equal(view.frame_count, 1);
+    zassert_ok(vbus_frame_view_release(&view));
+
+    zassert_equal(stats.s.stalls, 1);
+    zassert_equal(stats.s.decode_calls, 2);
+    zassert_equal(stats.s.frames, 2);
+}
+
+ZTEST(vbus_stats_tests, test_view_counts_crc_errors_as_drops)
+{
+    static const uint8_t channels[] = {1, 2};
+    uint8_t *data;
+
+    zassert_ok(vbus_frame_view_set_version(&view, TEST_SYNC_V1));
+    put_frames(TEST_SYNC_V1, channels, ARRAY_SIZE(channels), TEST_PAYLOAD_SIZE);
+
+    // Corrupt the first payload
+    zassert_true(ring_buf_get_claim(&test_ring, &data, TEST_BUFFER_SIZE) > 8);
+    data[VBUS_FRAME_SYNC_MARKER_SIZE + VBUS_FRAME_HEADER_SIZE] ^= 0xFF;
+    zassert_ok(ring_buf_get_finish(&test_ring, 0));
+
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_equal(view.frame_count, 1);
+    zassert_equal(view_frames[0].channel_idx, 2);
+    zassert_ok(vbus_frame_view_release(&view));
+
+    zassert_equal(stats.s.crc_errors, 1);
+    zassert_equal(stats.s.drops, 1);
+    zassert_equal(stats.s.frames, 1);
+}
+
+ZTEST(vbus_stats_tests, test_decoder_counts_drops_and_stalls)
+{
+    static uint8_t large_payload[TEST_PAYLOAD_SIZE * 2];
+    static uint8_t stream[2 * VBUS_FRAME_HEADER_SIZE + 3 * TEST_PAYLOAD_SIZE];
+    const struct vbus_frame frames[] = {
+        // Too large for the decoder storage, skipped
+        {.channel_idx = 4, .data = large_payload, .size = sizeof(large_payload)},
+        {.channel_idx = 3, .data = payload, .size = TEST_PAYLOAD_SIZE},
+    };
+    const struct vbus_frame *frame_ptrs[] = {&frames[0], &frames[1]};
+    uint32_t stream_size;
+
+    zassert_ok(vbus_frame_encode_to(frame_ptrs, ARRAY_SIZE(frame_ptrs), stream,
+                                    sizeof(stream), &stream_size));
+    zassert_equal(stream_size, sizeof(stream));
+
+    // Hold back the last byte, the decoder keeps the partial frame
+    zassert_equal(ring_buf_put(&test_ring, stream, stream_size - 1), stream_size - 1);
+    zassert_equal(vbus_frame_decoder_feed_ring(&decoder, &test_ring), 0);
+    zassert_equal(stats.s.drops, 1);
+    zassert_equal(stats.chan[4].drops, 1);
+    zassert_equal(stats.s.stalls, 1);
+
+    zassert_equal(ring_buf_put(&test_ring, &stream[stream_size - 1], 1), 1);
+    zassert_equal(vbus_frame_decoder_feed_ring(&decoder, &test_ring), 1);
+    zassert_equal(stats.s.stalls, 1);
+    zassert_equal(stats.s.decode_calls, 2);
+    zassert_equal(stats.s.frames, 1);
+    zassert_equal(stats.chan[3].frames, 1);
+    zassert_equal(stats.chan[3].bytes, TEST_PAYLOAD_SIZE);
+}
+
+static void collect_names(struct vbus_stats *instance, void *user_data)
+{
+    uint32_t *seen = user_data;
+
+    if (instance == &stats) {
+        zassert_equal(*seen, 0);
+        *seen |= BIT(0);
+    } else if (instance == &other_stats) {
+        zassert_equal(*seen, BIT(0));
+        *seen |= BIT(1);
+    }
+}
+
+ZTEST(vbus_stats_tests, test_instances_are_listed_and_independent)
+{
+    static const uint8_t channels[] = {1};
+    uint32_t seen = 0;
+
+    vbus_stats_foreach(collect_names, &seen);
+    zassert_equal(seen, BIT(0) | BIT(1));
+    zassert_equal(strcmp(stats.chan_names[1], "vbus_test_ch1"), 0);
+
+    put_frames(VBUS_FRAME_V1, channels, 1, TEST_PAYLOAD_SIZE);
+    vbus_frame_view_set_stats(&view, &other_stats);
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_ok(vbus_frame_view_release(&view));
+
+    zassert_equal(stats.s.frames, 0);
+    zassert_equal(other_stats.s.frames, 1);
+
+    // Detached views count nothing
+    put_frames(VBUS_FRAME_V1, channels, 1, TEST_PAYLOAD_SIZE);
+    vbus_frame_view_set_stats(&view, NULL);
+    zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&test_ring)));
+    zassert_ok(vbus_frame_view_release(&view));
+    zassert_equal(other_stats.s.frames, 1);
+}
+
+ZTEST(vbus_stats_tests, test_name_too_long)
+{
+    static struct vbus_stats long_stats;
+
+    // 19 characters leave no room for "_ch255"
+    zassert_equal(vbus_stats_init(&long_stats, "vbus_uart_rx_decode"), -ENAMETOOLONG);
+    zassert_is_null(long_stats.name);
+}
@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_PAYLOAD_SIZE 64
+#define TEST_MAX_FRAMES 8
+
+LOG_MODULE_REGISTER(stream_decode_test, LOG_LEVEL_DBG);
+
+struct received_frame {
+    uint8_t channel_idx;
+    uint32_t size;
+    uint8_t data[TEST_PAYLOAD_SIZE];
+};
+
+static struct received_frame received[TEST_MAX_FRAMES];
+static uint32_t received_count;
+
+static uint8_t payload_storage[TEST_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+
+static void on_frame(const struct vbus_frame *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    zassert_true(received_count < TEST_MAX_FRAMES);
+    received[received_count].channel_idx = frame->channel_idx;
+    received[received_count].size = frame->size;
+    if (frame->size > 0) {
+        memcpy(received[received_count].data, frame->data, frame->size);
+    }
+    received_count++;
+}
+
+static void setup_decoder(void)
+{
+    received_count = 0;
+    vbus_frame_decoder_init(&decoder, payload_storage, sizeof(payload_storage), on_frame, NULL);
+}
+
+ZTEST_SUITE(vbus_stream_decode_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(vbus_stream_decode_tests, test_feed_whole_frames)
+{
+    setup_decoder();
+
+    uint8_t test_data[] = {0x01, 0x00, 0x02, 'O', 'K', 0x02, 0x00, 0x00};
+
+    zassert_equal(vbus_frame_decoder_feed(&decoder, test_data, sizeof(test_data)), 2);
+    zassert_equal(received_count, 2);
+    zassert_equal(received[0].channel_idx, 1);
+    zassert_equal(received[0].size, 2);
+    zassert_mem_equal(received[0].data, "OK", 2);
+    zassert_equal(received[1].channel_idx, 2);
+    zassert_equal(received[1].size, 0);
+}
+
+ZTEST(vbus_stream_decode_tests, test_feed_split_header_and_payload)
+{
+    setup_decoder();
+
+    uint8_t test_data[] = {0x01, 0x00, 0x0C, 'H', 'E', 'L', 'L', 'O', '_',
+                           'W', 'O', 'R', 'L', 'D', '\0', 0x03, 0x00, 0x01, 'Z'};
+
+    // feed in uneven chunks, splitting both headers and payloads
+    const uint32_t chunks[] = {1, 1, 4, 5, 5, 2, 1};
+    uint32_t offset = 0;
+    int delivered = 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(chunks); i++) {
+        delivered += vbus_frame_decoder_feed(&decoder, &test_data[offset], chunks[i]);
+        offset += chunks[i];
+    }
+
+    zassert_equal(offset, sizeof(test_data));
+    zassert_equal(delivered, 2);
+    zassert_equal(received[0].channel_idx, 1);
+    zassert_equal(received[0].size, 12);
+    zassert_mem_equal(received[0].data, "HELLO_WORLD\0", 12);
+    zassert_equal(received[1].channel_idx, 3);
+    zassert_mem_equal(received[1].data, "Z", 1);
+}
+
+ZTEST(vbus_stream_decode_tests, test_feed_byte_at_a_time)
+{
+    setup_decoder();
+
+    uint8_t test_data[] = {0x04, 0x00, 0x03, 'A', 'B', 'C', 0x05, 0x00, 0x00};
+    int delivered = 0;
+
+    for (uint32_t i = 0; i < sizeof(test_data); i++) {
+        delivered += vbus_frame_decoder_feed_byte(&decoder, test_data[i]);
+    }
+
+    zassert_equal(delivered, 2);
+    zassert_equal(received[0].channel_idx, 4);
+    zassert_mem_equal(received[0].data, "ABC", 3);
+    zassert_equal(received[1].channel_idx, 5);
+    zassert_equal(received[1].size, 0);
+}
+
+ZTEST(vbus_stream_decode_tests, test_oversized_frame_is_skipped)
+{
+    setup_decoder();
+
+    uint8_t large[3 + TEST_PAYLOAD_SIZE + 1] = {0x01, 0x00, TEST_PAYLOAD_SIZE + 1};
+    uint8_t small[] = {0x02, 0x00, 0x01, 'S'};
+
+    // oversized frames are dropped regardless of how the bytes arrive
+    zassert_equal(vbus_frame_decoder_feed(&decoder, large, sizeof(large)), 0);
+    zassert_equal(vbus_frame_decoder_feed(&decoder, small, sizeof(small)), 1);
+    zassert_equal(vbus_frame_decoder_feed(&decoder, large, 10), 0);
+    zassert_equal(vbus_frame_decoder_feed(&decoder, &large[10], sizeof(large) - 10), 0);
+
+    zassert_equal(decoder.dropped_frames, 2);
+    zassert_equal(received_count, 1);
+    zassert_equal(received[0].channel_idx, 2);
+}
+
+ZTEST(vbus_stream_decode_tests, test_feed_ring_across_wrap)
+{
+    setup_decoder();
+
+    uint8_t ring_storage[16];
+    struct ring_buf ring;
+    ring_buf_init(&ring, sizeof(ring_storage), ring_storage);
+
+    uint8_t filler[12] = {0};
+    ring_buf_put(&ring, filler, sizeof(filler));
+    ring_buf_get(&ring, NULL, sizeof(filler));
+
+    uint8_t test_data[] = {0x06, 0x00, 0x05, 'W', 'R', 'A', 'P', 'S'};
+    ring_buf_put(&ring, test_data, sizeof(test_data));
+
+    zassert_equal(vbus_frame_decoder_feed_ring(&decoder, &ring), 1);
+    zassert_equal(ring_buf_size_get(&ring), 0);
+    zassert_equal(received[0].channel_idx, 6);
+    zassert_mem_equal(received[0].data, "WRAPS", 5);
+}
@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <rtio_vbus/data_frame.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/frame_demux.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_MAX_FRAMES 8
+#define TEST_STREAM_FRAMES 3
+
+LOG_MODULE_REGISTER(tracing_test, LOG_LEVEL_DBG);
+
+// Frames of 5, 0 and 10 payload bytes, their headers end at 3, 11 and 14
+static const uint32_t stream_ids[TEST_STREAM_FRAMES] = {3, 11, 14};
+static uint8_t stream[64];
+static uint32_t stream_size;
+
+static uint32_t ids[TEST_MAX_FRAMES];
+static uint32_t id_count;
+
+static uint8_t payload_storage[16];
+static struct vbus_frame_decoder decoder;
+
+VBUS_SPSC_QUEUE_DEFINE(test_queue, 4, 16);
+
+static void on_frame(const struct vbus_frame *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    zassert_true(id_count < TEST_MAX_FRAMES);
+    ids[id_count++] = frame->trace_id;
+}
+
+static void check_ids(uint32_t stream_pos)
+{
+    zassert_equal(id_count, TEST_STREAM_FRAMES);
+    for (uint32_t i = 0; i < TEST_STREAM_FRAMES; i++) {
+        zassert_equal(ids[i], stream_pos + stream_ids[i], "frame %u has id %u", i, ids[i]);
+    }
+    id_count = 0;
+}
+
+static void *tracing_setup(void)
+{
+    static uint8_t data[10] = "0123456789";
+    struct vbus_frame frames[] = {
+        {.channel_idx = 1, .size = 5, .data = data},
+        {.channel_idx = 2, .size = 0, .data = NULL},
+        {.channel_idx = 3, .size = 10, .data = data},
+    };
+    const struct vbus_frame *frame_ptrs[] = {&frames[0], &frames[1], &frames[2]};
+
+    zassert_ok(vbus_frame_encode_to(frame_ptrs, ARRAY_SIZE(frame_ptrs), stream, sizeof(stream),
+                                    &stream_size));
+    zassert_equal(stream_size, 24);
+    return NULL;
+}
+
+static void tracing_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    id_count = 0;
+}
+
+ZTEST_SUITE(vbus_tracing_tests, NULL, tracing_setup, tracing_before, NULL, NULL);
+
+ZTEST(vbus_tracing_tests, test_decoder_stream_positions)
+{
+    vbus_frame_decoder_init(&decoder, payload_storage, sizeof(payload_storage), on_frame, NULL);
+
+    // Split inside headers and payloads
+    for (uint32_t offset = 0; offset < stream_size; offset += 4) {
+        vbus_frame_decoder_feed(&decoder, &stream[offset], MIN(4, stream_size - offset));
+    }
+    check_ids(0);
+
+    for (uint32_t i = 0; i < stream_size; i++) {
+        vbus_frame_decoder_feed_byte(&decoder, stream[i]);
+    }
+    check_ids(stream_size);
+
+    // Positions keep counting across a reset, in step with the RX side
+    vbus_frame_decoder_reset(&decoder);
+    zassert_equal(vbus_frame_decoder_feed(&decoder, stream, stream_size), TEST_STREAM_FRAMES);
+    check_ids(2 * stream_size);
+}
+
+ZTEST(vbus_tracing_tests, test_view_stream_positions)
+{
+    uint8_t ring_storage[64];
+    struct ring_buf ring;
+    struct vbus_frame frames[TEST_MAX_FRAMES];
+    struct vbus_frame_view view;
+
+    ring_buf_init(&ring, sizeof(ring_storage), ring_storage);
+    vbus_frame_view_init(&view, &ring, frames, ARRAY_SIZE(frames));
+
+    for (uint32_t round = 0; round < 2; round++) {
+        zassert_equal(ring_buf_put(&ring, stream, stream_size), stream_size);
+        zassert_ok(vbus_frame_decode_view(&view, ring_buf_size_get(&ring)));
+        zassert_equal(view.frame_count, TEST_STREAM_FRAMES);
+        for (uint32_t i = 0; i < view.frame_count; i++) {
+            on_frame(&frames[i], NULL);
+        }
+        check_ids(round * stream_size);
+        zassert_ok(vbus_frame_view_release(&view));
+    }
+}
+
+ZTEST(vbus_tracing_tests, test_demux_keeps_id)
+{
+    struct vbus_demux demux;
+    uint8_t data[4] = {1, 2, 3, 4};
+    struct vbus_frame frame = {.channel_idx = 5, .size = sizeof(data), .data = data,
+                               .trace_id = 1234};
+    const struct vbus_frame *queued;
+
+    vbus_demux_init(&demux);
+    zassert_ok(vbus_demux_register(&demux, 5, &test_queue));
+    zassert_equal(vbus_demux_dispatch(&demux, &frame, 1), 1);
+
+    queued = vbus_spsc_peek(&test_queue);
+    zassert_not_null(queued);
+    zassert_equal(queued->trace_id, 1234);
+    vbus_spsc_release(&test_queue);
+}
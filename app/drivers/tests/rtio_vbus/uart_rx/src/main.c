@@ -0,0 +1,216 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <string.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/uart_rx.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_RING_SIZE 64
+#define TEST_PAYLOAD_SIZE 16
+
+LOG_MODULE_REGISTER(uart_rx_test, LOG_LEVEL_DBG);
+
+static const struct device *const test_uart = DEVICE_DT_GET(DT_NODELABEL(euart0));
+
+static uint8_t test_ring_buffer[TEST_RING_SIZE];
+static struct vbus_uart_rx test_rx;
+
+static uint8_t payload_storage[TEST_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+static uint32_t received_count;
+static uint32_t received_bytes;
+
+K_SEM_DEFINE(frame_sem, 0, 32);
+
+static void on_frame(const struct vbus_frame *frame, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    received_count++;
+    received_bytes += frame->size;
+    k_sem_give(&frame_sem);
+}
+
+static void decode_handler(struct vbus_uart_rx *rx, struct ring_buf *buffer)
+{
+    ARG_UNUSED(rx);
+
+    vbus_frame_decoder_feed_ring(&decoder, buffer);
+}
+
+static void start_rx(uint32_t watermark, k_timeout_t max_latency)
+{
+    zassert_ok(vbus_uart_rx_init(&test_rx, test_uart, test_ring_buffer, sizeof(test_ring_buffer),
+                                 watermark, max_latency, decode_handler, NULL));
+    zassert_ok(vbus_uart_rx_start(&test_rx));
+}
+
+// Frames of 7 payload bytes
+static void put_frames(uint8_t count)
+{
+    uint8_t test_data[10 * 10];
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t *frame = &test_data[i * 10];
+        frame[0] = i;
+        frame[1] = 0x00;
+        frame[2] = 7;
+        memset(&frame[3], i, 7);
+    }
+    zassert_equal(uart_emul_put_rx_data(test_uart, test_data, count * 10), count * 10);
+}
+
+static void before_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    received_count = 0;
+    received_bytes = 0;
+    k_sem_reset(&frame_sem);
+    vbus_frame_decoder_init(&decoder, payload_storage, sizeof(payload_storage), on_frame, NULL);
+}
+
+static void after_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    vbus_uart_rx_stop(&test_rx);
+}
+
+ZTEST_SUITE(vbus_uart_rx_tests, NULL, NULL, before_each, after_each, NULL);
+
+ZTEST(vbus_uart_rx_tests, test_watermark_triggers_decode)
+{
+    start_rx(8, K_SECONDS(1));
+
+    uint8_t test_data[] = {0x01, 0x00, 0x07, 'W', 'A', 'T', 'E', 'R', 'M', 'K'};
+    zassert_equal(uart_emul_put_rx_data(test_uart, test_data, sizeof(test_data)),
+                  sizeof(test_data));
+
+    // well before the latency deadline
+    zassert_ok(k_sem_take(&frame_sem, K_MSEC(100)));
+    zassert_equal(received_count, 1);
+    zassert_equal(received_bytes, 7);
+}
+
+ZTEST(vbus_uart_rx_tests, test_deadline_flushes_small_frame)
+{
+    start_rx(32, K_MSEC(50));
+
+    uint8_t test_data[] = {0x02, 0x00, 0x01, 'S'};
+    zassert_equal(uart_emul_put_rx_data(test_uart, test_data, sizeof(test_data)),
+                  sizeof(test_data));
+
+    // below the watermark nothing happens until the deadline
+    zassert_equal(k_sem_take(&frame_sem, K_MSEC(10)), -EAGAIN);
+    zassert_ok(k_sem_take(&frame_sem, K_MSEC(200)));
+    zassert_equal(received_count, 1);
+}
+
+ZTEST(vbus_uart_rx_tests, test_full_ring_pauses_reception)
+{
+    start_rx(8, K_MSEC(10));
+
+    // more data than the ring holds, arriving in a single burst
+    put_frames(10);
+
+    for (int i = 0; i < 10; i++) {
+        zassert_ok(k_sem_take(&frame_sem, K_MSEC(200)));
+    }
+
+    zassert_equal(received_count, 10);
+    zassert_equal(decoder.dropped_frames, 0);
+    zassert_true(atomic_get(&test_rx.pauses) > 0);
+}
+
+ZTEST(vbus_uart_rx_tests, test_deadline_coalesces_wakeups)
+{
+    start_rx(32, K_MSEC(50));
+
+    // Three interrupts below the watermark share one decode run
+    for (int i = 0; i < 3; i++) {
+        put_frames(1);
+        k_sleep(K_MSEC(2));
+    }
+
+    for (int i = 0; i < 3; i++) {
+        zassert_ok(k_sem_take(&frame_sem, K_MSEC(200)));
+    }
+    zassert_equal(atomic_get(&test_rx.irqs), 3);
+    zassert_equal(atomic_get(&test_rx.wakeups), 1);
+}
+
+ZTEST(vbus_uart_rx_tests, test_restart_after_cut_off_frame)
+{
+    uint8_t partial[] = {0x01, 0x00, 0x07, 'C', 'U'};
+
+    // Below the watermark and without deadline, the bytes stay in the ring
+    start_rx(32, K_FOREVER);
+    zassert_equal(uart_emul_put_rx_data(test_uart, partial, sizeof(partial)), sizeof(partial));
+    k_sleep(K_MSEC(10));
+
+    // Disconnect mid-frame, as the cdc-acm-vbus-rx sample does on DTR low
+    vbus_uart_rx_stop(&test_rx);
+    vbus_uart_rx_flush(&test_rx);
+    vbus_frame_decoder_reset(&decoder);
+    zassert_ok(vbus_uart_rx_start(&test_rx));
+
+    put_frames(4);
+    for (int i = 0; i < 4; i++) {
+        zassert_ok(k_sem_take(&frame_sem, K_MSEC(200)));
+    }
+    zassert_equal(received_count, 4);
+    zassert_equal(received_bytes, 4 * 7);
+    zassert_equal(decoder.dropped_frames, 0);
+}
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+ZTEST(vbus_uart_rx_tests, test_watermark_follows_rate)
+{
+    zassert_ok(vbus_uart_rx_init(&test_rx, test_uart, test_ring_buffer, sizeof(test_ring_buffer),
+                                 8, K_SECONDS(1), decode_handler, NULL));
+    zassert_ok(vbus_uart_rx_set_latency_budget(&test_rx, 20000));
+    zassert_ok(vbus_uart_rx_start(&test_rx));
+
+    // 30 kB/s fill half the ring within half the budget, the ceiling
+    for (int i = 0; i < 60; i++) {
+        put_frames(3);
+        k_sleep(K_MSEC(1));
+    }
+    k_sleep(K_MSEC(50));
+    zassert_equal(received_count, 180);
+    zassert_equal(test_rx.watermark, TEST_RING_SIZE / 2);
+    zassert_true(atomic_get(&test_rx.wakeups) < atomic_get(&test_rx.irqs),
+                 "%u wakeups for %u interrupts", (uint32_t)atomic_get(&test_rx.wakeups),
+                 (uint32_t)atomic_get(&test_rx.irqs));
+
+    // The budget caps the one second deadline, and a slow link brings the
+    // watermark back down to the floor
+    for (int i = 0; i < 2; i++) {
+        k_sleep(K_MSEC(200));
+        k_sem_reset(&frame_sem);
+        put_frames(1);
+        zassert_ok(k_sem_take(&frame_sem, K_MSEC(100)));
+    }
+    zassert_equal(test_rx.watermark, 8);
+}
+
+ZTEST(vbus_uart_rx_tests, test_budget_restores_init_deadline)
+{
+    zassert_ok(vbus_uart_rx_init(&test_rx, test_uart, test_ring_buffer, sizeof(test_ring_buffer),
+                                 8, K_MSEC(50), decode_handler, NULL));
+
+    zassert_ok(vbus_uart_rx_set_latency_budget(&test_rx, 20000));
+    zassert_true(K_TIMEOUT_EQ(test_rx.max_latency, K_USEC(20000)));
+    // A budget above the init deadline or none at all leaves that deadline
+    zassert_ok(vbus_uart_rx_set_latency_budget(&test_rx, 100000));
+    zassert_true(K_TIMEOUT_EQ(test_rx.max_latency, K_MSEC(50)));
+    zassert_ok(vbus_uart_rx_set_latency_budget(&test_rx, 20000));
+    zassert_ok(vbus_uart_rx_set_latency_budget(&test_rx, 0));
+    zassert_true(K_TIMEOUT_EQ(test_rx.max_latency, K_MSEC(50)));
+
+    // after_each stops the pipeline
+    zassert_ok(vbus_uart_rx_start(&test_rx));
+}
+#endif
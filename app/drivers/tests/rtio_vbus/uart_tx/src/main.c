@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <string.h>
+#include <rtio_vbus/uart_tx.h>
+#include <zephyr/logging/log.h>
+
+#define TEST_RING_SIZE 128
+#define TEST_CHUNK_SIZE 16
+
+LOG_MODULE_REGISTER(uart_tx_test, LOG_LEVEL_DBG);
+
+static const struct device *const test_uart = DEVICE_DT_GET(DT_NODELABEL(euart0));
+
+static uint8_t test_ring_buffer[TEST_RING_SIZE];
+static struct vbus_uart_tx test_tx;
+
+static void init_tx(uint32_t watermark, k_timeout_t max_latency)
+{
+    zassert_ok(vbus_uart_tx_init(&test_tx, test_uart, test_ring_buffer, sizeof(test_ring_buffer),
+                                 watermark, max_latency, TEST_CHUNK_SIZE, NULL));
+}
+
+static void start_tx(uint32_t watermark, k_timeout_t max_latency)
+{
+    init_tx(watermark, max_latency);
+    zassert_ok(vbus_uart_tx_start(&test_tx));
+}
+
+static uint32_t sent_bytes(uint8_t *data, uint32_t size)
+{
+    return uart_emul_get_tx_data(test_uart, data, size);
+}
+
+static void after_each(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    vbus_uart_tx_stop(&test_tx);
+    uart_emul_flush_tx_data(test_uart);
+}
+
+ZTEST_SUITE(vbus_uart_tx_tests, NULL, NULL, NULL, after_each, NULL);
+
+ZTEST(vbus_uart_tx_tests, test_watermark_starts_transmission)
+{
+    uint8_t payload_a[] = {'W', 'A', 'T', 'E', 'R', 'M', 'A', 'R'};
+    uint8_t payload_b[] = {'K', 'S', 'E', 'N', 'D', 'N', 'O', 'W'};
+    struct vbus_frame frame_a = {.channel_idx = 1, .size = sizeof(payload_a), .data = payload_a};
+    struct vbus_frame frame_b = {.channel_idx = 2, .size = sizeof(payload_b), .data = payload_b};
+    const struct vbus_frame *frames[] = {&frame_a, &frame_b};
+    uint8_t expected[64];
+    uint8_t sent[64];
+    uint32_t expected_size;
+
+    zassert_ok(vbus_frame_encode_to(frames, ARRAY_SIZE(frames), expected, sizeof(expected),
+                                    &expected_size));
+
+    start_tx(16, K_SECONDS(1));
+    zassert_ok(vbus_uart_tx_send(&test_tx, &frames[0], 1));
+    zassert_ok(vbus_uart_tx_send(&test_tx, &frames[1], 1));
+
+    // well before the latency deadline
+    k_sleep(K_MSEC(10));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), expected_size);
+    zassert_mem_equal(sent, expected, expected_size);
+}
+
+ZTEST(vbus_uart_tx_tests, test_deadline_coalesces_small_frames)
+{
+    uint8_t sent[32];
+
+    start_tx(64, K_MSEC(50));
+    for (uint8_t i = 0; i < 3; i++) {
+        struct vbus_frame frame = {.channel_idx = i, .size = 1, .data = &i};
+        const struct vbus_frame *frame_ptr = &frame;
+
+        zassert_ok(vbus_uart_tx_send(&test_tx, &frame_ptr, 1));
+    }
+
+    // below the watermark nothing leaves until the deadline
+    k_sleep(K_MSEC(10));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), 0);
+
+    k_sleep(K_MSEC(100));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), 3 * (VBUS_FRAME_HEADER_SIZE + 1));
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t *frame = &sent[i * (VBUS_FRAME_HEADER_SIZE + 1)];
+
+        zassert_equal(frame[0], i);
+        zassert_equal(frame[VBUS_FRAME_HEADER_SIZE], i);
+    }
+}
+
+ZTEST(vbus_uart_tx_tests, test_flush)
+{
+    uint8_t sent[8];
+
+    start_tx(64, K_FOREVER);
+    zassert_ok(vbus_uart_tx_write(&test_tx, (const uint8_t *)"ack", 3));
+
+    k_sleep(K_MSEC(10));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), 0);
+
+    vbus_uart_tx_flush(&test_tx);
+    k_sleep(K_MSEC(10));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), 3);
+    zassert_mem_equal(sent, "ack", 3);
+}
+
+ZTEST(vbus_uart_tx_tests, test_full_ring_drops)
+{
+    uint8_t data[TEST_RING_SIZE];
+    uint8_t sent[2 * TEST_RING_SIZE];
+    uint8_t payload = 0;
+    struct vbus_frame frame = {.channel_idx = 0, .size = 1, .data = &payload};
+    const struct vbus_frame *frame_ptr = &frame;
+
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    // Queued before start, nothing drains the ring yet
+    init_tx(TEST_RING_SIZE, K_MSEC(10));
+    zassert_ok(vbus_uart_tx_write(&test_tx, data, sizeof(data)));
+    zassert_equal(vbus_uart_tx_write(&test_tx, data, 1), -ENOBUFS);
+    zassert_equal(vbus_uart_tx_send(&test_tx, &frame_ptr, 1), -ENOBUFS);
+    zassert_equal(test_tx.dropped, 2);
+
+    // Sent in chunks once started
+    zassert_ok(vbus_uart_tx_start(&test_tx));
+    k_sleep(K_MSEC(50));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), sizeof(data));
+    zassert_mem_equal(sent, data, sizeof(data));
+
+    zassert_ok(vbus_uart_tx_send(&test_tx, &frame_ptr, 1));
+    k_sleep(K_MSEC(50));
+    zassert_equal(sent_bytes(sent, sizeof(sent)), VBUS_FRAME_HEADER_SIZE + 1);
+}
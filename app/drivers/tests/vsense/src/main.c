@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/rtio/rtio.h>
+#include <vsense/vsense.h>
+#include <zephyr/logging/log.h>
+
+#define VSENSE_NODE DT_NODELABEL(vsense_env)
+
+LOG_MODULE_REGISTER(vsense_test, LOG_LEVEL_DBG);
+
+SENSOR_DT_READ_IODEV(test_iodev, VSENSE_NODE,
+                     {SENSOR_CHAN_AMBIENT_TEMP, 0}, {SENSOR_CHAN_HUMIDITY, 0});
+RTIO_DEFINE(test_rtio, 1, 1);
+
+static const struct device *const test_dev = DEVICE_DT_GET(VSENSE_NODE);
+
+// two samples of (temperature, humidity) with 8 fractional bits:
+// (25.5, 40.0) and (-1.0, 41.0)
+static uint8_t test_payload[] = {0x19, 0x80, 0x28, 0x00, 0xFF, 0x00, 0x29, 0x00};
+
+struct test_q31_data {
+    struct sensor_q31_data data;
+    struct sensor_q31_sample_data more_readings[1];
+};
+
+static void push_test_frame(void)
+{
+    struct vbus_frame frames[] = {
+        {.channel_idx = 1, .size = 2, .data = test_payload},
+        {.channel_idx = 3, .size = sizeof(test_payload), .data = test_payload},
+    };
+
+    zassert_equal(vsense_dispatch(frames, ARRAY_SIZE(frames)), 1);
+}
+
+ZTEST_SUITE(vsense_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(vsense_tests, test_reject_partial_sample)
+{
+    struct vbus_frame frame = {.channel_idx = 3, .size = 6, .data = test_payload};
+
+    zassert_equal(vsense_push_frame(test_dev, &frame), -EMSGSIZE);
+}
+
+ZTEST(vsense_tests, test_dispatch_by_channel)
+{
+    // vsense_env takes 4 byte samples, vsense_accel 6 byte samples
+    struct vbus_frame frames[] = {
+        {.channel_idx = 4, .size = 6, .data = test_payload},
+        {.channel_idx = 4, .size = 4, .data = test_payload},
+        {.channel_idx = 3, .size = 4, .data = test_payload},
+        {.channel_idx = 7, .size = 4, .data = test_payload},
+    };
+
+    zassert_equal(vsense_dispatch(frames, ARRAY_SIZE(frames)), 2);
+}
+
+ZTEST(vsense_tests, test_read_and_decode_frame)
+{
+    uint8_t buf[128];
+    const struct sensor_decoder_api *decoder;
+    struct test_q31_data out;
+    uint16_t frame_count;
+    uint32_t fit = 0;
+
+    push_test_frame();
+
+    zassert_ok(sensor_read(&test_iodev, &test_rtio, buf, sizeof(buf)));
+    zassert_ok(sensor_get_decoder(test_dev, &decoder));
+
+    struct sensor_chan_spec temp = {SENSOR_CHAN_AMBIENT_TEMP, 0};
+    struct sensor_chan_spec humidity = {SENSOR_CHAN_HUMIDITY, 0};
+    struct sensor_chan_spec pressure = {SENSOR_CHAN_PRESS, 0};
+
+    zassert_ok(decoder->get_frame_count(buf, temp, &frame_count));
+    zassert_equal(frame_count, 2);
+    zassert_equal(decoder->get_frame_count(buf, pressure, &frame_count), -ENOTSUP);
+
+    // the whole frame converts in one call
+    zassert_equal(decoder->decode(buf, temp, &fit, 2, &out), 2);
+    zassert_equal(fit, 2);
+    zassert_equal(out.data.header.reading_count, 2);
+    zassert_equal(out.data.shift, 7);
+    zassert_equal(out.data.readings[0].value, 0x19800000);
+    zassert_equal(out.data.readings[1].value, (q31_t)0xFF000000);
+    zassert_equal(out.data.readings[1].timestamp_delta, 1000000);
+
+    fit = 0;
+    zassert_equal(decoder->decode(buf, humidity, &fit, 1, &out), 1);
+    zassert_equal(out.data.readings[0].value, 0x28000000);
+    zassert_equal(decoder->decode(buf, humidity, &fit, 1, &out), 1);
+    zassert_equal(out.data.readings[0].value, 0x29000000);
+    zassert_equal(decoder->decode(buf, humidity, &fit, 1, &out), 0);
+}
@@ -0,0 +1,185 @@
+#define DT_DRV_COMPAT vsense_vbus_sensor
+
+#include <vsense/vsense.h>
+#include <dt-bindings/vsense/vsense.h>
+#include <rtio_vbus/sample_codec.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "vsense_priv.h"
+
+LOG_MODULE_REGISTER(vsense, CONFIG_SENSOR_LOG_LEVEL);
+
+BUILD_ASSERT(VSENSE_CHAN_ACCEL_X == SENSOR_CHAN_ACCEL_X);
+BUILD_ASSERT(VSENSE_CHAN_GYRO_X == SENSOR_CHAN_GYRO_X);
+BUILD_ASSERT(VSENSE_CHAN_MAGN_X == SENSOR_CHAN_MAGN_X);
+BUILD_ASSERT(VSENSE_CHAN_DIE_TEMP == SENSOR_CHAN_DIE_TEMP);
+BUILD_ASSERT(VSENSE_CHAN_AMBIENT_TEMP == SENSOR_CHAN_AMBIENT_TEMP);
+BUILD_ASSERT(VSENSE_CHAN_PRESS == SENSOR_CHAN_PRESS);
+BUILD_ASSERT(VSENSE_CHAN_PROX == SENSOR_CHAN_PROX);
+BUILD_ASSERT(VSENSE_CHAN_HUMIDITY == SENSOR_CHAN_HUMIDITY);
+BUILD_ASSERT(VSENSE_CHAN_LIGHT == SENSOR_CHAN_LIGHT);
+
+static bool has_channel(const struct vsense_config *config, enum sensor_channel chan_type) {
+    if (chan_type == SENSOR_CHAN_ALL) {
+        return true;
+    }
+
+    for (uint8_t i = 0; i < config->channel_count; i++) {
+        if (config->channel_types[i] == chan_type) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int vsense_push_frame(const struct device *dev, const struct vbus_frame *frame) {
+    const struct vsense_config *config = dev->config;
+    struct vsense_data *data = dev->data;
+    uint32_t sample_bytes = config->channel_count * config->sample_size;
+    int size = vbus_frame_expanded_size(frame);
+
+    if (size < 0 || (uint32_t)size > sizeof(data->frame) || size % sample_bytes != 0 ||
+        size / sample_bytes > UINT16_MAX) {
+        LOG_ERR("%s: unexpected frame size %d", dev->name, size);
+        return -EMSGSIZE;
+    }
+
+    uint32_t codec_sample_size = (frame->flags & VBUS_FRAME_FLAG_SAMPLE_32) ? 4 : 2;
+    if ((frame->flags & VBUS_FRAME_FLAG_CODEC_MASK) != VBUS_FRAME_CODEC_RAW &&
+        codec_sample_size != config->sample_size) {
+        LOG_ERR("%s: compressed sample width does not match", dev->name);
+        return -EMSGSIZE;
+    }
+
+    uint64_t timestamp_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    // Compressed payloads are expanded straight into the device copy
+    int ret = vbus_frame_expand(frame, data->frame, sizeof(data->frame));
+    if (ret >= 0) {
+        data->frame_size = ret;
+        data->timestamp_ns = timestamp_ns;
+    }
+
+    k_spin_unlock(&data->lock, key);
+    return ret < 0 ? ret : 0;
+}
+
+static void vsense_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe) {
+    const struct sensor_read_config *cfg = iodev_sqe->sqe.iodev->data;
+    const struct vsense_config *config = dev->config;
+    struct vsense_data *data = dev->data;
+
+    if (cfg->is_streaming) {
+        rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+        return;
+    }
+
+    for (size_t i = 0; i < cfg->count; i++) {
+        if (cfg->channels[i].chan_idx != 0 || !has_channel(config, cfg->channels[i].chan_type)) {
+            LOG_ERR("%s: unsupported channel %d", dev->name, cfg->channels[i].chan_type);
+            rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+            return;
+        }
+    }
+
+    uint32_t min_size = sizeof(struct vsense_encoded_header) + data->frame_size;
+    uint32_t max_size = sizeof(struct vsense_encoded_header) + sizeof(data->frame);
+    uint8_t *buf;
+    uint32_t buf_len;
+
+    int ret = rtio_sqe_rx_buf(iodev_sqe, min_size, max_size, &buf, &buf_len);
+    if (ret) {
+        LOG_ERR("%s: failed to get read buffer (%d)", dev->name, ret);
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return;
+    }
+
+    struct vsense_encoded_header *header = (struct vsense_encoded_header *)buf;
+    uint32_t sample_bytes = config->channel_count * config->sample_size;
+
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    // The frame may have grown since the buffer was sized, keep whole samples
+    uint32_t size = MIN(data->frame_size, buf_len - sizeof(*header));
+    size -= size % sample_bytes;
+    memcpy(header->payload, data->frame, size);
+    header->timestamp_ns = data->timestamp_ns;
+
+    k_spin_unlock(&data->lock, key);
+
+    if (size == 0) {
+        rtio_iodev_sqe_err(iodev_sqe, -ENODATA);
+        return;
+    }
+
+    header->sample_period_ns = config->sample_period_ns;
+    header->sample_count = size / sample_bytes;
+    header->sample_size = config->sample_size;
+    header->frac_bits = config->frac_bits;
+    header->channel_count = config->channel_count;
+    memcpy(header->channel_types, config->channel_types, sizeof(header->channel_types));
+
+    rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+static const struct sensor_driver_api vsense_api = {
+    .submit = vsense_submit,
+    .get_decoder = vsense_get_decoder,
+};
+
+#define VSENSE_CHANNEL_ENTRY(inst) [DT_INST_PROP(inst, vbus_channel)] = DEVICE_DT_INST_GET(inst),
+
+// Built from devicetree, dispatching a frame is one lookup by channel index
+static const struct device *const vsense_channel_devices[VSENSE_VBUS_CHANNEL_COUNT] = {
+    DT_INST_FOREACH_STATUS_OKAY(VSENSE_CHANNEL_ENTRY)
+};
+
+uint32_t vsense_dispatch(const struct vbus_frame *frames, uint32_t frame_count) {
+    uint32_t accepted = 0;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const struct device *dev = vsense_channel_devices[frames[i].channel_idx];
+
+        if (dev && vsense_push_frame(dev, &frames[i]) == 0) {
+            accepted++;
+        }
+    }
+
+    return accepted;
+}
+
+#define VSENSE_SAME_CHANNEL(inst, channel) +(DT_INST_PROP(inst, vbus_channel) == (channel))
+
+#define VSENSE_DEFINE(inst)                                                             \
+    BUILD_ASSERT(DT_INST_PROP_LEN(inst, sensor_channels) <=                             \
+                 CONFIG_APP_DRIVERS_VSENSE_MAX_CHANNELS,                                \
+                 "Too many sensor channels, raise CONFIG_APP_DRIVERS_VSENSE_MAX_CHANNELS"); \
+    BUILD_ASSERT(DT_INST_PROP(inst, vbus_channel) < VSENSE_VBUS_CHANNEL_COUNT,          \
+                 "vbus-channel out of range");                                          \
+    BUILD_ASSERT((0 DT_INST_FOREACH_STATUS_OKAY_VARGS(VSENSE_SAME_CHANNEL,              \
+                                                      DT_INST_PROP(inst, vbus_channel))) == 1, \
+                 "Only one vsense device per vbus channel");                            \
+                                                                                        \
+    static struct vsense_data vsense_data_##inst;                                       \
+                                                                                        \
+    static const struct vsense_config vsense_config_##inst = {                          \
+        .vbus_channel = DT_INST_PROP(inst, vbus_channel),                               \
+        .sample_size = DT_INST_PROP(inst, sample_size),                                 \
+        .frac_bits = DT_INST_PROP(inst, fractional_bits),                               \
+        .channel_count = DT_INST_PROP_LEN(inst, sensor_channels),                       \
+        .sample_period_ns = DT_INST_PROP(inst, sample_period_us) * NSEC_PER_USEC,       \
+        .channel_types = DT_INST_PROP(inst, sensor_channels),                           \
+    };                                                                                  \
+                                                                                        \
+    SENSOR_DEVICE_DT_INST_DEFINE(inst, NULL, NULL, &vsense_data_##inst,                 \
+                                 &vsense_config_##inst, POST_KERNEL,                    \
+                                 CONFIG_SENSOR_INIT_PRIORITY, &vsense_api);
+
+DT_INST_FOREACH_STATUS_OKAY(VSENSE_DEFINE)
@@ -0,0 +1,108 @@
+#define DT_DRV_COMPAT vsense_vbus_sensor
+
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include "vsense_priv.h"
+
+static int channel_index(const struct vsense_encoded_header *header,
+                         struct sensor_chan_spec chan_spec) {
+    if (chan_spec.chan_idx != 0) {
+        return -ENOTSUP;
+    }
+
+    for (uint8_t i = 0; i < header->channel_count; i++) {
+        if (header->channel_types[i] == chan_spec.chan_type) {
+            return i;
+        }
+    }
+
+    return -ENOTSUP;
+}
+
+static int vsense_decoder_get_frame_count(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+                                          uint16_t *frame_count) {
+    const struct vsense_encoded_header *header = (const struct vsense_encoded_header *)buffer;
+
+    if (channel_index(header, chan_spec) < 0) {
+        return -ENOTSUP;
+    }
+
+    *frame_count = header->sample_count;
+    return 0;
+}
+
+static int vsense_decoder_get_size_info(struct sensor_chan_spec chan_spec, size_t *base_size,
+                                        size_t *frame_size) {
+    ARG_UNUSED(chan_spec);
+
+    *base_size = sizeof(struct sensor_q31_data);
+    *frame_size = sizeof(struct sensor_q31_sample_data);
+    return 0;
+}
+
+/*
+* Values are signed fixed point numbers with frac_bits fractional bits. With
+* shift = bits - 1 - frac_bits the q31 value is the raw value moved to the top
+* of the word, so a whole frame converts with one shift per value.
+*/
+static int vsense_decoder_decode(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+                                 uint32_t *fit, uint16_t max_count, void *data_out) {
+    const struct vsense_encoded_header *header = (const struct vsense_encoded_header *)buffer;
+    struct sensor_q31_data *out = data_out;
+
+    int idx = channel_index(header, chan_spec);
+    if (idx < 0) {
+        return idx;
+    }
+
+    if (*fit >= header->sample_count || max_count == 0) {
+        return 0;
+    }
+
+    uint16_t count = MIN(max_count, header->sample_count - *fit);
+    uint32_t stride = header->channel_count * header->sample_size;
+    const uint8_t *value = header->payload + *fit * stride + idx * header->sample_size;
+
+    out->header.base_timestamp_ns = header->timestamp_ns +
+                                    (uint64_t)*fit * header->sample_period_ns;
+    out->header.reading_count = count;
+    out->shift = header->sample_size * 8 - 1 - header->frac_bits;
+
+    if (header->sample_size == sizeof(int16_t)) {
+        for (uint16_t i = 0; i < count; i++, value += stride) {
+            out->readings[i].timestamp_delta = i * header->sample_period_ns;
+            out->readings[i].value = (q31_t)((uint32_t)sys_get_be16(value) << 16);
+        }
+    } else {
+        for (uint16_t i = 0; i < count; i++, value += stride) {
+            out->readings[i].timestamp_delta = i * header->sample_period_ns;
+            out->readings[i].value = (q31_t)sys_get_be32(value);
+        }
+    }
+
+    *fit += count;
+    return count;
+}
+
+static bool vsense_decoder_has_trigger(const uint8_t *buffer, enum sensor_trigger_type trigger) {
+    ARG_UNUSED(buffer);
+    ARG_UNUSED(trigger);
+
+    return false;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+    .get_frame_count = vsense_decoder_get_frame_count,
+    .get_size_info = vsense_decoder_get_size_info,
+    .decode = vsense_decoder_decode,
+    .has_trigger = vsense_decoder_has_trigger,
+};
+
+int vsense_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder) {
+    ARG_UNUSED(dev);
+
+    *decoder = &SENSOR_DECODER_NAME();
+    return 0;
+}
@@ -0,0 +1,47 @@
+
+
+#ifndef ZEPHYR_DRIVER_VSENSE_PRIV_H
+#define ZEPHYR_DRIVER_VSENSE_PRIV_H
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/spinlock.h>
+
+// Channel indices are one byte in the frame headers
+#define VSENSE_VBUS_CHANNEL_COUNT 256
+
+/*
+* Layout of the buffer produced by a read submission. The raw frame payload
+* follows the header unchanged and is only converted by the decoder.
+*/
+struct vsense_encoded_header {
+    uint64_t timestamp_ns;
+    uint32_t sample_period_ns;
+    uint16_t sample_count;
+    uint8_t sample_size;
+    uint8_t frac_bits;
+    uint8_t channel_count;
+    uint16_t channel_types[CONFIG_APP_DRIVERS_VSENSE_MAX_CHANNELS];
+    uint8_t payload[];
+};
+
+struct vsense_config {
+    uint8_t vbus_channel;
+    uint8_t sample_size;
+    uint8_t frac_bits;
+    uint8_t channel_count;
+    uint32_t sample_period_ns;
+    uint16_t channel_types[CONFIG_APP_DRIVERS_VSENSE_MAX_CHANNELS];
+};
+
+struct vsense_data {
+    struct k_spinlock lock;
+    uint64_t timestamp_ns;
+    uint32_t frame_size;
+    uint8_t frame[CONFIG_APP_DRIVERS_VSENSE_FRAME_SIZE];
+};
+
+int vsense_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder);
+
+#endif
@@ -0,0 +1,57 @@
+
+
+#ifndef VBUS_HOST_FLOW_H
+#define VBUS_HOST_FLOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vbus_host/frame.h>
+
+/*
+* Host side of the credit based flow control of rtio_vbus/flow_ctrl.h. The
+* device sends v1 frames on VBUS_HOST_FLOW_CHANNEL with the payload
+* received(4) limit(4), both big endian and wrapping at 32 bits. The host
+* may send up to stream offset limit.
+*/
+#define VBUS_HOST_FLOW_CHANNEL 0xFF
+#define VBUS_HOST_FLOW_CREDIT_SIZE 8
+
+struct vbus_host_flow {
+    /* Set by the first credit, nothing may be sent before */
+    bool synced;
+    uint32_t sent;
+    uint32_t limit;
+    uint64_t credits;
+    /* Parser of the device to host stream */
+    uint8_t header[VBUS_HOST_FRAME_HEADER_SIZE];
+    uint8_t payload[VBUS_HOST_FLOW_CREDIT_SIZE];
+    size_t pos;
+};
+
+void vbus_host_flow_init(struct vbus_host_flow *flow);
+
+/*
+* Parse bytes read from the device. Credit frames move the limit, frames on
+* other channels are skipped. Returns the number of credits found.
+*/
+size_t vbus_host_flow_feed(struct vbus_host_flow *flow, const uint8_t *data, size_t size);
+
+/*
+* Bytes that may be sent now, 0 until the first credit arrived.
+*/
+size_t vbus_host_flow_window(const struct vbus_host_flow *flow);
+
+/*
+* Account for size bytes written to the device, at most the window.
+*/
+void vbus_host_flow_sent(struct vbus_host_flow *flow, size_t size);
+
+/*
+* Encode a credit frame, as the device does. Used by device simulations.
+*/
+void vbus_host_flow_credit_encode(uint32_t received, uint32_t limit,
+                                  uint8_t out[VBUS_HOST_FRAME_HEADER_SIZE +
+                                              VBUS_HOST_FLOW_CREDIT_SIZE]);
+
+#endif
@@ -0,0 +1,26 @@
+
+
+#ifndef VBUS_HOST_FRAME_H
+#define VBUS_HOST_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Host side of the v1 wire format: channel(1) size(2, big endian) payload.
+* Matches rtio_vbus/data_frame.h on the device.
+*/
+#define VBUS_HOST_FRAME_HEADER_SIZE 3
+#define VBUS_HOST_FRAME_MAX_PAYLOAD 0xFFFF
+
+void vbus_host_frame_header(uint8_t channel, uint16_t size,
+                            uint8_t header[VBUS_HOST_FRAME_HEADER_SIZE]);
+
+/*
+* Encode one frame into out. Returns the encoded size, or 0 if capacity is
+* too small.
+*/
+size_t vbus_host_frame_encode(uint8_t channel, const uint8_t *data, uint16_t size,
+                              uint8_t *out, size_t capacity);
+
+#endif
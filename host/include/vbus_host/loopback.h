@@ -0,0 +1,83 @@
+#ifndef VBUS_HOST_LOOPBACK_H
+#define VBUS_HOST_LOOPBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+* Round trip benchmark against the loopback firmware of
+* app/drivers/tests/rtio_vbus/loopback. Every frame sent on the channel
+* starts with its big endian 32 bit sequence number. The device answers on
+* the same channel with frames whose payload is the sequence numbers of the
+* frames it decoded, VBUS_LOOPBACK_SEQ_SIZE bytes each.
+*/
+#define VBUS_LOOPBACK_SEQ_SIZE 4
+
+struct vbus_loopback_config {
+    uint8_t channel;
+    /* Sequence number of the first frame, steps on one stream should not overlap */
+    uint32_t first_seq;
+    /* At least VBUS_LOOPBACK_SEQ_SIZE, the rest is filler */
+    uint16_t payload_size;
+    /* Frames per second, 0 sends as fast as the link takes them */
+    uint32_t rate;
+    uint32_t duration_ms;
+    /* Time to wait for the last echoes once everything is sent */
+    uint32_t drain_ms;
+    /* Upper bound of bytes per write */
+    uint32_t max_batch_bytes;
+    /* Only send within the credits of the device */
+    bool flow_control;
+    /* Give up when no credit arrives for this long while the window is closed */
+    uint32_t credit_timeout_ms;
+    /* Set from a signal handler to stop early */
+    volatile bool *stop;
+};
+
+#define VBUS_LOOPBACK_CONFIG_DEFAULT                                                 \
+    {                                                                                \
+        .channel = 1, .first_seq = 0, .payload_size = 64, .rate = 1000, .duration_ms = 2000,         \
+        .drain_ms = 500, .max_batch_bytes = 4096, .flow_control = false,             \
+        .credit_timeout_ms = 1000, .stop = NULL,                                     \
+    }
+
+/*
+* A frame counts as sent once its last byte was written, round trip times
+* run from there to the read that returned its echo. Frames without an
+* echo by the end of the drain time are dropped. Throughput counts echoed
+* frames only, over the time from the first write to the last echo.
+*/
+struct vbus_loopback_stats {
+    uint32_t rate;
+    uint64_t sent;
+    uint64_t echoed;
+    /* Echoes of unknown or already echoed sequence numbers */
+    uint64_t unexpected;
+    uint64_t echoed_bytes;
+    uint64_t elapsed_ns;
+    uint64_t rtt_min_ns;
+    uint64_t rtt_p50_ns;
+    uint64_t rtt_p99_ns;
+    uint64_t rtt_p999_ns;
+    uint64_t rtt_max_ns;
+    uint64_t credits;
+};
+
+/*
+* Run one step at config->rate. fd must be readable and writable, it is
+* switched to non-blocking mode for the run, so the echoes are read while
+* the device holds off writes, and gets its file status flags back after. Returns 0, a negative errno from the I/O path or, with
+* flow control, -ETIMEDOUT if the device stopped sending credits.
+*/
+int vbus_loopback_run(int fd, const struct vbus_loopback_config *config,
+                      struct vbus_loopback_stats *stats);
+
+void vbus_loopback_report_header(FILE *out);
+
+/*
+* One line per step, below vbus_loopback_report_header().
+*/
+void vbus_loopback_report(FILE *out, const struct vbus_loopback_stats *stats);
+
+#endif
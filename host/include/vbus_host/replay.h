@@ -0,0 +1,72 @@
+
+
+#ifndef VBUS_HOST_REPLAY_H
+#define VBUS_HOST_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vbus_host/trace.h>
+
+struct vbus_replay_config {
+    /* Real time factor, 2.0 replays twice as fast. 0 sends as fast as possible */
+    double rate;
+    /* Frames due within this window after the first one share a write */
+    uint32_t batch_window_us;
+    /* Upper bound of bytes per write */
+    uint32_t max_batch_bytes;
+    /* Number of times the trace is sent, 0 repeats until stopped */
+    uint32_t loops;
+    /* Frames written later than this after their due time count as late */
+    uint32_t late_threshold_us;
+    /* Only send within the credits of the device, fd must be readable */
+    bool flow_control;
+    /* Give up when no credit arrives for this long while the window is closed */
+    uint32_t credit_timeout_ms;
+    /* Set from a signal handler to stop after the current write */
+    volatile bool *stop;
+};
+
+#define VBUS_REPLAY_CONFIG_DEFAULT                                                   \
+    {                                                                                \
+        .rate = 1.0, .batch_window_us = 1000, .max_batch_bytes = 4096, .loops = 1,   \
+        .late_threshold_us = 5000, .flow_control = false, .credit_timeout_ms = 1000, \
+        .stop = NULL,                                                                \
+    }
+
+/*
+* Lateness is split by cause: wakeup lag is how late the host woke up for a
+* batch, write block time is how long the write then waited for the tty to
+* drain, i.e. for the device to keep up. With flow control, the part of it
+* spent waiting for credits is also counted as credit wait.
+*/
+struct vbus_replay_stats {
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t writes;
+    uint64_t elapsed_ns;
+    uint64_t trace_duration_ns;
+    uint64_t wakeup_lag_sum_ns;
+    uint64_t wakeup_lag_max_ns;
+    uint64_t write_block_sum_ns;
+    uint64_t write_block_max_ns;
+    uint64_t frame_lag_max_ns;
+    uint64_t late_frames;
+    uint64_t credits;
+    uint64_t credit_waits;
+    uint64_t credit_wait_sum_ns;
+    uint64_t credit_wait_max_ns;
+};
+
+/*
+* Stream the trace to fd, which may be a tty, a pipe or a file. Returns 0,
+* a negative errno from the write path or, with flow control, -ETIMEDOUT if
+* the device stopped sending credits.
+*/
+int vbus_replay_run(int fd, const struct vbus_trace *trace, const struct vbus_replay_config *config,
+                    struct vbus_replay_stats *stats);
+
+void vbus_replay_report(FILE *out, const struct vbus_replay_config *config,
+                        const struct vbus_replay_stats *stats);
+
+#endif
@@ -0,0 +1,65 @@
+
+
+#ifndef VBUS_HOST_TRACE_H
+#define VBUS_HOST_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* One recorded frame. Timestamps are relative to the trace start and are
+* used to pace the replay.
+*/
+struct vbus_trace_record {
+    uint64_t timestamp_us;
+    uint8_t channel;
+    uint16_t size;
+    uint8_t *data;
+};
+
+struct vbus_trace {
+    struct vbus_trace_record *records;
+    size_t count;
+    size_t capacity;
+    uint8_t *storage;
+    size_t storage_size;
+    size_t storage_capacity;
+};
+
+/*
+* Binary trace layout, all integers little endian:
+*
+*   magic "VBTR", uint16 version (1), uint16 reserved
+*   records: uint64 timestamp_us, uint8 channel, uint16 size, payload
+*/
+#define VBUS_TRACE_MAGIC "VBTR"
+#define VBUS_TRACE_VERSION 1
+
+void vbus_trace_init(struct vbus_trace *trace);
+void vbus_trace_free(struct vbus_trace *trace);
+
+/*
+* Append a record, copying its payload. Timestamps must not go backwards.
+*/
+int vbus_trace_append(struct vbus_trace *trace, uint64_t timestamp_us, uint8_t channel,
+                      const uint8_t *data, uint16_t size);
+
+/*
+* CSV traces have one frame per line: timestamp_us,channel,value,...
+* Values are integers stored big endian with sample_size (2 or 4) bytes
+* each, the layout vsense devices expect. Empty lines and lines starting
+* with '#' are skipped. Errors report the offending line through line_no.
+*/
+int vbus_trace_load_csv(const char *path, int sample_size, struct vbus_trace *trace,
+                        size_t *line_no);
+
+int vbus_trace_load_binary(const char *path, struct vbus_trace *trace);
+int vbus_trace_save_binary(const char *path, const struct vbus_trace *trace);
+
+/*
+* Load either format, binary traces are recognized by their magic.
+*/
+int vbus_trace_load(const char *path, int sample_size, struct vbus_trace *trace,
+                    size_t *line_no);
+
+#endif
@@ -0,0 +1,14 @@
+
+
+#ifndef VBUS_HOST_TTY_H
+#define VBUS_HOST_TTY_H
+
+/*
+* Open a tty for writing, and for reading its credits when flow control is
+* used, and switch it to raw mode. baud is only relevant for real UARTs,
+* CDC-ACM ignores it. Returns the fd, -ENOENT for a missing path, -ENOTTY
+* for anything but a tty, or another negative errno.
+*/
+int vbus_tty_open(const char *path, int baud);
+
+#endif
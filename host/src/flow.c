@@ -0,0 +1,85 @@
+#include <vbus_host/flow.h>
+
+#include <string.h>
+
+static uint32_t get_be32(const uint8_t *data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) |
+           (uint32_t)data[3];
+}
+
+static void put_be32(uint32_t value, uint8_t *out) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+void vbus_host_flow_init(struct vbus_host_flow *flow) {
+    memset(flow, 0, sizeof(*flow));
+}
+
+static void apply_credit(struct vbus_host_flow *flow, uint32_t received, uint32_t limit) {
+    if (!flow->synced) {
+        // Nothing sent yet, so the device has seen all of our stream
+        flow->sent = received;
+        flow->limit = limit;
+        flow->synced = true;
+    } else if ((int32_t)(limit - flow->limit) > 0) {
+        // Older credits overtaken by a newer one are ignored
+        flow->limit = limit;
+    }
+
+    flow->credits++;
+}
+
+size_t vbus_host_flow_feed(struct vbus_host_flow *flow, const uint8_t *data, size_t size) {
+    size_t credits = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        if (flow->pos < VBUS_HOST_FRAME_HEADER_SIZE) {
+            flow->header[flow->pos++] = data[i];
+        } else {
+            size_t offset = flow->pos++ - VBUS_HOST_FRAME_HEADER_SIZE;
+
+            if (offset < VBUS_HOST_FLOW_CREDIT_SIZE) {
+                flow->payload[offset] = data[i];
+            }
+        }
+
+        if (flow->pos < VBUS_HOST_FRAME_HEADER_SIZE) {
+            continue;
+        }
+
+        size_t payload_size = ((size_t)flow->header[1] << 8) | flow->header[2];
+        if (flow->pos < VBUS_HOST_FRAME_HEADER_SIZE + payload_size) {
+            continue;
+        }
+
+        if (flow->header[0] == VBUS_HOST_FLOW_CHANNEL &&
+            payload_size == VBUS_HOST_FLOW_CREDIT_SIZE) {
+            apply_credit(flow, get_be32(flow->payload), get_be32(&flow->payload[4]));
+            credits++;
+        }
+        flow->pos = 0;
+    }
+
+    return credits;
+}
+
+size_t vbus_host_flow_window(const struct vbus_host_flow *flow) {
+    int32_t window = (int32_t)(flow->limit - flow->sent);
+
+    return flow->synced && window > 0 ? (size_t)window : 0;
+}
+
+void vbus_host_flow_sent(struct vbus_host_flow *flow, size_t size) {
+    flow->sent += (uint32_t)size;
+}
+
+void vbus_host_flow_credit_encode(uint32_t received, uint32_t limit,
+                                  uint8_t out[VBUS_HOST_FRAME_HEADER_SIZE +
+                                              VBUS_HOST_FLOW_CREDIT_SIZE]) {
+    vbus_host_frame_header(VBUS_HOST_FLOW_CHANNEL, VBUS_HOST_FLOW_CREDIT_SIZE, out);
+    put_be32(received, &out[VBUS_HOST_FRAME_HEADER_SIZE]);
+    put_be32(limit, &out[VBUS_HOST_FRAME_HEADER_SIZE + 4]);
+}
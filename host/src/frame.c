@@ -0,0 +1,26 @@
+#include <vbus_host/frame.h>
+
+#include <string.h>
+
+void vbus_host_frame_header(uint8_t channel, uint16_t size,
+                            uint8_t header[VBUS_HOST_FRAME_HEADER_SIZE]) {
+    header[0] = channel;
+    header[1] = (uint8_t)(size >> 8);
+    header[2] = (uint8_t)size;
+}
+
+size_t vbus_host_frame_encode(uint8_t channel, const uint8_t *data, uint16_t size,
+                              uint8_t *out, size_t capacity) {
+    size_t frame_size = VBUS_HOST_FRAME_HEADER_SIZE + size;
+
+    if (frame_size > capacity) {
+        return 0;
+    }
+
+    vbus_host_frame_header(channel, size, out);
+    if (size > 0) {
+        memcpy(&out[VBUS_HOST_FRAME_HEADER_SIZE], data, size);
+    }
+
+    return frame_size;
+}
@@ -0,0 +1,425 @@
+#include <vbus_host/loopback.h>
+#include <vbus_host/flow.h>
+#include <vbus_host/frame.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC 1000000000ULL
+// Longest sleep of the I/O loop, bounds how late deadlines are noticed
+#define MAX_WAIT_NS NSEC_PER_MSEC
+
+struct loopback {
+    const struct vbus_loopback_config *config;
+    struct vbus_loopback_stats *stats;
+    size_t frame_size;
+    /* Write time per frame of the step, 0 once echoed */
+    uint64_t *sent_ns;
+    uint64_t *rtt_ns;
+    size_t capacity;
+    uint32_t generated;
+    /* Encoded frames not written yet */
+    uint8_t *out;
+    size_t out_size;
+    size_t out_pos;
+    uint64_t written;
+    struct vbus_host_flow flow;
+    /* Parser of the echo stream */
+    uint8_t header[VBUS_HOST_FRAME_HEADER_SIZE];
+    uint8_t seq[VBUS_LOOPBACK_SEQ_SIZE];
+    size_t pos;
+    size_t payload_size;
+    uint64_t first_write_ns;
+    uint64_t last_echo_ns;
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t get_be32(const uint8_t *data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) |
+           (uint32_t)data[3];
+}
+
+static void put_be32(uint32_t value, uint8_t *out) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+static int reserve(struct loopback *lb, size_t count) {
+    if (count <= lb->capacity) {
+        return 0;
+    }
+
+    size_t capacity = lb->capacity ? lb->capacity : 1024;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    uint64_t *sent_ns = realloc(lb->sent_ns, capacity * sizeof(*sent_ns));
+    if (!sent_ns) {
+        return -ENOMEM;
+    }
+    lb->sent_ns = sent_ns;
+
+    uint64_t *rtt_ns = realloc(lb->rtt_ns, capacity * sizeof(*rtt_ns));
+    if (!rtt_ns) {
+        return -ENOMEM;
+    }
+    lb->rtt_ns = rtt_ns;
+
+    lb->capacity = capacity;
+    return 0;
+}
+
+// Refill the empty output buffer with the frames due by now
+static int generate(struct loopback *lb, uint32_t due) {
+    uint32_t count = due - lb->generated;
+    size_t batch_frames = lb->config->max_batch_bytes / lb->frame_size;
+
+    if (batch_frames == 0) {
+        batch_frames = 1;
+    }
+    if (count > batch_frames) {
+        count = (uint32_t)batch_frames;
+    }
+
+    int ret = reserve(lb, (size_t)lb->generated + count);
+    if (ret) {
+        return ret;
+    }
+
+    uint8_t *frame = lb->out;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t idx = lb->generated++;
+        uint32_t seq = lb->config->first_seq + idx;
+
+        vbus_host_frame_header(lb->config->channel, lb->config->payload_size, frame);
+        uint8_t *payload = frame + VBUS_HOST_FRAME_HEADER_SIZE;
+        put_be32(seq, payload);
+        memset(payload + VBUS_LOOPBACK_SEQ_SIZE, (uint8_t)seq,
+               lb->config->payload_size - VBUS_LOOPBACK_SEQ_SIZE);
+        lb->sent_ns[idx] = 0;
+        frame += lb->frame_size;
+    }
+
+    lb->out_size = count * lb->frame_size;
+    lb->out_pos = 0;
+    return 0;
+}
+
+static void on_echo(struct loopback *lb, uint32_t seq, uint64_t t_ns) {
+    struct vbus_loopback_stats *stats = lb->stats;
+    // Wraps for echoes of earlier steps, which then count as unexpected
+    uint32_t idx = seq - lb->config->first_seq;
+
+    if (idx >= stats->sent || lb->sent_ns[idx] == 0) {
+        stats->unexpected++;
+        return;
+    }
+
+    lb->rtt_ns[stats->echoed++] = t_ns - lb->sent_ns[idx];
+    lb->sent_ns[idx] = 0;
+    lb->last_echo_ns = t_ns;
+}
+
+static void parse_echoes(struct loopback *lb, const uint8_t *data, size_t size, uint64_t t_ns) {
+    for (size_t i = 0; i < size; i++) {
+        if (lb->pos < VBUS_HOST_FRAME_HEADER_SIZE) {
+            lb->header[lb->pos++] = data[i];
+            if (lb->pos == VBUS_HOST_FRAME_HEADER_SIZE) {
+                lb->payload_size = ((size_t)lb->header[1] << 8) | lb->header[2];
+                if (lb->payload_size == 0) {
+                    lb->pos = 0;
+                }
+            }
+            continue;
+        }
+
+        size_t offset = lb->pos++ - VBUS_HOST_FRAME_HEADER_SIZE;
+
+        // Credits and other channels are skipped, a trailing partial
+        // sequence number is ignored
+        if (lb->header[0] == lb->config->channel) {
+            lb->seq[offset % VBUS_LOOPBACK_SEQ_SIZE] = data[i];
+            if (offset % VBUS_LOOPBACK_SEQ_SIZE == VBUS_LOOPBACK_SEQ_SIZE - 1) {
+                on_echo(lb, get_be32(lb->seq), t_ns);
+            }
+        }
+
+        if (lb->pos == VBUS_HOST_FRAME_HEADER_SIZE + lb->payload_size) {
+            lb->pos = 0;
+        }
+    }
+}
+
+static int read_echoes(int fd, struct loopback *lb) {
+    uint8_t buf[4096];
+
+    while (1) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (n == 0) {
+            return -EPIPE;
+        }
+
+        uint64_t t_ns = now_ns();
+        parse_echoes(lb, buf, (size_t)n, t_ns);
+        if (lb->config->flow_control) {
+            lb->stats->credits += vbus_host_flow_feed(&lb->flow, buf, (size_t)n);
+        }
+    }
+}
+
+static int write_frames(int fd, struct loopback *lb, size_t window) {
+    ssize_t n = write(fd, &lb->out[lb->out_pos], window);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -errno;
+    }
+
+    uint64_t t_ns = now_ns();
+    if (lb->written == 0) {
+        lb->first_write_ns = t_ns;
+    }
+
+    lb->out_pos += (size_t)n;
+    lb->written += (uint64_t)n;
+    if (lb->config->flow_control) {
+        vbus_host_flow_sent(&lb->flow, (size_t)n);
+    }
+
+    // Frames whose last byte went out with this write
+    uint64_t complete = lb->written / lb->frame_size;
+    while (lb->stats->sent < complete) {
+        lb->sent_ns[lb->stats->sent++] = t_ns;
+    }
+    return 0;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+// Nearest rank percentile of sorted values, in per mille
+static uint64_t percentile(const uint64_t *sorted, size_t count, uint32_t per_mille) {
+    size_t rank = (count * per_mille + 999) / 1000;
+
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void summarize(struct loopback *lb) {
+    struct vbus_loopback_stats *stats = lb->stats;
+
+    if (stats->echoed == 0) {
+        return;
+    }
+
+    qsort(lb->rtt_ns, stats->echoed, sizeof(*lb->rtt_ns), compare_u64);
+    stats->rtt_min_ns = lb->rtt_ns[0];
+    stats->rtt_p50_ns = percentile(lb->rtt_ns, stats->echoed, 500);
+    stats->rtt_p99_ns = percentile(lb->rtt_ns, stats->echoed, 990);
+    stats->rtt_p999_ns = percentile(lb->rtt_ns, stats->echoed, 999);
+    stats->rtt_max_ns = lb->rtt_ns[stats->echoed - 1];
+    stats->echoed_bytes = stats->echoed * lb->frame_size;
+    stats->elapsed_ns = lb->last_echo_ns - lb->first_write_ns;
+}
+
+static int run(int fd, struct loopback *lb) {
+    const struct vbus_loopback_config *config = lb->config;
+    uint64_t start_ns = now_ns();
+    uint64_t send_end_ns = start_ns + config->duration_ms * NSEC_PER_MSEC;
+    uint64_t drain_ns = config->drain_ms * NSEC_PER_MSEC;
+    uint64_t total = (uint64_t)config->rate * config->duration_ms / 1000;
+    uint64_t drain_start_ns = 0;
+    uint64_t credit_wait_ns = 0;
+    int ret = 0;
+
+    while (!(config->stop && *config->stop)) {
+        uint64_t t_ns = now_ns();
+        bool generating = t_ns < send_end_ns && (config->rate == 0 || lb->generated < total);
+        uint64_t wake_ns = t_ns + MAX_WAIT_NS;
+
+        if (generating && lb->out_pos == lb->out_size) {
+            uint64_t due = config->rate == 0 ? UINT32_MAX :
+                           (t_ns - start_ns) * config->rate / NSEC_PER_SEC + 1;
+
+            if (due > total && config->rate > 0) {
+                due = total;
+            }
+            if (due > lb->generated) {
+                ret = generate(lb, (uint32_t)due);
+                if (ret) {
+                    break;
+                }
+            } else {
+                uint64_t next_ns = start_ns + (uint64_t)lb->generated * NSEC_PER_SEC / config->rate;
+                wake_ns = next_ns < wake_ns ? next_ns : wake_ns;
+            }
+        }
+
+        bool pending = lb->out_pos < lb->out_size;
+        if (!generating && !pending) {
+            if (drain_start_ns == 0) {
+                drain_start_ns = t_ns;
+            }
+            if (lb->stats->echoed == lb->stats->sent || t_ns >= drain_start_ns + drain_ns) {
+                break;
+            }
+        } else if (pending && t_ns >= send_end_ns + drain_ns) {
+            // The device stopped taking frames, what is left never counts as sent
+            break;
+        }
+
+        size_t window = lb->out_size - lb->out_pos;
+        if (config->flow_control && pending) {
+            size_t credit = vbus_host_flow_window(&lb->flow);
+
+            window = credit < window ? credit : window;
+            if (window > 0) {
+                credit_wait_ns = 0;
+            } else if (credit_wait_ns == 0) {
+                credit_wait_ns = t_ns;
+            } else if (t_ns - credit_wait_ns >= config->credit_timeout_ms * NSEC_PER_MSEC) {
+                ret = -ETIMEDOUT;
+                break;
+            }
+        }
+
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        if (pending && window > 0) {
+            pfd.events |= POLLOUT;
+        }
+
+        uint64_t wait_ns = wake_ns > t_ns ? wake_ns - t_ns : 0;
+        struct timespec timeout = {
+            .tv_sec = (time_t)(wait_ns / NSEC_PER_SEC),
+            .tv_nsec = (long)(wait_ns % NSEC_PER_SEC),
+        };
+
+        int n = ppoll(&pfd, 1, &timeout, NULL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ret = -errno;
+            break;
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        if (pfd.revents & POLLIN) {
+            ret = read_echoes(fd, lb);
+            if (ret) {
+                break;
+            }
+        } else if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            ret = -EPIPE;
+            break;
+        }
+
+        if (pfd.revents & POLLOUT) {
+            ret = write_frames(fd, lb, window);
+            if (ret) {
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+int vbus_loopback_run(int fd, const struct vbus_loopback_config *config,
+                      struct vbus_loopback_stats *stats) {
+    if (fd < 0 || !config || !stats || config->payload_size < VBUS_LOOPBACK_SEQ_SIZE ||
+        config->channel == VBUS_HOST_FLOW_CHANNEL) {
+        return -EINVAL;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->rate = config->rate;
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -errno;
+    }
+
+    struct loopback lb = {
+        .config = config,
+        .stats = stats,
+        .frame_size = VBUS_HOST_FRAME_HEADER_SIZE + config->payload_size,
+    };
+    vbus_host_flow_init(&lb.flow);
+
+    size_t batch_bytes = config->max_batch_bytes > lb.frame_size ? config->max_batch_bytes :
+                                                                    lb.frame_size;
+    lb.out = malloc(batch_bytes);
+    if (!lb.out) {
+        fcntl(fd, F_SETFL, flags);
+        return -ENOMEM;
+    }
+
+    // Default timer slack would add up to 50 us to every wakeup
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    int ret = run(fd, &lb);
+    summarize(&lb);
+
+    free(lb.out);
+    free(lb.sent_ns);
+    free(lb.rtt_ns);
+    // The fd is the caller's, it leaves in the mode it came in
+    fcntl(fd, F_SETFL, flags);
+    return ret;
+}
+
+void vbus_loopback_report_header(FILE *out) {
+    fprintf(out, "%10s %10s %10s %8s %9s %10s %9s %9s %9s %9s\n", "rate", "sent", "echoed",
+            "drop %", "MB/s", "frames/s", "p50 us", "p99 us", "p999 us", "max us");
+}
+
+void vbus_loopback_report(FILE *out, const struct vbus_loopback_stats *stats) {
+    double elapsed_s = (double)stats->elapsed_ns / NSEC_PER_SEC;
+    double drop = stats->sent ? 100.0 * (double)(stats->sent - stats->echoed) / stats->sent : 0.0;
+    char rate[16];
+
+    if (stats->rate) {
+        snprintf(rate, sizeof(rate), "%u", stats->rate);
+    } else {
+        snprintf(rate, sizeof(rate), "max");
+    }
+
+    fprintf(out, "%10s %10llu %10llu %8.3f %9.3f %10.0f %9.1f %9.1f %9.1f %9.1f\n", rate,
+            (unsigned long long)stats->sent, (unsigned long long)stats->echoed, drop,
+            elapsed_s > 0 ? stats->echoed_bytes / elapsed_s / 1e6 : 0.0,
+            elapsed_s > 0 ? stats->echoed / elapsed_s : 0.0, stats->rtt_p50_ns / 1e3,
+            stats->rtt_p99_ns / 1e3, stats->rtt_p999_ns / 1e3, stats->rtt_max_ns / 1e3);
+    if (stats->unexpected > 0) {
+        fprintf(out, "%10s %llu unexpected echoes\n", "",
+                (unsigned long long)stats->unexpected);
+    }
+}
@@ -0,0 +1,354 @@
+#include <vbus_host/replay.h>
+#include <vbus_host/flow.h>
+#include <vbus_host/frame.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_USEC 1000ULL
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC 1000000000ULL
+#define BATCH_MAX_FRAMES 256
+
+struct batch {
+    struct iovec iov[2 * BATCH_MAX_FRAMES];
+    uint8_t headers[BATCH_MAX_FRAMES][VBUS_HOST_FRAME_HEADER_SIZE];
+    uint64_t due_ns[BATCH_MAX_FRAMES];
+    int iov_count;
+    size_t frame_count;
+    size_t bytes;
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t deadline_ns, const struct vbus_replay_config *config) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / NSEC_PER_SEC),
+        .tv_nsec = (long)(deadline_ns % NSEC_PER_SEC),
+    };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        if (config->stop && *config->stop) {
+            return;
+        }
+    }
+}
+
+static uint64_t due_offset_ns(const struct vbus_trace *trace, size_t idx, double rate) {
+    if (rate <= 0.0) {
+        return 0;
+    }
+
+    uint64_t offset_us = trace->records[idx].timestamp_us - trace->records[0].timestamp_us;
+    return (uint64_t)((double)offset_us * NSEC_PER_USEC / rate);
+}
+
+static void batch_add(struct batch *batch, const struct vbus_trace_record *record,
+                      uint64_t due_ns) {
+    uint8_t *header = batch->headers[batch->frame_count];
+
+    // The header goes into the batch, the payload is sent from the trace itself
+    vbus_host_frame_header(record->channel, record->size, header);
+
+    batch->iov[batch->iov_count].iov_base = header;
+    batch->iov[batch->iov_count++].iov_len = VBUS_HOST_FRAME_HEADER_SIZE;
+    if (record->size > 0) {
+        batch->iov[batch->iov_count].iov_base = record->data;
+        batch->iov[batch->iov_count++].iov_len = record->size;
+    }
+
+    batch->due_ns[batch->frame_count++] = due_ns;
+    batch->bytes += VBUS_HOST_FRAME_HEADER_SIZE + record->size;
+}
+
+static bool stop_requested(const struct vbus_replay_config *config) {
+    return config->stop && *config->stop;
+}
+
+// Returns the number of bytes read from the device, waiting up to timeout_ms
+static int read_credits(int fd, struct vbus_host_flow *flow, int timeout_ms,
+                        struct vbus_replay_stats *stats) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    uint8_t buf[256];
+
+    int ret = poll(&pfd, 1, timeout_ms);
+    if (ret <= 0) {
+        return ret < 0 && errno != EINTR ? -errno : 0;
+    }
+    if (!(pfd.revents & POLLIN)) {
+        return -EPIPE;
+    }
+
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0) {
+        return errno == EINTR || errno == EAGAIN ? 0 : -errno;
+    }
+    if (n == 0) {
+        return -EPIPE;
+    }
+
+    stats->credits += vbus_host_flow_feed(flow, buf, (size_t)n);
+    return (int)n;
+}
+
+static int wait_for_window(int fd, struct vbus_host_flow *flow,
+                           const struct vbus_replay_config *config,
+                           struct vbus_replay_stats *stats, size_t *window) {
+    int ret;
+
+    // Take in the credits that are already there without blocking
+    while ((ret = read_credits(fd, flow, 0, stats)) > 0) {
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    *window = vbus_host_flow_window(flow);
+    if (*window > 0) {
+        return 0;
+    }
+
+    uint64_t start_ns = now_ns();
+    uint64_t deadline_ns = start_ns + config->credit_timeout_ms * NSEC_PER_MSEC;
+
+    stats->credit_waits++;
+    while (*window == 0) {
+        uint64_t t_ns = now_ns();
+
+        if (stop_requested(config)) {
+            return -EINTR;
+        }
+        if (t_ns >= deadline_ns) {
+            return -ETIMEDOUT;
+        }
+
+        ret = read_credits(fd, flow, (int)((deadline_ns - t_ns + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC),
+                           stats);
+        if (ret < 0) {
+            return ret;
+        }
+        *window = vbus_host_flow_window(flow);
+    }
+
+    uint64_t wait_ns = now_ns() - start_ns;
+    stats->credit_wait_sum_ns += wait_ns;
+    if (wait_ns > stats->credit_wait_max_ns) {
+        stats->credit_wait_max_ns = wait_ns;
+    }
+    return 0;
+}
+
+static int write_batch(int fd, struct batch *batch, const struct vbus_replay_config *config,
+                       struct vbus_host_flow *flow, struct vbus_replay_stats *stats) {
+    struct iovec *iov = batch->iov;
+    int iov_count = batch->iov_count;
+
+    while (iov_count > 0) {
+        int count = iov_count;
+        size_t clipped_len = 0;
+
+        if (flow) {
+            size_t window;
+            int ret = wait_for_window(fd, flow, config, stats, &window);
+            if (ret) {
+                return ret;
+            }
+
+            // Write what fits the window, the rest waits for the next credit
+            count = 0;
+            while (count < iov_count && window >= iov[count].iov_len) {
+                window -= iov[count++].iov_len;
+            }
+            if (count < iov_count && window > 0) {
+                clipped_len = iov[count].iov_len;
+                iov[count++].iov_len = window;
+            }
+        }
+
+        ssize_t n = writev(fd, iov, count);
+        if (clipped_len) {
+            iov[count - 1].iov_len = clipped_len;
+        }
+        if (n < 0) {
+            if (errno == EINTR && !stop_requested(config)) {
+                continue;
+            }
+            return -errno;
+        }
+        if (flow) {
+            vbus_host_flow_sent(flow, (size_t)n);
+        }
+
+        // Partial write, skip what went out and retry with the rest
+        while (iov_count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+
+    return 0;
+}
+
+int vbus_replay_run(int fd, const struct vbus_trace *trace, const struct vbus_replay_config *config,
+                    struct vbus_replay_stats *stats) {
+    if (fd < 0 || !trace || !config || !stats || config->rate < 0.0 ||
+        config->max_batch_bytes == 0) {
+        return -EINVAL;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    if (trace->count == 0) {
+        return 0;
+    }
+
+    struct batch *batch = malloc(sizeof(*batch));
+    if (!batch) {
+        return -ENOMEM;
+    }
+
+    struct vbus_host_flow flow;
+    vbus_host_flow_init(&flow);
+
+    // Default timer slack would add up to 50 us to every wakeup
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    uint64_t trace_span_ns = due_offset_ns(trace, trace->count - 1, config->rate);
+    uint64_t loop_gap_ns = trace->count > 1 ? trace_span_ns / (trace->count - 1) : 0;
+    uint64_t window_ns = config->batch_window_us * NSEC_PER_USEC;
+    uint64_t late_ns = config->late_threshold_us * NSEC_PER_USEC;
+    uint64_t start_ns = now_ns();
+    uint64_t loop_start_ns = start_ns;
+    uint32_t loop = 0;
+    size_t idx = 0;
+    int ret = 0;
+
+    stats->trace_duration_ns = trace_span_ns;
+
+    while (!(config->stop && *config->stop)) {
+        uint64_t due_ns = loop_start_ns + due_offset_ns(trace, idx, config->rate);
+
+        sleep_until(due_ns, config);
+        uint64_t woke_ns = now_ns();
+        uint64_t wakeup_lag_ns = woke_ns > due_ns ? woke_ns - due_ns : 0;
+
+        // Everything due before the end of the window goes out in this write
+        batch->iov_count = 0;
+        batch->frame_count = 0;
+        batch->bytes = 0;
+        uint64_t window_end_ns = (woke_ns > due_ns ? woke_ns : due_ns) + window_ns;
+
+        while (idx < trace->count && batch->frame_count < BATCH_MAX_FRAMES) {
+            const struct vbus_trace_record *record = &trace->records[idx];
+            uint64_t record_due_ns = loop_start_ns + due_offset_ns(trace, idx, config->rate);
+            size_t frame_size = VBUS_HOST_FRAME_HEADER_SIZE + record->size;
+
+            if (batch->frame_count > 0 &&
+                (record_due_ns > window_end_ns ||
+                 batch->bytes + frame_size > config->max_batch_bytes)) {
+                break;
+            }
+
+            batch_add(batch, record, record_due_ns);
+            idx++;
+        }
+
+        ret = write_batch(fd, batch, config, config->flow_control ? &flow : NULL, stats);
+        uint64_t done_ns = now_ns();
+        if (ret) {
+            break;
+        }
+
+        uint64_t block_ns = done_ns - woke_ns;
+        stats->writes++;
+        stats->frames += batch->frame_count;
+        stats->bytes += batch->bytes;
+        stats->wakeup_lag_sum_ns += wakeup_lag_ns;
+        stats->write_block_sum_ns += block_ns;
+        if (wakeup_lag_ns > stats->wakeup_lag_max_ns) {
+            stats->wakeup_lag_max_ns = wakeup_lag_ns;
+        }
+        if (block_ns > stats->write_block_max_ns) {
+            stats->write_block_max_ns = block_ns;
+        }
+
+        for (size_t i = 0; i < batch->frame_count; i++) {
+            uint64_t lag_ns = done_ns > batch->due_ns[i] ? done_ns - batch->due_ns[i] : 0;
+
+            if (lag_ns > stats->frame_lag_max_ns) {
+                stats->frame_lag_max_ns = lag_ns;
+            }
+            if (config->rate > 0.0 && lag_ns > late_ns) {
+                stats->late_frames++;
+            }
+        }
+
+        if (idx == trace->count) {
+            idx = 0;
+            loop++;
+            if (config->loops && loop >= config->loops) {
+                break;
+            }
+            loop_start_ns += trace_span_ns + loop_gap_ns;
+        }
+    }
+
+    stats->elapsed_ns = now_ns() - start_ns;
+    free(batch);
+    return ret;
+}
+
+void vbus_replay_report(FILE *out, const struct vbus_replay_config *config,
+                        const struct vbus_replay_stats *stats) {
+    double elapsed_s = (double)stats->elapsed_ns / NSEC_PER_SEC;
+    double writes = stats->writes ? (double)stats->writes : 1.0;
+
+    fprintf(out, "frames:       %llu in %llu writes (%.1f frames/write)\n",
+            (unsigned long long)stats->frames, (unsigned long long)stats->writes,
+            (double)stats->frames / writes);
+    fprintf(out, "throughput:   %.3f MB/s, %.0f frames/s over %.3f s\n",
+            elapsed_s > 0 ? stats->bytes / elapsed_s / 1e6 : 0.0,
+            elapsed_s > 0 ? stats->frames / elapsed_s : 0.0, elapsed_s);
+
+    if (config->rate > 0.0 && stats->trace_duration_ns > 0 && stats->writes > 0) {
+        double expected_s = (double)stats->trace_duration_ns / NSEC_PER_SEC;
+        fprintf(out, "schedule:     %.3f s of trace time at x%.2f took %.3f s\n",
+                expected_s * config->rate, config->rate, elapsed_s);
+    }
+
+    fprintf(out, "wakeup lag:   avg %.1f us, max %.1f us (host)\n",
+            stats->wakeup_lag_sum_ns / writes / 1e3, stats->wakeup_lag_max_ns / 1e3);
+    fprintf(out, "write block:  avg %.1f us, max %.1f us (tty/device)\n",
+            stats->write_block_sum_ns / writes / 1e3, stats->write_block_max_ns / 1e3);
+    fprintf(out, "frame lag:    max %.1f us, %llu frames later than %u us\n",
+            stats->frame_lag_max_ns / 1e3, (unsigned long long)stats->late_frames,
+            config->late_threshold_us);
+
+    if (config->flow_control) {
+        double waits = stats->credit_waits ? (double)stats->credit_waits : 1.0;
+        fprintf(out, "credit wait:  %llu waits, avg %.1f us, max %.1f us, %llu credits\n",
+                (unsigned long long)stats->credit_waits, stats->credit_wait_sum_ns / waits / 1e3,
+                stats->credit_wait_max_ns / 1e3, (unsigned long long)stats->credits);
+    }
+
+    if (stats->late_frames > 0) {
+        fprintf(out, "behind:       mostly %s\n",
+                stats->write_block_sum_ns > stats->wakeup_lag_sum_ns ?
+                "waiting for the device to drain the tty" : "host scheduling");
+    }
+}
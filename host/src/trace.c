@@ -0,0 +1,297 @@
+#include <vbus_host/trace.h>
+#include <vbus_host/frame.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CSV_LINE_MAX 4096
+#define BINARY_HEADER_SIZE 8
+#define BINARY_RECORD_HEADER_SIZE 11
+
+void vbus_trace_init(struct vbus_trace *trace) {
+    memset(trace, 0, sizeof(*trace));
+}
+
+void vbus_trace_free(struct vbus_trace *trace) {
+    free(trace->records);
+    free(trace->storage);
+    vbus_trace_init(trace);
+}
+
+static int grow(void **buffer, size_t *capacity, size_t needed, size_t elem_size) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    void *new_buffer = realloc(*buffer, new_capacity * elem_size);
+    if (!new_buffer) {
+        return -ENOMEM;
+    }
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return 0;
+}
+
+int vbus_trace_append(struct vbus_trace *trace, uint64_t timestamp_us, uint8_t channel,
+                      const uint8_t *data, uint16_t size) {
+    if (trace->count > 0 && timestamp_us < trace->records[trace->count - 1].timestamp_us) {
+        return -EINVAL;
+    }
+
+    int ret = grow((void **)&trace->records, &trace->capacity, trace->count + 1,
+                   sizeof(*trace->records));
+    if (ret) {
+        return ret;
+    }
+
+    // Payloads live in one growing block, rebase the records when it moves
+    if (trace->storage_size + size > trace->storage_capacity) {
+        uint8_t *old_storage = trace->storage;
+
+        ret = grow((void **)&trace->storage, &trace->storage_capacity,
+                   trace->storage_size + size, 1);
+        if (ret) {
+            return ret;
+        }
+
+        size_t offset = 0;
+        for (size_t i = 0; i < trace->count && trace->storage != old_storage; i++) {
+            if (trace->records[i].size > 0) {
+                trace->records[i].data = trace->storage + offset;
+                offset += trace->records[i].size;
+            }
+        }
+    }
+
+    struct vbus_trace_record *record = &trace->records[trace->count++];
+    record->timestamp_us = timestamp_us;
+    record->channel = channel;
+    record->size = size;
+    record->data = NULL;
+    if (size > 0) {
+        record->data = trace->storage + trace->storage_size;
+        memcpy(record->data, data, size);
+        trace->storage_size += size;
+    }
+
+    return 0;
+}
+
+static void put_be(int64_t value, int sample_size, uint8_t *dst) {
+    for (int i = sample_size - 1; i >= 0; i--) {
+        dst[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+static int parse_csv_line(char *line, int sample_size, struct vbus_trace *trace) {
+    static uint8_t payload[VBUS_HOST_FRAME_MAX_PAYLOAD];
+    int64_t min = -(INT64_C(1) << (sample_size * 8 - 1));
+    int64_t max = (INT64_C(1) << (sample_size * 8)) - 1;
+    char *cursor = line;
+    char *end;
+
+    errno = 0;
+    unsigned long long timestamp = strtoull(cursor, &end, 10);
+    if (end == cursor || *end != ',' || errno) {
+        return -EINVAL;
+    }
+
+    cursor = end + 1;
+    unsigned long channel = strtoul(cursor, &end, 10);
+    if (end == cursor || channel > UINT8_MAX || errno) {
+        return -EINVAL;
+    }
+
+    size_t size = 0;
+    while (*end == ',') {
+        cursor = end + 1;
+        long long value = strtoll(cursor, &end, 0);
+        // Values may be given signed or as raw unsigned bit patterns
+        if (end == cursor || errno || value < min || value > max) {
+            return -EINVAL;
+        }
+        if (size + sample_size > sizeof(payload)) {
+            return -EMSGSIZE;
+        }
+        put_be(value, sample_size, &payload[size]);
+        size += sample_size;
+    }
+
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') {
+        end++;
+    }
+    if (*end != '\0') {
+        return -EINVAL;
+    }
+
+    return vbus_trace_append(trace, timestamp, (uint8_t)channel, payload, (uint16_t)size);
+}
+
+int vbus_trace_load_csv(const char *path, int sample_size, struct vbus_trace *trace,
+                        size_t *line_no) {
+    if (sample_size != 2 && sample_size != 4) {
+        return -EINVAL;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -errno;
+    }
+
+    char line[CSV_LINE_MAX];
+    size_t current_line = 0;
+    int ret = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        current_line++;
+
+        char *start = line + strspn(line, " \t");
+        if (*start == '#' || *start == '\n' || *start == '\r' || *start == '\0') {
+            continue;
+        }
+
+        if (!strchr(start, '\n') && !feof(file)) {
+            ret = -E2BIG;
+            break;
+        }
+
+        ret = parse_csv_line(start, sample_size, trace);
+        if (ret) {
+            break;
+        }
+    }
+
+    if (line_no) {
+        *line_no = current_line;
+    }
+
+    if (!ret && ferror(file)) {
+        ret = -EIO;
+    }
+
+    fclose(file);
+    return ret;
+}
+
+static uint64_t get_le(const uint8_t *src, int size) {
+    uint64_t value = 0;
+
+    for (int i = size - 1; i >= 0; i--) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static void put_le(uint64_t value, int size, uint8_t *dst) {
+    for (int i = 0; i < size; i++) {
+        dst[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+int vbus_trace_load_binary(const char *path, struct vbus_trace *trace) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -errno;
+    }
+
+    uint8_t header[BINARY_RECORD_HEADER_SIZE];
+    uint8_t *payload = malloc(VBUS_HOST_FRAME_MAX_PAYLOAD);
+    int ret = 0;
+
+    if (!payload) {
+        fclose(file);
+        return -ENOMEM;
+    }
+
+    if (fread(header, 1, BINARY_HEADER_SIZE, file) != BINARY_HEADER_SIZE ||
+        memcmp(header, VBUS_TRACE_MAGIC, 4) != 0 ||
+        get_le(&header[4], 2) != VBUS_TRACE_VERSION) {
+        ret = -EINVAL;
+    }
+
+    while (!ret) {
+        size_t n = fread(header, 1, BINARY_RECORD_HEADER_SIZE, file);
+        if (n == 0 && feof(file)) {
+            break;
+        }
+        if (n != BINARY_RECORD_HEADER_SIZE) {
+            ret = -EINVAL;
+            break;
+        }
+
+        uint16_t size = (uint16_t)get_le(&header[9], 2);
+        if (fread(payload, 1, size, file) != size) {
+            ret = -EINVAL;
+            break;
+        }
+
+        ret = vbus_trace_append(trace, get_le(header, 8), header[8], payload, size);
+    }
+
+    free(payload);
+    fclose(file);
+    return ret;
+}
+
+int vbus_trace_save_binary(const char *path, const struct vbus_trace *trace) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return -errno;
+    }
+
+    uint8_t header[BINARY_RECORD_HEADER_SIZE] = {0};
+    int ret = 0;
+
+    memcpy(header, VBUS_TRACE_MAGIC, 4);
+    put_le(VBUS_TRACE_VERSION, 2, &header[4]);
+    if (fwrite(header, 1, BINARY_HEADER_SIZE, file) != BINARY_HEADER_SIZE) {
+        ret = -EIO;
+    }
+
+    for (size_t i = 0; !ret && i < trace->count; i++) {
+        const struct vbus_trace_record *record = &trace->records[i];
+
+        put_le(record->timestamp_us, 8, header);
+        header[8] = record->channel;
+        put_le(record->size, 2, &header[9]);
+        if (fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+            (record->size > 0 &&
+             fwrite(record->data, 1, record->size, file) != record->size)) {
+            ret = -EIO;
+        }
+    }
+
+    if (fclose(file) && !ret) {
+        ret = -EIO;
+    }
+    return ret;
+}
+
+int vbus_trace_load(const char *path, int sample_size, struct vbus_trace *trace,
+                    size_t *line_no) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -errno;
+    }
+
+    char magic[4];
+    size_t n = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+
+    if (n == sizeof(magic) && memcmp(magic, VBUS_TRACE_MAGIC, sizeof(magic)) == 0) {
+        return vbus_trace_load_binary(path, trace);
+    }
+
+    return vbus_trace_load_csv(path, sample_size, trace, line_no);
+}
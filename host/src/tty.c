@@ -0,0 +1,62 @@
+#include <vbus_host/tty.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static speed_t baud_to_speed(int baud) {
+    switch (baud) {
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 230400:
+        return B230400;
+    case 460800:
+        return B460800;
+    case 921600:
+        return B921600;
+    case 115200:
+    default:
+        return B115200;
+    }
+}
+
+int vbus_tty_open(const char *path, int baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    // A mistyped device path must not turn into a file that takes any rate
+    if (!isatty(fd)) {
+        close(fd);
+        return -ENOTTY;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio)) {
+        int ret = -errno;
+        close(fd);
+        return ret;
+    }
+
+    // No line discipline may touch frame bytes
+    cfmakeraw(&tio);
+    cfsetospeed(&tio, baud_to_speed(baud));
+    cfsetispeed(&tio, baud_to_speed(baud));
+    tio.c_cflag |= CLOCAL;
+
+    if (tcsetattr(fd, TCSANOW, &tio)) {
+        int ret = -errno;
+        close(fd);
+        return ret;
+    }
+
+    return fd;
+}
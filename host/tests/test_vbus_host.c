@@ -0,0 +1,506 @@
+#include <vbus_host/flow.h>
+#include <vbus_host/frame.h>
+#include <vbus_host/loopback.h>
+#include <vbus_host/replay.h>
+#include <vbus_host/trace.h>
+#include <vbus_host/tty.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static int failures;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+static void write_file(const char *path, const char *content) {
+    FILE *file = fopen(path, "w");
+    fputs(content, file);
+    fclose(file);
+}
+
+static void make_path(char *path, size_t size, const char *name) {
+    const char *dir = getenv("TMPDIR");
+    snprintf(path, size, "%s/vbus_host_%d_%s", dir ? dir : "/tmp", (int)getpid(), name);
+}
+
+static void test_csv(void) {
+    char path[256];
+    struct vbus_trace trace;
+    size_t line_no;
+
+    make_path(path, sizeof(path), "trace.csv");
+    write_file(path,
+               "# timestamp_us,channel,values...\n"
+               "0,1,100,-2,0x7fff\n"
+               "\n"
+               "1000,2\n"
+               "2000,1,65535,1,2\n");
+
+    vbus_trace_init(&trace);
+    CHECK(vbus_trace_load(path, 2, &trace, &line_no) == 0);
+    CHECK(trace.count == 3);
+    CHECK(trace.records[0].channel == 1 && trace.records[0].size == 6);
+    static const uint8_t first[] = {0x00, 0x64, 0xFF, 0xFE, 0x7F, 0xFF};
+    CHECK(memcmp(trace.records[0].data, first, sizeof(first)) == 0);
+    CHECK(trace.records[1].size == 0 && trace.records[1].timestamp_us == 1000);
+    CHECK(trace.records[2].data[0] == 0xFF && trace.records[2].data[1] == 0xFF);
+    vbus_trace_free(&trace);
+
+    vbus_trace_init(&trace);
+    CHECK(vbus_trace_load_csv(path, 4, &trace, &line_no) == 0);
+    CHECK(trace.records[0].size == 12);
+    vbus_trace_free(&trace);
+
+    write_file(path, "0,1,1\n10,1,70000\n");
+    vbus_trace_init(&trace);
+    CHECK(vbus_trace_load_csv(path, 2, &trace, &line_no) == -EINVAL);
+    CHECK(line_no == 2);
+    vbus_trace_free(&trace);
+
+    write_file(path, "10,1,1\n5,1,2\n");
+    vbus_trace_init(&trace);
+    CHECK(vbus_trace_load_csv(path, 2, &trace, &line_no) == -EINVAL);
+    vbus_trace_free(&trace);
+
+    unlink(path);
+}
+
+static void test_binary_roundtrip(void) {
+    char path[256];
+    struct vbus_trace trace;
+    struct vbus_trace loaded;
+    uint8_t payload[300];
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)i;
+    }
+
+    // Enough records to move the payload storage a few times
+    vbus_trace_init(&trace);
+    for (uint32_t i = 0; i < 200; i++) {
+        CHECK(vbus_trace_append(&trace, i * 500, (uint8_t)i, payload, (uint16_t)(i % 7 * 40)) == 0);
+    }
+
+    make_path(path, sizeof(path), "trace.vbtr");
+    CHECK(vbus_trace_save_binary(path, &trace) == 0);
+
+    vbus_trace_init(&loaded);
+    CHECK(vbus_trace_load(path, 2, &loaded, NULL) == 0);
+    CHECK(loaded.count == trace.count);
+    for (size_t i = 0; i < loaded.count && i < trace.count; i++) {
+        CHECK(loaded.records[i].timestamp_us == trace.records[i].timestamp_us);
+        CHECK(loaded.records[i].channel == trace.records[i].channel);
+        CHECK(loaded.records[i].size == trace.records[i].size);
+        CHECK(loaded.records[i].size == 0 ||
+              memcmp(loaded.records[i].data, payload, loaded.records[i].size) == 0);
+    }
+
+    vbus_trace_free(&loaded);
+    vbus_trace_free(&trace);
+    unlink(path);
+}
+
+static void test_frame_encode(void) {
+    static const uint8_t data[] = {0xAA, 0xBB};
+    uint8_t out[8];
+
+    CHECK(vbus_host_frame_encode(7, data, sizeof(data), out, sizeof(out)) == 5);
+    CHECK(out[0] == 7 && out[1] == 0 && out[2] == 2 && out[3] == 0xAA && out[4] == 0xBB);
+    CHECK(vbus_host_frame_encode(7, data, sizeof(data), out, 4) == 0);
+}
+
+static void test_replay_stream(void) {
+    struct vbus_trace trace;
+    struct vbus_replay_config config = VBUS_REPLAY_CONFIG_DEFAULT;
+    struct vbus_replay_stats stats;
+    uint8_t payload[4] = {1, 2, 3, 4};
+    int fds[2];
+
+    vbus_trace_init(&trace);
+    for (uint32_t i = 0; i < 50; i++) {
+        payload[0] = (uint8_t)i;
+        CHECK(vbus_trace_append(&trace, i * 1000, (uint8_t)(i % 3), payload, sizeof(payload)) == 0);
+    }
+
+    CHECK(pipe(fds) == 0);
+
+    // 49 ms of trace at x2 take 24.5 ms, less the batch window the last
+    // frames may be sent early, and must arrive byte exact
+    config.rate = 2.0;
+    config.batch_window_us = 2000;
+    uint64_t expected_bytes = 50 * (VBUS_HOST_FRAME_HEADER_SIZE + sizeof(payload));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CHECK(vbus_replay_run(fds[1], &trace, &config, &stats) == 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    CHECK(elapsed_ms >= 22.5);
+    CHECK(stats.frames == 50);
+    CHECK(stats.bytes == expected_bytes);
+    CHECK(stats.writes < stats.frames);
+
+    uint8_t received[2048];
+    CHECK(read(fds[0], received, sizeof(received)) == (ssize_t)expected_bytes);
+    for (uint32_t i = 0; i < 50; i++) {
+        const uint8_t *frame = &received[i * 7];
+        CHECK(frame[0] == i % 3 && frame[1] == 0 && frame[2] == 4 && frame[3] == i);
+    }
+
+    // Looping as fast as possible
+    config.rate = 0.0;
+    config.loops = 3;
+    CHECK(vbus_replay_run(fds[1], &trace, &config, &stats) == 0);
+    CHECK(stats.frames == 150);
+    CHECK(read(fds[0], received, sizeof(received)) == (ssize_t)(3 * expected_bytes));
+
+    close(fds[0]);
+    close(fds[1]);
+    vbus_trace_free(&trace);
+}
+
+static void test_flow_credits(void) {
+    struct vbus_host_flow flow;
+    uint8_t stream[64];
+    size_t size = 0;
+
+    vbus_host_flow_init(&flow);
+    CHECK(vbus_host_flow_window(&flow) == 0);
+
+    // A data frame from the device in front of two credits, the second
+    // one older than the first
+    static const uint8_t data[] = {1, 2, 3};
+    size += vbus_host_frame_encode(3, data, sizeof(data), &stream[size], sizeof(stream) - size);
+    vbus_host_flow_credit_encode(0xFFFFFFF0u, 0x00000010u, &stream[size]);
+    size += VBUS_HOST_FRAME_HEADER_SIZE + VBUS_HOST_FLOW_CREDIT_SIZE;
+    vbus_host_flow_credit_encode(0xFFFFFFF0u, 0x00000008u, &stream[size]);
+    size += VBUS_HOST_FRAME_HEADER_SIZE + VBUS_HOST_FLOW_CREDIT_SIZE;
+
+    // Split at every byte boundary the parser has to resume from
+    size_t credits = 0;
+    for (size_t i = 0; i < size; i++) {
+        credits += vbus_host_flow_feed(&flow, &stream[i], 1);
+    }
+    CHECK(credits == 2);
+    CHECK(flow.credits == 2);
+
+    // The window spans the 32 bit wrap
+    CHECK(vbus_host_flow_window(&flow) == 0x20);
+    vbus_host_flow_sent(&flow, 0x18);
+    CHECK(vbus_host_flow_window(&flow) == 0x08);
+    vbus_host_flow_sent(&flow, 0x08);
+    CHECK(vbus_host_flow_window(&flow) == 0);
+
+    vbus_host_flow_credit_encode(0x00000010u, 0x00000040u, stream);
+    CHECK(vbus_host_flow_feed(&flow, stream, VBUS_HOST_FRAME_HEADER_SIZE +
+                                                 VBUS_HOST_FLOW_CREDIT_SIZE) == 1);
+    CHECK(vbus_host_flow_window(&flow) == 0x30);
+}
+
+/*
+* Device with a small receive ring that is drained far slower than the
+* host can write. Every byte that arrives while the ring is full counts as
+* an overrun.
+*/
+struct slow_device {
+    int fd;
+    size_t capacity;
+    size_t drain_per_tick;
+    size_t expected;
+    uint8_t *stream;
+    size_t received;
+    size_t consumed;
+    size_t overruns;
+    uint64_t credits;
+};
+
+static void send_credit(struct slow_device *dev) {
+    uint8_t credit[VBUS_HOST_FRAME_HEADER_SIZE + VBUS_HOST_FLOW_CREDIT_SIZE];
+
+    vbus_host_flow_credit_encode((uint32_t)dev->received,
+                                 (uint32_t)(dev->consumed + dev->capacity), credit);
+    if (write(dev->fd, credit, sizeof(credit)) == (ssize_t)sizeof(credit)) {
+        dev->credits++;
+    }
+}
+
+static void *slow_device_run(void *arg) {
+    struct slow_device *dev = arg;
+    const struct timespec tick = {.tv_nsec = 200000};
+    uint8_t buf[4096];
+    int idle_ticks = 0;
+
+    send_credit(dev);
+    while (dev->received + dev->overruns < dev->expected && idle_ticks < 5000) {
+        size_t space = dev->capacity - (dev->received - dev->consumed);
+
+        // Asking for one byte more than fits shows an overrun
+        ssize_t n = recv(dev->fd, buf, space + 1 < sizeof(buf) ? space + 1 : sizeof(buf),
+                         MSG_DONTWAIT);
+        if (n > 0) {
+            size_t accepted = (size_t)n > space ? space : (size_t)n;
+
+            memcpy(&dev->stream[dev->received], buf, accepted);
+            dev->received += accepted;
+            dev->overruns += (size_t)n - accepted;
+            idle_ticks = 0;
+        } else {
+            idle_ticks++;
+        }
+
+        nanosleep(&tick, NULL);
+        size_t buffered = dev->received - dev->consumed;
+        if (buffered > 0) {
+            dev->consumed += buffered < dev->drain_per_tick ? buffered : dev->drain_per_tick;
+            send_credit(dev);
+        }
+    }
+
+    return NULL;
+}
+
+static void run_slow_device(bool flow_control, struct slow_device *dev,
+                            struct vbus_replay_stats *stats, int *ret) {
+    struct vbus_trace trace;
+    struct vbus_replay_config config = VBUS_REPLAY_CONFIG_DEFAULT;
+    uint8_t payload[16];
+    pthread_t thread;
+    int fds[2];
+
+    vbus_trace_init(&trace);
+    for (uint32_t i = 0; i < 200; i++) {
+        memset(payload, (int)i, sizeof(payload));
+        CHECK(vbus_trace_append(&trace, i * 100, (uint8_t)(i % 4), payload, sizeof(payload)) == 0);
+    }
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    memset(dev, 0, sizeof(*dev));
+    dev->fd = fds[1];
+    dev->capacity = 128;
+    dev->drain_per_tick = 32;
+    dev->expected = 200 * (VBUS_HOST_FRAME_HEADER_SIZE + sizeof(payload));
+    dev->stream = malloc(dev->expected);
+    CHECK(pthread_create(&thread, NULL, slow_device_run, dev) == 0);
+
+    // As fast as possible, the device is the bottleneck
+    config.rate = 0.0;
+    config.flow_control = flow_control;
+    *ret = vbus_replay_run(fds[0], &trace, &config, stats);
+
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    close(fds[1]);
+    vbus_trace_free(&trace);
+}
+
+static void test_replay_flow_control(void) {
+    struct slow_device dev;
+    struct vbus_replay_stats stats;
+    int ret;
+
+    // Without credits the host runs over the ring
+    run_slow_device(false, &dev, &stats, &ret);
+    CHECK(ret == 0);
+    CHECK(dev.overruns > 0);
+    free(dev.stream);
+
+    run_slow_device(true, &dev, &stats, &ret);
+    CHECK(ret == 0);
+    CHECK(dev.overruns == 0);
+    CHECK(dev.received == dev.expected);
+    CHECK(stats.credit_waits > 0);
+    CHECK(stats.credits > 0 && stats.credits <= dev.credits);
+
+    // Byte exact, frame by frame
+    for (uint32_t i = 0; i < 200 && dev.received == dev.expected; i++) {
+        const uint8_t *frame = &dev.stream[i * (VBUS_HOST_FRAME_HEADER_SIZE + 16)];
+        CHECK(frame[0] == i % 4 && frame[1] == 0 && frame[2] == 16);
+        CHECK(frame[3] == (uint8_t)i && frame[18] == (uint8_t)i);
+    }
+    free(dev.stream);
+}
+
+/*
+* Loopback firmware stand-in: echoes the sequence numbers of every read in
+* one frame, except for frames dropped on purpose.
+*/
+struct echo_device {
+    int fd;
+    uint32_t drop_every;
+    bool flow_control;
+    volatile bool stop;
+    uint64_t frames;
+    uint64_t dropped;
+};
+
+static void *echo_device_run(void *arg) {
+    struct echo_device *dev = arg;
+    const size_t frame_size = VBUS_HOST_FRAME_HEADER_SIZE + 16;
+    uint8_t buf[4096];
+    uint8_t echo[VBUS_HOST_FRAME_HEADER_SIZE + 4096];
+    uint8_t credit[VBUS_HOST_FRAME_HEADER_SIZE + VBUS_HOST_FLOW_CREDIT_SIZE];
+    size_t pos = 0;
+    uint32_t received = 0;
+
+    // An echo that matches nothing, as left over from an earlier run
+    static const uint8_t stale[] = {0xFF, 0xFF, 0xFF, 0xFF};
+    size_t size = vbus_host_frame_encode(1, stale, sizeof(stale), echo, sizeof(echo));
+    CHECK(write(dev->fd, echo, size) == (ssize_t)size);
+
+    if (dev->flow_control) {
+        vbus_host_flow_credit_encode(0, 1 << 16, credit);
+        CHECK(write(dev->fd, credit, sizeof(credit)) == (ssize_t)sizeof(credit));
+    }
+
+    while (!dev->stop) {
+        struct pollfd pfd = {.fd = dev->fd, .events = POLLIN};
+
+        if (poll(&pfd, 1, 10) <= 0) {
+            continue;
+        }
+
+        // Leaves room to finish the frame started at pos
+        ssize_t n = read(dev->fd, &buf[pos], (sizeof(buf) - pos) / frame_size * frame_size);
+        if (n <= 0) {
+            break;
+        }
+        received += (uint32_t)n;
+        pos += (size_t)n;
+
+        size_t seqs = 0;
+        size_t frames = pos / frame_size;
+        for (size_t i = 0; i < frames; i++) {
+            const uint8_t *frame = &buf[i * frame_size];
+            const uint8_t *seq = &frame[VBUS_HOST_FRAME_HEADER_SIZE];
+
+            CHECK(frame[0] == 1 && frame[1] == 0 && frame[2] == 16);
+            dev->frames++;
+            if (dev->drop_every && seq[3] % dev->drop_every == dev->drop_every - 1) {
+                dev->dropped++;
+                continue;
+            }
+            memcpy(&echo[VBUS_HOST_FRAME_HEADER_SIZE + seqs++ * 4], seq, 4);
+        }
+        memmove(buf, &buf[frames * frame_size], pos - frames * frame_size);
+        pos -= frames * frame_size;
+
+        if (seqs > 0) {
+            vbus_host_frame_header(1, (uint16_t)(seqs * 4), echo);
+            size = VBUS_HOST_FRAME_HEADER_SIZE + seqs * 4;
+            CHECK(write(dev->fd, echo, size) == (ssize_t)size);
+        }
+        if (dev->flow_control) {
+            vbus_host_flow_credit_encode(received, received + (1 << 16), credit);
+            CHECK(write(dev->fd, credit, sizeof(credit)) == (ssize_t)sizeof(credit));
+        }
+    }
+
+    return NULL;
+}
+
+static void run_echo_device(struct echo_device *dev, const struct vbus_loopback_config *config,
+                            struct vbus_loopback_stats *stats, int *ret) {
+    pthread_t thread;
+    int fds[2];
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    dev->fd = fds[1];
+    dev->stop = false;
+    dev->frames = 0;
+    dev->dropped = 0;
+    CHECK(pthread_create(&thread, NULL, echo_device_run, dev) == 0);
+
+    *ret = vbus_loopback_run(fds[0], config, stats);
+    CHECK(!(fcntl(fds[0], F_GETFL) & O_NONBLOCK));
+
+    dev->stop = true;
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_loopback(void) {
+    struct vbus_loopback_config config = VBUS_LOOPBACK_CONFIG_DEFAULT;
+    struct vbus_loopback_stats stats;
+    struct echo_device dev = {0};
+    int ret;
+
+    // 2000 frames/s for 100 ms, all echoed
+    config.payload_size = 16;
+    config.rate = 2000;
+    config.duration_ms = 100;
+    config.drain_ms = 200;
+    run_echo_device(&dev, &config, &stats, &ret);
+    CHECK(ret == 0);
+    CHECK(stats.sent == 200);
+    CHECK(stats.echoed == 200);
+    CHECK(stats.unexpected == 1);
+    CHECK(stats.echoed_bytes == 200 * (VBUS_HOST_FRAME_HEADER_SIZE + 16));
+    CHECK(stats.rtt_min_ns > 0);
+    CHECK(stats.rtt_min_ns <= stats.rtt_p50_ns && stats.rtt_p50_ns <= stats.rtt_p99_ns);
+    CHECK(stats.rtt_p99_ns <= stats.rtt_p999_ns && stats.rtt_p999_ns <= stats.rtt_max_ns);
+    // Paced, the last frame is due 99.5 ms after the first
+    CHECK(stats.elapsed_ns >= 99000000ULL);
+
+    // As fast as possible within the credits, every tenth frame lost
+    config.rate = 0;
+    config.duration_ms = 50;
+    config.flow_control = true;
+    config.first_seq = 0x1000;
+    dev.drop_every = 10;
+    dev.flow_control = true;
+    run_echo_device(&dev, &config, &stats, &ret);
+    CHECK(ret == 0);
+    CHECK(stats.sent > 200);
+    CHECK(stats.sent == dev.frames);
+    CHECK(stats.sent - stats.echoed == dev.dropped);
+    CHECK(dev.dropped > 0);
+    CHECK(stats.credits > 0);
+}
+
+static void test_tty_open(void) {
+    char path[256];
+
+    make_path(path, sizeof(path), "ttyACM9");
+    unlink(path);
+    CHECK(vbus_tty_open(path, 115200) == -ENOENT);
+    // Not created by the failed open
+    CHECK(access(path, F_OK) != 0);
+
+    write_file(path, "");
+    CHECK(vbus_tty_open(path, 115200) == -ENOTTY);
+    unlink(path);
+}
+
+int main(void) {
+    test_csv();
+    test_binary_roundtrip();
+    test_frame_encode();
+    test_replay_stream();
+    test_flow_credits();
+    test_replay_flow_control();
+    test_loopback();
+    test_tty_open();
+
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("all checks passed\n");
+    return EXIT_SUCCESS;
+}
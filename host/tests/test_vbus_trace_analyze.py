@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+import io
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "tools"))
+
+import vbus_trace_analyze as analyze
+
+
+def info(channel, size):
+    return channel << 24 | size
+
+
+class TraceAnalyzeTest(unittest.TestCase):
+    def test_stages(self):
+        # Two frames of 8 bytes on channel 1 and 2 in one vbus_rx, their
+        # headers end at 3 and 14; a third frame's header arrives later
+        events = [
+            (1000, "vbus_rx", 22, 22),
+            (1500, "vbus_header", 3, info(1, 8)),
+            (1600, "vbus_decoded", 3, info(1, 8)),
+            (1700, "vbus_header", 14, info(2, 8)),
+            (1800, "vbus_decoded", 14, info(2, 8)),
+            (2000, "vbus_dispatch", 3, info(1, 8)),
+            (2100, "vbus_dispatch", 14, info(2, 8)),
+            (5000, "vbus_consumed", 3, info(1, 8)),
+            (6000, "vbus_consumed", 14, info(2, 8)),
+            (7000, "vbus_consumed", 14, info(2, 8)),
+            (9000, "vbus_rx", 3, 25),
+            (9500, "vbus_header", 25, info(1, 0)),
+            (9600, "vbus_decoded", 25, info(1, 0)),
+        ]
+        frames = analyze.match_frames(events)
+        self.assertEqual(len(frames), 3)
+        self.assertEqual([f.rx for f in frames], [1000, 1000, 9000])
+
+        samples = analyze.collect(frames)
+        self.assertEqual(samples[None]["ring"], [500, 700, 500])
+        self.assertEqual(samples[None]["payload"], [100, 100, 100])
+        self.assertEqual(samples[None]["dispatch"], [400, 300])
+        # Fanned out to two consumers
+        self.assertEqual(samples[2]["consume"], [3900, 4900])
+        self.assertEqual(samples[1]["total"], [4000, 600])
+        self.assertEqual(samples[2]["total"], [6000])
+
+    def test_rx_split_header(self):
+        # The header ends in the second vbus_rx
+        events = [
+            (100, "vbus_rx", 2, 2),
+            (200, "vbus_rx", 10, 12),
+            (300, "vbus_header", 3, info(1, 9)),
+        ]
+        frames = analyze.match_frames(events)
+        self.assertEqual(frames[0].rx, 200)
+
+    def test_stream_position_wraps(self):
+        events = [
+            (100, "vbus_rx", 16, 0xFFFFFFF8),
+            (200, "vbus_header", 0xFFFFFFF5, info(1, 4)),
+            (300, "vbus_rx", 16, 8),
+            (400, "vbus_header", 2, info(1, 4)),
+        ]
+        frames = analyze.match_frames(events)
+        self.assertEqual([f.rx for f in frames], [100, 300])
+
+    def test_events_before_trace_are_skipped(self):
+        events = [
+            (100, "vbus_consumed", 40, info(1, 4)),
+            (200, "vbus_header", 60, info(1, 4)),
+        ]
+        frames = analyze.match_frames(events)
+        self.assertEqual(len(frames), 1)
+        self.assertIsNone(frames[0].rx)
+
+    def test_percentiles(self):
+        summary = analyze.summarize(range(1, 1001))
+        self.assertEqual(summary["p50"], 500)
+        self.assertEqual(summary["p99"], 990)
+        self.assertEqual(summary["p999"], 999)
+        self.assertEqual(summary["max"], 1000)
+
+    def test_report(self):
+        events = [
+            (0, "vbus_rx", 4, 4),
+            (1000, "vbus_header", 3, info(7, 1)),
+            (3000, "vbus_decoded", 3, info(7, 1)),
+        ]
+        out = io.StringIO()
+        analyze.report(out, analyze.match_frames(events), "us")
+        text = out.getvalue()
+        self.assertIn("channel 7", text)
+        self.assertIn("ring", text)
+        self.assertNotIn("dispatch", text)
+
+
+if __name__ == "__main__":
+    unittest.main()
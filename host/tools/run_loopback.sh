@@ -0,0 +1,38 @@
+#!/bin/sh
+# Run vbus-loopback against the native_sim loopback firmware.
+#
+# usage: run_loopback.sh <zephyr.exe> [vbus-loopback options]
+#
+# The firmware is started in the background and the pty of its vbus-uart is
+# taken from its output. VBUS_LOOPBACK overrides the path of the host tool,
+# FIRMWARE_ARGS are passed to the firmware, e.g. -trace-file=<file>.
+set -e
+
+if [ $# -lt 1 ]; then
+    sed -n 4p "$0" | cut -c3-
+    exit 1
+fi
+
+firmware=$1
+shift
+tool=${VBUS_LOOPBACK:-$(dirname "$0")/../build/vbus-loopback}
+log=$(mktemp)
+
+"$firmware" $FIRMWARE_ARGS >"$log" 2>&1 &
+pid=$!
+trap 'kill $pid 2>/dev/null; rm -f "$log"' EXIT INT TERM
+
+pty=
+for _ in $(seq 50); do
+    pty=$(sed -n 's/^vbus-uart connected to pseudotty: \(.*\)$/\1/p' "$log")
+    [ -n "$pty" ] && break
+    sleep 0.1
+done
+
+if [ -z "$pty" ]; then
+    echo "no vbus-uart pty in the firmware output:" >&2
+    cat "$log" >&2
+    exit 1
+fi
+
+"$tool" "$@" "$pty"
@@ -0,0 +1,128 @@
+#include <vbus_host/loopback.h>
+#include <vbus_host/tty.h>
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static volatile bool stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = true;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options] <tty>\n"
+            "\n"
+            "Stream sequence numbered v1 vbus frames to the loopback firmware at\n"
+            "increasing rates and measure the echoes. Rates double from the start rate\n"
+            "up to the max rate, a last step sends as fast as the link takes frames.\n"
+            "\n"
+            "  -r fps      start rate in frames per second (default 1000)\n"
+            "  -R fps      max rate, 0 only runs the last step (default 64000)\n"
+            "  -d ms       duration of every step (default 2000)\n"
+            "  -D ms       time to wait for echoes after a step (default 500)\n"
+            "  -p bytes    payload size, at least 4 (default 64)\n"
+            "  -c channel  vbus channel of the frames and echoes (default 1)\n"
+            "  -b bytes    largest write (default 4096)\n"
+            "  -f          only send within the credits advertised by the device\n"
+            "  -T ms       give up when no credit arrives for this long (default 1000)\n"
+            "  -B baud     baud rate for real UARTs (default 115200)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    struct vbus_loopback_config config = VBUS_LOOPBACK_CONFIG_DEFAULT;
+    uint32_t start_rate = 1000;
+    uint32_t max_rate = 64000;
+    int baud = 115200;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:R:d:D:p:c:b:fT:B:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            start_rate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'R':
+            max_rate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            config.duration_ms = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'D':
+            config.drain_ms = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            config.payload_size = (uint16_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            config.channel = (uint8_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            config.max_batch_bytes = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            config.flow_control = true;
+            break;
+        case 'T':
+            config.credit_timeout_ms = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'B':
+            baud = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 1 || start_rate == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int fd = vbus_tty_open(argv[optind], baud);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-fd));
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action = {.sa_handler = on_signal};
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    config.stop = &stop_requested;
+
+    vbus_loopback_report_header(stdout);
+
+    uint32_t rate = max_rate > 0 ? start_rate : 0;
+    int ret = 0;
+
+    while (!stop_requested) {
+        struct vbus_loopback_stats stats;
+
+        config.rate = rate;
+        ret = vbus_loopback_run(fd, &config, &stats);
+        vbus_loopback_report(stdout, &stats);
+        fflush(stdout);
+        if (ret) {
+            fprintf(stderr, "%s: %s\n", argv[optind], strerror(-ret));
+            break;
+        }
+
+        // Late echoes of this step are told apart from the next one
+        config.first_seq += (uint32_t)stats.sent;
+
+        if (rate == 0) {
+            break;
+        }
+        rate = rate <= max_rate / 2 ? rate * 2 : 0;
+    }
+
+    close(fd);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
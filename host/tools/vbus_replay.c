@@ -0,0 +1,132 @@
+#include <vbus_host/replay.h>
+#include <vbus_host/trace.h>
+#include <vbus_host/tty.h>
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static volatile bool stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = true;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options] <trace> <tty>\n"
+            "       %s -o <out.vbtr> [-s size] <trace.csv>\n"
+            "\n"
+            "Stream a recorded CSV or binary trace to a device as v1 vbus frames.\n"
+            "\n"
+            "  -r rate     real time factor, 0 sends as fast as possible (default 1)\n"
+            "  -w us       batch frames due within this window into one write (default 1000)\n"
+            "  -b bytes    largest write (default 4096)\n"
+            "  -l loops    times to send the trace, 0 repeats until interrupted (default 1)\n"
+            "  -t us       frames later than this count as late (default 5000)\n"
+            "  -f          only send within the credits advertised by the device\n"
+            "  -T ms       give up when no credit arrives for this long (default 1000)\n"
+            "  -s size     CSV sample size in bytes, 2 or 4 (default 2)\n"
+            "  -B baud     baud rate for real UARTs (default 115200)\n"
+            "  -o file     convert the trace to the binary format instead of sending it\n",
+            prog, prog);
+}
+
+int main(int argc, char **argv) {
+    struct vbus_replay_config config = VBUS_REPLAY_CONFIG_DEFAULT;
+    const char *convert_path = NULL;
+    int sample_size = 2;
+    int baud = 115200;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:w:b:l:t:fT:s:B:o:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            config.rate = strtod(optarg, NULL);
+            break;
+        case 'w':
+            config.batch_window_us = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            config.max_batch_bytes = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            config.loops = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            config.late_threshold_us = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            config.flow_control = true;
+            break;
+        case 'T':
+            config.credit_timeout_ms = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            sample_size = atoi(optarg);
+            break;
+        case 'B':
+            baud = atoi(optarg);
+            break;
+        case 'o':
+            convert_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != (convert_path ? 1 : 2)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct vbus_trace trace;
+    size_t line_no = 0;
+    vbus_trace_init(&trace);
+
+    int ret = vbus_trace_load(argv[optind], sample_size, &trace, &line_no);
+    if (ret) {
+        fprintf(stderr, "%s:%zu: failed to load trace: %s\n", argv[optind], line_no,
+                strerror(-ret));
+        return EXIT_FAILURE;
+    }
+
+    if (convert_path) {
+        ret = vbus_trace_save_binary(convert_path, &trace);
+        if (ret) {
+            fprintf(stderr, "%s: %s\n", convert_path, strerror(-ret));
+        }
+        vbus_trace_free(&trace);
+        return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    int fd = vbus_tty_open(argv[optind + 1], baud);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind + 1], strerror(-fd));
+        vbus_trace_free(&trace);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action = {.sa_handler = on_signal};
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    config.stop = &stop_requested;
+
+    struct vbus_replay_stats stats;
+    ret = vbus_replay_run(fd, &trace, &config, &stats);
+    if (ret) {
+        fprintf(stderr, "%s: write failed: %s\n", argv[optind + 1], strerror(-ret));
+    }
+
+    vbus_replay_report(stderr, &config, &stats);
+
+    close(fd);
+    vbus_trace_free(&trace);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Per stage latencies of vbus frames from a frame lifecycle trace.
+
+The device emits the named trace events of rtio_vbus/vbus_trace.h when built
+with CONFIG_APP_DRIVERS_RTIO_VBUS_TRACING. This script reads them from a CTF
+trace directory (needs the babeltrace2 python bindings) or from a CSV file
+with the columns ts_ns,name,arg0,arg1, matches the events of every frame and
+prints the latency distribution of each stage, overall and per channel:
+
+  ring      vbus_rx that brought the header in -> vbus_header
+  payload   vbus_header -> vbus_decoded
+  dispatch  vbus_decoded -> vbus_dispatch
+  consume   vbus_dispatch, or vbus_decoded without one -> vbus_consumed
+  total     first -> last event of the frame
+
+A frame is identified by the stream position right after its header, so it is
+matched to the first vbus_rx whose stream position reaches it. Frames fanned
+out to several consumers count one consume sample per consumer.
+
+usage: vbus_trace_analyze.py [--csv] [--unit us|ns|ms] <trace>
+"""
+
+import argparse
+import csv
+import sys
+
+STAGES = ("ring", "payload", "dispatch", "consume", "total")
+PERCENTILES = ((500, "p50"), (990, "p99"), (999, "p999"))
+UNITS = {"ns": 1, "us": 1000, "ms": 1000000}
+
+POS_MASK = 0xFFFFFFFF
+
+
+def pos_reached(pos, target):
+    """Serial number comparison of 32 bit stream positions."""
+    return ((pos - target) & POS_MASK) < 0x80000000
+
+
+def read_ctf(path, bt2):
+    for msg in bt2.TraceCollectionMessageIterator(path):
+        if type(msg) is not bt2._EventMessageConst:
+            continue
+        event = msg.event
+        if event.name != "named_event":
+            continue
+        name = str(event.payload_field["name"])
+        if not name.startswith("vbus_"):
+            continue
+        yield (msg.default_clock_snapshot.ns_from_origin, name,
+               int(event.payload_field["arg0"]), int(event.payload_field["arg1"]))
+
+
+def read_csv(path):
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or row[0].startswith("#") or row[0] == "ts_ns":
+                continue
+            yield int(row[0]), row[1].strip(), int(row[2], 0), int(row[3], 0)
+
+
+class Frame:
+    def __init__(self, frame_id, channel, size):
+        self.id = frame_id
+        self.channel = channel
+        self.size = size
+        self.rx = None
+        self.header = None
+        self.decoded = None
+        self.dispatch = None
+        self.consumed = []
+
+
+def match_frames(events):
+    """Group the events by frame and link every frame to its vbus_rx."""
+    frames = []
+    # Frame ids repeat once the stream position wraps, the latest wins
+    open_frames = {}
+    # vbus_rx events not yet passed by a header, oldest first
+    rx_events = []
+    rx_head = 0
+
+    for ts, name, arg0, arg1 in sorted(events, key=lambda e: e[0]):
+        if name == "vbus_rx":
+            rx_events.append((ts, arg1))
+            continue
+
+        channel = arg1 >> 24
+        size = arg1 & 0xFFFFFF
+
+        if name == "vbus_header":
+            frame = Frame(arg0, channel, size)
+            frame.header = ts
+            while rx_head < len(rx_events) and not pos_reached(rx_events[rx_head][1], arg0):
+                rx_head += 1
+            if rx_head < len(rx_events):
+                frame.rx = rx_events[rx_head][0]
+            # Earlier vbus_rx events cannot match later headers
+            if rx_head > 1024:
+                del rx_events[:rx_head]
+                rx_head = 0
+            open_frames[arg0] = frame
+            frames.append(frame)
+            continue
+
+        frame = open_frames.get(arg0)
+        if frame is None:
+            # Started before the trace
+            continue
+        if name == "vbus_decoded":
+            frame.decoded = ts
+        elif name == "vbus_dispatch":
+            if frame.dispatch is None:
+                frame.dispatch = ts
+        elif name == "vbus_consumed":
+            frame.consumed.append(ts)
+
+    return frames
+
+
+def frame_stages(frame):
+    """Yields (stage, latency_ns) for the stages the trace covers."""
+    if frame.rx is not None and frame.header is not None:
+        yield "ring", frame.header - frame.rx
+    if frame.decoded is not None:
+        yield "payload", frame.decoded - frame.header
+    if frame.dispatch is not None and frame.decoded is not None:
+        yield "dispatch", frame.dispatch - frame.decoded
+    handed_out = frame.dispatch if frame.dispatch is not None else frame.decoded
+    if handed_out is not None:
+        for ts in frame.consumed:
+            yield "consume", ts - handed_out
+
+    stamps = [frame.rx, frame.header, frame.decoded, frame.dispatch] + frame.consumed
+    stamps = [ts for ts in stamps if ts is not None]
+    if len(stamps) > 1:
+        yield "total", max(stamps) - min(stamps)
+
+
+def collect(frames):
+    """Latency samples per stage, overall (key None) and per channel."""
+    samples = {}
+    for frame in frames:
+        for key in (None, frame.channel):
+            stages = samples.setdefault(key, {stage: [] for stage in STAGES})
+            for stage, latency in frame_stages(frame):
+                stages[stage].append(latency)
+    return samples
+
+
+def percentile(sorted_values, per_mille):
+    """Nearest rank percentile, like vbus-loopback."""
+    rank = (len(sorted_values) * per_mille + 999) // 1000
+    return sorted_values[max(rank, 1) - 1]
+
+
+def summarize(values):
+    values = sorted(values)
+    summary = {"count": len(values)}
+    for per_mille, label in PERCENTILES:
+        summary[label] = percentile(values, per_mille) if values else None
+    summary["max"] = values[-1] if values else None
+    return summary
+
+
+def report(out, frames, unit):
+    divisor = UNITS[unit]
+    samples = collect(frames)
+    columns = ["count"] + [label for _, label in PERCENTILES] + ["max"]
+
+    def fmt(value):
+        return "-" if value is None else "%.1f" % (value / divisor)
+
+    out.write("%d frames, latencies in %s\n" % (len(frames), unit))
+    keys = [None] + sorted(key for key in samples if key is not None)
+    for key in keys:
+        out.write("\n%s\n" % ("all channels" if key is None else "channel %d" % key))
+        out.write("%-10s" % "stage" + "".join("%12s" % c for c in columns) + "\n")
+        for stage in STAGES:
+            summary = summarize(samples[key][stage])
+            if summary["count"] == 0:
+                continue
+            out.write("%-10s%12d" % (stage, summary["count"]) +
+                      "".join("%12s" % fmt(summary[c]) for c in columns[1:]) + "\n")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="CTF trace directory or CSV file")
+    parser.add_argument("--csv", action="store_true",
+                        help="read ts_ns,name,arg0,arg1 rows instead of CTF")
+    parser.add_argument("--unit", choices=UNITS, default="us")
+    args = parser.parse_args(argv)
+
+    if args.csv:
+        events = read_csv(args.trace)
+    else:
+        try:
+            import bt2
+        except ImportError:
+            sys.exit("reading CTF needs the babeltrace2 python bindings (bt2)")
+        events = read_ctf(args.trace, bt2)
+
+    frames = match_frames(events)
+    if not frames:
+        sys.exit("no vbus frame events in %s" % args.trace)
+    report(sys.stdout, frames, args.unit)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,8 +11,9 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/uart.h>
+#include <zephyr/sys/printk.h>
 #include <usb_samples/common/sample_usbd.h>
-#include <zephyr/drivers/uart.h>
+#include <rtio_vbus/uart_tx.h>
 
 // register log module
 LOG_MODULE_REGISTER(cdc_acm_echo, LOG_LEVEL_DBG);
@@ -26,7 +27,8 @@ BUILD_ASSERT(DT_NODE_HAS_COMPAT(DT_NODELABEL(cdc_acm_uart1), zephyr_cdc_acm_uart
 
 struct usbd_context *sample_usbd;
 
-#define STACK_SIZE 512
+// Leaves room for snprintk() next to the line buffer
+#define STACK_SIZE 1024
 #define THREAD_PRIO 9
 
 k_tid_t sdev1_tid;
@@ -36,6 +38,22 @@ struct k_thread sdev2_thread;
 K_THREAD_STACK_DEFINE(sdev1_stack, STACK_SIZE);
 K_THREAD_STACK_DEFINE(sdev2_stack, STACK_SIZE);
 
+#define TX_RING_SIZE 256
+#define TX_WATERMARK 64
+#define TX_MAX_LATENCY K_MSEC(5)
+// Packet size of the full speed bulk IN endpoint
+#define TX_CHUNK_SIZE 64
+#define LINE_SIZE 64
+
+// Each port has its own transmit pipeline, printing never blocks the thread
+struct serial_port {
+    const struct device *dev;
+    struct vbus_uart_tx tx;
+    uint8_t tx_ring[TX_RING_SIZE];
+};
+
+static struct serial_port ports[2];
+
 
 
 // static void print_usb_info_callback(const struct usbd_context *ctx, const struct usbd_msg *msg) {
@@ -66,48 +84,48 @@ static int enable_usb_device(void) {
     return 0;
 }
 
-static void uart_print(const char *str, struct device *uart_dev) {
-    while (*str) {
-        uart_poll_out(uart_dev, *str++);
+static void uart_print(struct serial_port *port, const char *str) {
+    // Returns right away, the TX interrupt sends the line
+    if (vbus_uart_tx_write(&port->tx, (const uint8_t *)str, strlen(str))) {
+        LOG_WRN("%s: TX ring full, line dropped", port->dev->name);
     }
 }
 
-static void uart_print_formatted(struct device *uart_dev, const char *name, int counter) {
-    // Print device name
-    const char *p = name;
-    while (*p) {
-        uart_poll_out(uart_dev, *p++);
+static void uart_print_formatted(struct serial_port *port, const char *name, int counter) {
+    char line[LINE_SIZE];
+
+    // 5-digit zero-padded counter
+    int len = snprintk(line, sizeof(line), "%s:%05d: Hello, world!\n", name, counter % 100000);
+    if (len < 0) {
+        return;
     }
-    
-    // Print colon
-    uart_poll_out(uart_dev, ':');
-    
-    // Print 5-digit zero-padded counter
-    char digits[6];
-    int temp = counter;
-    digits[5] = '\0';
-    for (int i = 4; i >= 0; i--) {
-        digits[i] = '0' + (temp % 10);
-        temp /= 10;
+
+    // A long device name cuts the line, which still ends it
+    if (len >= (int)sizeof(line)) {
+        line[sizeof(line) - 2] = '\n';
     }
-    uart_print(digits, uart_dev);
-    
-    // Print constant suffix
-    uart_print(": Hello, world!\n", uart_dev);
+
+    uart_print(port, line);
 }
 
 static void serial_device_thread_run(void *arg1, void *arg2, void *arg3) {
-    struct device *dev = (struct device *) arg1;
+    struct serial_port *port = arg1;
+    const struct device *dev = port->dev;
     
     uint32_t dtr = 0;
     while (!dtr) {
         uart_line_ctrl_get(dev, UART_LINE_CTRL_DTR, &dtr);
         k_sleep(K_MSEC(200));
     }
+
+    if (vbus_uart_tx_start(&port->tx)) {
+        LOG_ERR("%s: Failed to start TX", dev->name);
+        return;
+    }
     
     int i = 0;
     while (1) {
-        uart_print_formatted(dev, dev->name, i++);
+        uart_print_formatted(port, dev->name, i++);
         k_sleep(K_MSEC(1000));
     }
 }
@@ -127,11 +145,23 @@ int main(void) {
     const struct device *uart_dev2 = DEVICE_DT_GET(DT_NODELABEL(cdc_acm_uart1));
 
 
+    ports[0].dev = uart_dev1;
+    ports[1].dev = uart_dev2;
+    for (size_t i = 0; i < ARRAY_SIZE(ports); i++) {
+        err = vbus_uart_tx_init(&ports[i].tx, ports[i].dev, ports[i].tx_ring,
+                                sizeof(ports[i].tx_ring), TX_WATERMARK, TX_MAX_LATENCY,
+                                TX_CHUNK_SIZE, NULL);
+        if (err) {
+            LOG_ERR("Failed to initialize TX of %s", ports[i].dev->name);
+            return err;
+        }
+    }
+
     LOG_INF("Serial devices ready. Starting serial device threads.");
 
     sdev1_tid = k_thread_create(&sdev1_thread, sdev1_stack, STACK_SIZE, 
-        serial_device_thread_run, uart_dev1, NULL, NULL, THREAD_PRIO, 0, K_NO_WAIT);
+        serial_device_thread_run, &ports[0], NULL, NULL, THREAD_PRIO, 0, K_NO_WAIT);
 
     sdev2_tid = k_thread_create(&sdev2_thread, sdev2_stack, STACK_SIZE, 
-        serial_device_thread_run, uart_dev2, NULL, NULL, THREAD_PRIO, 0, K_NO_WAIT);
+        serial_device_thread_run, &ports[1], NULL, NULL, THREAD_PRIO, 0, K_NO_WAIT);
 }
\ No newline at end of file
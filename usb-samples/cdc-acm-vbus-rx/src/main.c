@@ -0,0 +1,162 @@
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/usb/usbd.h>
+#include <usb_samples/common/sample_usbd.h>
+#include <rtio_vbus/frame_decoder.h>
+#include <rtio_vbus/uart_rx.h>
+#include <rtio_vbus/vbus_stats.h>
+
+// register log module
+LOG_MODULE_REGISTER(cdc_acm_vbus_rx, LOG_LEVEL_INF);
+
+BUILD_ASSERT(DT_NODE_HAS_COMPAT(DT_NODELABEL(cdc_acm_uart0), zephyr_cdc_acm_uart),
+        "CDC-ACM UART device 0 not found");
+
+#define RX_RING_SIZE 2048
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+// Floor of the adaptive watermark, which grows with the arrival rate
+#define RX_WATERMARK 64
+#define RX_LATENCY_BUDGET_US 2000
+#else
+#define RX_WATERMARK 512
+#endif
+#define RX_MAX_LATENCY K_MSEC(2)
+#define MAX_PAYLOAD_SIZE 1024
+#define CREDIT_THRESHOLD (RX_RING_SIZE / 4)
+#define CREDIT_REFRESH K_MSEC(250)
+#define STATS_PERIOD K_SECONDS(5)
+
+static const struct device *const uart_dev = DEVICE_DT_GET(DT_NODELABEL(cdc_acm_uart0));
+
+static uint8_t rx_ring[RX_RING_SIZE];
+static struct vbus_uart_rx uart_rx;
+
+static uint8_t payload[MAX_PAYLOAD_SIZE];
+static struct vbus_frame_decoder decoder;
+
+static uint32_t frame_count;
+static uint32_t byte_count;
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+// Also shown by the "vbus stats" shell command
+static struct vbus_stats rx_stats;
+#endif
+
+static void on_frame(const struct vbus_frame *frame, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    frame_count++;
+    byte_count += frame->size;
+}
+
+static void decode_handler(struct vbus_uart_rx *rx, struct ring_buf *buffer) {
+    ARG_UNUSED(rx);
+
+    vbus_frame_decoder_feed_ring(&decoder, buffer);
+}
+
+// DTR changes arrive as USB messages, no need to poll the line state
+static void usbd_msg_callback(struct usbd_context *const ctx, const struct usbd_msg *msg) {
+    if (usbd_can_detect_vbus(ctx)) {
+        if (msg->type == USBD_MSG_VBUS_READY && usbd_enable(ctx)) {
+            LOG_ERR("Failed to enable device support");
+        }
+
+        if (msg->type == USBD_MSG_VBUS_REMOVED && usbd_disable(ctx)) {
+            LOG_ERR("Failed to disable device support");
+        }
+    }
+
+    if (msg->type == USBD_MSG_CDC_ACM_CONTROL_LINE_STATE && msg->dev == uart_dev) {
+        uint32_t dtr = 0;
+
+        uart_line_ctrl_get(uart_dev, UART_LINE_CTRL_DTR, &dtr);
+        if (dtr) {
+            LOG_INF("Host connected, start receiving");
+            vbus_uart_rx_start(&uart_rx);
+        } else {
+            LOG_INF("Host disconnected, stop receiving");
+            vbus_uart_rx_stop(&uart_rx);
+            // A cut off frame would desync the next session
+            vbus_uart_rx_flush(&uart_rx);
+            vbus_frame_decoder_reset(&decoder);
+        }
+    }
+}
+
+static int enable_usb_device(void) {
+    int err;
+    struct usbd_context *sample_usbd = sample_usbd_init_device(usbd_msg_callback);
+
+    if (sample_usbd == NULL) {
+        LOG_ERR("Failed to initialize USB device");
+        return -ENODEV;
+    }
+
+    if (!usbd_can_detect_vbus(sample_usbd)) {
+        err = usbd_enable(sample_usbd);
+        if (err) {
+            LOG_ERR("Failed to enable device support");
+            return err;
+        }
+    }
+
+    LOG_INF("USB device support enabled");
+    return 0;
+}
+
+int main(void) {
+    int err;
+
+    vbus_frame_decoder_init(&decoder, payload, sizeof(payload), on_frame, NULL);
+
+    err = vbus_uart_rx_init(&uart_rx, uart_dev, rx_ring, sizeof(rx_ring), RX_WATERMARK,
+                            RX_MAX_LATENCY, decode_handler, NULL);
+    if (err) {
+        LOG_ERR("Failed to initialize receive pipeline");
+        return err;
+    }
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_ADAPTIVE
+    err = vbus_uart_rx_set_latency_budget(&uart_rx, RX_LATENCY_BUDGET_US);
+    if (err) {
+        return err;
+    }
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_UART_RX_FLOW_CTRL
+    // Hosts that honour credits, e.g. vbus-replay -f, never overrun the ring
+    err = vbus_uart_rx_set_flow_ctrl(&uart_rx, CREDIT_THRESHOLD, CREDIT_REFRESH);
+    if (err) {
+        return err;
+    }
+#endif
+
+#ifdef CONFIG_APP_DRIVERS_RTIO_VBUS_STATS
+    err = vbus_stats_init(&rx_stats, "vbus_rx");
+    if (err) {
+        return err;
+    }
+
+    vbus_frame_decoder_set_stats(&decoder, &rx_stats);
+    vbus_uart_rx_set_stats(&uart_rx, &rx_stats);
+#endif
+
+    err = enable_usb_device();
+    if (err) {
+        return err;
+    }
+
+    while (1) {
+        k_sleep(STATS_PERIOD);
+        LOG_INF("frames=%u bytes=%u dropped=%u pauses=%u irqs=%u wakeups=%u watermark=%u",
+                frame_count, byte_count, decoder.dropped_frames,
+                (uint32_t)atomic_get(&uart_rx.pauses), (uint32_t)atomic_get(&uart_rx.irqs),
+                (uint32_t)atomic_get(&uart_rx.wakeups), uart_rx.watermark);
+    }
+
+    return 0;
+}